@@ -35,6 +35,10 @@ UsdMayaStageNoticeListener::~UsdMayaStageNoticeListener()
     if (_stageContentsChangedKey.IsValid()) {
         TfNotice::Revoke(_stageContentsChangedKey);
     }
+
+    if (_stageObjectsChangedKey.IsValid()) {
+        TfNotice::Revoke(_stageObjectsChangedKey);
+    }
 }
 
 void
@@ -43,6 +47,7 @@ UsdMayaStageNoticeListener::SetStage(const UsdStageWeakPtr& stage)
     _stage = stage;
 
     _UpdateStageContentsChangedRegistration();
+    _UpdateStageObjectsChangedRegistration();
 }
 
 void
@@ -54,6 +59,15 @@ UsdMayaStageNoticeListener::SetStageContentsChangedCallback(
     _UpdateStageContentsChangedRegistration();
 }
 
+void
+UsdMayaStageNoticeListener::SetStageObjectsChangedCallback(
+        const StageObjectsChangedCallback& callback)
+{
+    _stageObjectsChangedCallback = callback;
+
+    _UpdateStageObjectsChangedRegistration();
+}
+
 void
 UsdMayaStageNoticeListener::_UpdateStageContentsChangedRegistration()
 {
@@ -74,6 +88,24 @@ UsdMayaStageNoticeListener::_UpdateStageContentsChangedRegistration()
     }
 }
 
+void
+UsdMayaStageNoticeListener::_UpdateStageObjectsChangedRegistration()
+{
+    // Unlike StageContentsChanged, ObjectsChanged notices are only received
+    // from the stage, so the registration follows the stage.
+    if (_stageObjectsChangedKey.IsValid()) {
+        TfNotice::Revoke(_stageObjectsChangedKey);
+    }
+
+    if (_stage && _stageObjectsChangedCallback) {
+        _stageObjectsChangedKey =
+            TfNotice::Register(
+                TfCreateWeakPtr(this),
+                &UsdMayaStageNoticeListener::_OnStageObjectsChanged,
+                _stage);
+    }
+}
+
 void
 UsdMayaStageNoticeListener::_OnStageContentsChanged(
         const UsdNotice::StageContentsChanged& notice) const
@@ -83,5 +115,14 @@ UsdMayaStageNoticeListener::_OnStageContentsChanged(
     }
 }
 
+void
+UsdMayaStageNoticeListener::_OnStageObjectsChanged(
+        const UsdNotice::ObjectsChanged& notice) const
+{
+    if (_stageObjectsChangedCallback) {
+        _stageObjectsChangedCallback(notice);
+    }
+}
+
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -19,6 +19,7 @@
 #include "../listeners/proxyShapeNotice.h"
 #include "../utils/query.h"
 #include "../utils/stageCache.h"
+#include "../utils/stageLoader.h"
 #include "../utils/utilFileSystem.h"
 #include "stageData.h"
 
@@ -74,6 +75,7 @@
 #include <maya/MStatus.h>
 #include <maya/MString.h>
 #include <maya/MTime.h>
+#include <maya/MTimerMessage.h>
 #include <maya/MViewport2Renderer.h>
 
 #include <map>
@@ -93,6 +95,13 @@ TF_DEFINE_PUBLIC_TOKENS(MayaUsdProxyShapeBaseTokens,
 MayaUsdProxyShapeBase::ClosestPointDelegate
 MayaUsdProxyShapeBase::_sharedClosestPointDelegate = nullptr;
 
+// Period in seconds at which a stage loaded in background is polled.
+static const float _StageLoaderPollPeriod = 0.1f;
+
+TF_DEFINE_ENV_SETTING(MAYAUSD_PROXY_SHAPE_BOUNDS_CACHE_TIMES, 256,
+    "Number of times for which the bounding box of a proxy shape with "
+    "time-varying geometry is cached.");
+
 
 // ========================================================
 
@@ -118,6 +127,14 @@ MObject MayaUsdProxyShapeBase::outStageDataAttr;
 MObject MayaUsdProxyShapeBase::drawRenderPurposeAttr;
 MObject MayaUsdProxyShapeBase::drawProxyPurposeAttr;
 MObject MayaUsdProxyShapeBase::drawGuidePurposeAttr;
+MObject MayaUsdProxyShapeBase::cullingEnabledAttr;
+MObject MayaUsdProxyShapeBase::cullingPixelThresholdAttr;
+MObject MayaUsdProxyShapeBase::lodEnabledAttr;
+MObject MayaUsdProxyShapeBase::lodPixelThresholdAttr;
+MObject MayaUsdProxyShapeBase::instanceCullingEnabledAttr;
+MObject MayaUsdProxyShapeBase::asyncLoadAttr;
+MObject MayaUsdProxyShapeBase::progressiveLoadAttr;
+MObject MayaUsdProxyShapeBase::stageLoadedAttr;
 
 
 /* static */
@@ -282,6 +299,108 @@ MayaUsdProxyShapeBase::initialize()
     retValue = addAttribute(drawGuidePurposeAttr);
     CHECK_MSTATUS_AND_RETURN_IT(retValue);
 
+    cullingEnabledAttr = numericAttrFn.create(
+        "cullingEnabled",
+        "cen",
+        MFnNumericData::kBoolean,
+        0.0,
+        &retValue);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+    numericAttrFn.setChannelBox(true);
+    numericAttrFn.setAffectsAppearance(true);
+    retValue = addAttribute(cullingEnabledAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+
+    cullingPixelThresholdAttr = numericAttrFn.create(
+        "cullingPixelThreshold",
+        "cpt",
+        MFnNumericData::kFloat,
+        1.0,
+        &retValue);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+    numericAttrFn.setMin(0.0);
+    numericAttrFn.setSoftMax(16.0);
+    numericAttrFn.setChannelBox(true);
+    numericAttrFn.setAffectsAppearance(true);
+    retValue = addAttribute(cullingPixelThresholdAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+
+    lodEnabledAttr = numericAttrFn.create(
+        "lodEnabled",
+        "lde",
+        MFnNumericData::kBoolean,
+        0.0,
+        &retValue);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+    numericAttrFn.setChannelBox(true);
+    numericAttrFn.setAffectsAppearance(true);
+    retValue = addAttribute(lodEnabledAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+
+    lodPixelThresholdAttr = numericAttrFn.create(
+        "lodPixelThreshold",
+        "lpt",
+        MFnNumericData::kFloat,
+        32.0,
+        &retValue);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+    numericAttrFn.setMin(0.0);
+    numericAttrFn.setSoftMax(256.0);
+    numericAttrFn.setChannelBox(true);
+    numericAttrFn.setAffectsAppearance(true);
+    retValue = addAttribute(lodPixelThresholdAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+
+    instanceCullingEnabledAttr = numericAttrFn.create(
+        "instanceCullingEnabled",
+        "ice",
+        MFnNumericData::kBoolean,
+        0.0,
+        &retValue);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+    numericAttrFn.setChannelBox(true);
+    numericAttrFn.setAffectsAppearance(true);
+    retValue = addAttribute(instanceCullingEnabledAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+
+    asyncLoadAttr = numericAttrFn.create(
+        "asyncLoad",
+        "asl",
+        MFnNumericData::kBoolean,
+        0.0,
+        &retValue);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+    numericAttrFn.setAffectsAppearance(true);
+    retValue = addAttribute(asyncLoadAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+
+    progressiveLoadAttr = numericAttrFn.create(
+        "progressiveLoad",
+        "prgl",
+        MFnNumericData::kBoolean,
+        0.0,
+        &retValue);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+    numericAttrFn.setAffectsAppearance(true);
+    retValue = addAttribute(progressiveLoadAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+
+    // Incremented once a stage loaded asynchronously is ready, so that it
+    // gets picked up by the stage data.
+    stageLoadedAttr = numericAttrFn.create(
+        "stageLoaded",
+        "sld",
+        MFnNumericData::kInt,
+        0,
+        &retValue);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+    numericAttrFn.setHidden(true);
+    numericAttrFn.setStorable(false);
+    numericAttrFn.setConnectable(false);
+    numericAttrFn.setAffectsAppearance(true);
+    retValue = addAttribute(stageLoadedAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+
     //
     // add attribute dependencies
     //
@@ -295,6 +414,21 @@ MayaUsdProxyShapeBase::initialize()
     retValue = attributeAffects(primPathAttr, outStageDataAttr);
     CHECK_MSTATUS_AND_RETURN_IT(retValue);
 
+    retValue = attributeAffects(asyncLoadAttr, inStageDataCachedAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+    retValue = attributeAffects(asyncLoadAttr, outStageDataAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+
+    retValue = attributeAffects(progressiveLoadAttr, inStageDataCachedAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+    retValue = attributeAffects(progressiveLoadAttr, outStageDataAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+
+    retValue = attributeAffects(stageLoadedAttr, inStageDataCachedAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+    retValue = attributeAffects(stageLoadedAttr, outStageDataAttr);
+    CHECK_MSTATUS_AND_RETURN_IT(retValue);
+
     retValue = attributeAffects(inStageDataAttr, inStageDataCachedAttr);
     CHECK_MSTATUS_AND_RETURN_IT(retValue);
     retValue = attributeAffects(inStageDataAttr, outStageDataAttr);
@@ -363,7 +497,12 @@ MayaUsdProxyShapeBase::compute(const MPlug& plug, MDataBlock& dataBlock)
             plug == complexityAttr ||
             plug == drawRenderPurposeAttr ||
             plug == drawProxyPurposeAttr ||
-            plug == drawGuidePurposeAttr) {
+            plug == drawGuidePurposeAttr ||
+            plug == cullingEnabledAttr ||
+            plug == cullingPixelThresholdAttr ||
+            plug == lodEnabledAttr ||
+            plug == lodPixelThresholdAttr ||
+            plug == instanceCullingEnabledAttr) {
         // If the attribute that needs to be computed is one of these, then it
         // does not affect the ouput stage data, but it *does* affect imaging
         // the shape. In that case, we notify Maya that the shape needs to be
@@ -402,6 +541,8 @@ MayaUsdProxyShapeBase::computeInStageDataCached(MDataBlock& dataBlock)
 
     // If inData has an incoming connection, then use it. Otherwise generate stage from the filepath
     if (!inDataHandle.data().isNull() ) {
+        _ResetStageLoader();
+
         //
         // Propagate inData -> inDataCached
         //
@@ -453,19 +594,30 @@ MayaUsdProxyShapeBase::computeInStageDataCached(MDataBlock& dataBlock)
         UsdStageRefPtr usdStage;
         SdfPath        primPath;
 
-        if (SdfLayerRefPtr rootLayer = SdfLayer::FindOrOpen(fileString)) {
-            UsdStageCacheContext ctx(UsdMayaStageCache::Get());
-            SdfLayerRefPtr sessionLayer = computeSessionLayer(dataBlock);
-            if (sessionLayer) {
-                usdStage = UsdStage::Open(rootLayer,
-                        sessionLayer,
-                        ArGetResolver().GetCurrentContext());
-            } else {
-                usdStage = UsdStage::Open(rootLayer,
-                        ArGetResolver().GetCurrentContext());
-            }
+        const bool asyncLoad =
+            dataBlock.inputValue(asyncLoadAttr, &retValue).asBool();
+        CHECK_MSTATUS_AND_RETURN_IT(retValue);
 
-            usdStage->SetEditTarget(usdStage->GetSessionLayer());
+        if (asyncLoad) {
+            usdStage = _GetLoadedStage(dataBlock, fileString);
+        }
+        else {
+            _ResetStageLoader();
+
+            if (SdfLayerRefPtr rootLayer = SdfLayer::FindOrOpen(fileString)) {
+                UsdStageCacheContext ctx(UsdMayaStageCache::Get());
+                SdfLayerRefPtr sessionLayer = computeSessionLayer(dataBlock);
+                if (sessionLayer) {
+                    usdStage = UsdStage::Open(rootLayer,
+                            sessionLayer,
+                            ArGetResolver().GetCurrentContext());
+                } else {
+                    usdStage = UsdStage::Open(rootLayer,
+                            ArGetResolver().GetCurrentContext());
+                }
+
+                usdStage->SetEditTarget(usdStage->GetSessionLayer());
+            }
         }
 
         if (usdStage) {
@@ -499,13 +651,90 @@ MayaUsdProxyShapeBase::computeInStageDataCached(MDataBlock& dataBlock)
     }
 }
 
+UsdStageRefPtr
+MayaUsdProxyShapeBase::_GetLoadedStage(
+        MDataBlock& dataBlock,
+        const std::string& fileString)
+{
+    // The session layer is computed on the main thread, and loading starts
+    // again when it changes.
+    SdfLayerRefPtr sessionLayer = computeSessionLayer(dataBlock);
+
+    if (!_stageLoader ||
+            _stageLoader->GetFilePath() != fileString ||
+            _stageLoader->GetSessionLayer() != sessionLayer) {
+        const bool progressiveLoad =
+            dataBlock.inputValue(progressiveLoadAttr).asBool();
+
+        _ResetStageLoader();
+        _stageLoader.reset(new UsdMayaStageLoader(
+            fileString,
+            sessionLayer,
+            ArGetResolver().GetCurrentContext(),
+            progressiveLoad));
+
+        MStatus status;
+        _stageLoaderCallbackId = MTimerMessage::addTimerCallback(
+            _StageLoaderPollPeriod,
+            _StageLoaderTimerCallback,
+            this,
+            &status);
+        CHECK_MSTATUS(status);
+    }
+
+    UsdStageRefPtr usdStage = _stageLoader->GetStage();
+    if (usdStage) {
+        usdStage->SetEditTarget(usdStage->GetSessionLayer());
+    }
+
+    return usdStage;
+}
+
+void
+MayaUsdProxyShapeBase::_ResetStageLoader()
+{
+    if (_stageLoaderCallbackId) {
+        MMessage::removeCallback(_stageLoaderCallbackId);
+        _stageLoaderCallbackId = 0;
+    }
+
+    _stageLoader.reset();
+}
+
+/* static */
+void
+MayaUsdProxyShapeBase::_StageLoaderTimerCallback(
+        float /*elapsedTime*/,
+        float /*lastTime*/,
+        void* clientData)
+{
+    static_cast<MayaUsdProxyShapeBase*>(clientData)->_OnStageLoaderTimer();
+}
+
+void
+MayaUsdProxyShapeBase::_OnStageLoaderTimer()
+{
+    // Redraw the placeholder bounds of the stage being loaded.
+    MHWRender::MRenderer::setGeometryDrawDirty(thisMObject());
+
+    if (!_stageLoader ||
+            _stageLoader->GetState() == UsdMayaStageLoader::State::Loading) {
+        return;
+    }
+
+    MMessage::removeCallback(_stageLoaderCallbackId);
+    _stageLoaderCallbackId = 0;
+
+    // Pick up the loaded stage: changing the plug dirties the stage data.
+    MPlug stageLoadedPlug(thisMObject(), stageLoadedAttr);
+    stageLoadedPlug.setInt(stageLoadedPlug.asInt() + 1);
+}
+
 MStatus
 MayaUsdProxyShapeBase::computeOutStageData(MDataBlock& dataBlock)
 {
     MStatus retValue = MS::kSuccess;
 
-    TfReset(_boundingBoxCache);
-
     // Reset the stage listener until we determine that everything is valid.
     _stageNoticeListener.SetStage(UsdStageWeakPtr());
     _stageNoticeListener.SetStageContentsChangedCallback(nullptr);
@@ -523,6 +752,11 @@ MayaUsdProxyShapeBase::computeOutStageData(MDataBlock& dataBlock)
         usdStage = inData->stage;
     }
 
+    _boundsCache.SetStage(usdStage);
+
+    // Stages no proxy shape references any more may be evicted from the cache.
+    UsdMayaStageCache::SetStageReference(this, usdStage);
+
     // If failed to get a valid stage, then
     // Propagate inDataCached -> outData
     // and return
@@ -601,7 +835,7 @@ MayaUsdProxyShapeBase::computeOutStageData(MDataBlock& dataBlock)
 bool
 MayaUsdProxyShapeBase::isBounded() const
 {
-    return isStageValid();
+    return isStageValid() || isStageLoading();
 }
 
 /* virtual */
@@ -628,26 +862,24 @@ MayaUsdProxyShapeBase::boundingBox() const
     dataBlock.inputValue(outStageDataAttr, &status);
     CHECK_MSTATUS_AND_RETURN(status, MBoundingBox());
 
-    // XXX:
-    // If we could cheaply determine whether a stage only has static geometry,
-    // we could make this value a constant one for that case, avoiding the
-    // memory overhead of a cache entry per frame
     UsdTimeCode currTime = GetOutputTime(dataBlock);
 
-    std::map<UsdTimeCode, MBoundingBox>::const_iterator cacheLookup =
-        _boundingBoxCache.find(currTime);
-
-    if (cacheLookup != _boundingBoxCache.end()) {
-        return cacheLookup->second;
-    }
-
     UsdPrim prim = _GetUsdPrim(dataBlock);
     if (!prim) {
+        // Bounds authored in the root layer stand for the stage being loaded.
+        if (isStageLoading()) {
+            const GfRange3d boxRange = _stageLoader->GetPlaceholderBounds();
+            if (!boxRange.IsEmpty()) {
+                const GfVec3d boxMin = boxRange.GetMin();
+                const GfVec3d boxMax = boxRange.GetMax();
+                return MBoundingBox(
+                    MPoint(boxMin[0], boxMin[1], boxMin[2]),
+                    MPoint(boxMax[0], boxMax[1], boxMax[2]));
+            }
+        }
         return MBoundingBox();
     }
 
-    const UsdGeomImageable imageablePrim(prim);
-
     bool drawRenderPurpose = false;
     bool drawProxyPurpose = true;
     bool drawGuidePurpose = false;
@@ -657,24 +889,24 @@ MayaUsdProxyShapeBase::boundingBox() const
         &drawProxyPurpose,
         &drawGuidePurpose);
 
-    const TfToken purpose1 = UsdGeomTokens->default_;
-    const TfToken purpose2 =
-        drawRenderPurpose ? UsdGeomTokens->render : TfToken();
-    const TfToken purpose3 =
-        drawProxyPurpose ? UsdGeomTokens->proxy : TfToken();
-    const TfToken purpose4 =
-        drawGuidePurpose ? UsdGeomTokens->guide : TfToken();
-
-    const GfBBox3d allBox = imageablePrim.ComputeUntransformedBound(
-        currTime,
-        purpose1,
-        purpose2,
-        purpose3,
-        purpose4);
+    TfTokenVector purposes;
+    if (drawRenderPurpose) {
+        purposes.push_back(UsdGeomTokens->render);
+    }
+    if (drawProxyPurpose) {
+        purposes.push_back(UsdGeomTokens->proxy);
+    }
+    if (drawGuidePurpose) {
+        purposes.push_back(UsdGeomTokens->guide);
+    }
 
-    MBoundingBox &retval = nonConstThis->_boundingBoxCache[currTime];
+    // Bounds of static subtrees are shared by all times, and only the bounds
+    // of prims changed in the stage are recomputed.
+    nonConstThis->_boundsCache.SetIncludedPurposes(purposes);
+    const GfRange3d boxRange =
+        nonConstThis->_boundsCache.ComputeUntransformedBound(prim, currTime);
 
-    const GfRange3d boxRange = allBox.ComputeAlignedBox();
+    MBoundingBox retval;
 
     // Convert to GfRange3d to MBoundingBox
     if ( !boxRange.IsEmpty() ) {
@@ -694,7 +926,7 @@ MayaUsdProxyShapeBase::boundingBox() const
 void
 MayaUsdProxyShapeBase::clearBoundingBoxCache()
 {
-    _boundingBoxCache.clear();
+    _boundsCache.ClearRequestedBounds();
 }
 
 bool
@@ -795,6 +1027,111 @@ MayaUsdProxyShapeBase::_GetTime(MDataBlock dataBlock) const
     return UsdTimeCode(dataBlock.inputValue(timeAttr, &status).asTime().value());
 }
 
+bool
+MayaUsdProxyShapeBase::isCullingEnabled() const
+{
+    return _GetCullingEnabled( const_cast<MayaUsdProxyShapeBase*>(this)->forceCache() );
+}
+
+bool
+MayaUsdProxyShapeBase::_GetCullingEnabled(MDataBlock dataBlock) const
+{
+    MStatus status;
+
+    return dataBlock.inputValue(cullingEnabledAttr, &status).asBool();
+}
+
+float
+MayaUsdProxyShapeBase::getCullingPixelThreshold() const
+{
+    return _GetCullingPixelThreshold( const_cast<MayaUsdProxyShapeBase*>(this)->forceCache() );
+}
+
+float
+MayaUsdProxyShapeBase::_GetCullingPixelThreshold(MDataBlock dataBlock) const
+{
+    MStatus status;
+
+    return dataBlock.inputValue(cullingPixelThresholdAttr, &status).asFloat();
+}
+
+bool
+MayaUsdProxyShapeBase::isLodEnabled() const
+{
+    return _GetLodEnabled( const_cast<MayaUsdProxyShapeBase*>(this)->forceCache() );
+}
+
+bool
+MayaUsdProxyShapeBase::_GetLodEnabled(MDataBlock dataBlock) const
+{
+    MStatus status;
+
+    return dataBlock.inputValue(lodEnabledAttr, &status).asBool();
+}
+
+float
+MayaUsdProxyShapeBase::getLodPixelThreshold() const
+{
+    return _GetLodPixelThreshold( const_cast<MayaUsdProxyShapeBase*>(this)->forceCache() );
+}
+
+float
+MayaUsdProxyShapeBase::_GetLodPixelThreshold(MDataBlock dataBlock) const
+{
+    MStatus status;
+
+    return dataBlock.inputValue(lodPixelThresholdAttr, &status).asFloat();
+}
+
+bool
+MayaUsdProxyShapeBase::isInstanceCullingEnabled() const
+{
+    return _GetInstanceCullingEnabled( const_cast<MayaUsdProxyShapeBase*>(this)->forceCache() );
+}
+
+bool
+MayaUsdProxyShapeBase::_GetInstanceCullingEnabled(MDataBlock dataBlock) const
+{
+    MStatus status;
+
+    return dataBlock.inputValue(instanceCullingEnabledAttr, &status).asBool();
+}
+
+bool
+MayaUsdProxyShapeBase::isAsyncLoadEnabled() const
+{
+    return _GetAsyncLoadEnabled( const_cast<MayaUsdProxyShapeBase*>(this)->forceCache() );
+}
+
+bool
+MayaUsdProxyShapeBase::_GetAsyncLoadEnabled(MDataBlock dataBlock) const
+{
+    MStatus status;
+
+    return dataBlock.inputValue(asyncLoadAttr, &status).asBool();
+}
+
+bool
+MayaUsdProxyShapeBase::isStageLoading() const
+{
+    return _stageLoader &&
+        _stageLoader->GetState() == UsdMayaStageLoader::State::Loading;
+}
+
+const UsdMayaStageLoader*
+MayaUsdProxyShapeBase::getStageLoader() const
+{
+    return _stageLoader.get();
+}
+
+void
+MayaUsdProxyShapeBase::cancelStageLoad()
+{
+    if (_stageLoader) {
+        _stageLoader->Cancel();
+    }
+}
+
 UsdStageRefPtr
 MayaUsdProxyShapeBase::getUsdStage() const
 {
@@ -925,7 +1262,8 @@ MayaUsdProxyShapeBase::parentTransform()
 }
 
 MayaUsdProxyShapeBase::MayaUsdProxyShapeBase() :
-    MPxSurfaceShape()
+    MPxSurfaceShape(),
+    _boundsCache(TfGetEnvSetting(MAYAUSD_PROXY_SHAPE_BOUNDS_CACHE_TIMES))
 {
     TfRegistryManager::GetInstance().SubscribeTo<MayaUsdProxyShapeBase>();
 }
@@ -933,9 +1271,9 @@ MayaUsdProxyShapeBase::MayaUsdProxyShapeBase() :
 /* virtual */
 MayaUsdProxyShapeBase::~MayaUsdProxyShapeBase()
 {
-    //
-    // empty
-    //
+    _ResetStageLoader();
+
+    UsdMayaStageCache::SetStageReference(this, nullptr);
 }
 
 MSelectionMask
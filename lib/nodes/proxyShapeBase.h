@@ -20,6 +20,7 @@
 
 #include "../base/api.h"
 #include "../listeners/stageNoticeListener.h"
+#include "../utils/boundsCache.h"
 #include "usdPrimProvider.h"
 
 #include "pxr/pxr.h"
@@ -38,6 +39,7 @@
 #include <maya/MDataBlock.h>
 #include <maya/MDataHandle.h>
 #include <maya/MDGContext.h>
+#include <maya/MMessage.h>
 #include <maya/MObject.h>
 #include <maya/MPlug.h>
 #include <maya/MPlugArray.h>
@@ -48,6 +50,7 @@
 #include <maya/MTypeId.h>
 
 #include <map>
+#include <memory>
 
 #if defined(WANT_UFE_BUILD)
 #include <ufe/ufe.h>
@@ -74,6 +77,9 @@ TF_DECLARE_PUBLIC_TOKENS(MayaUsdProxyShapeBaseTokens,
                          MAYAUSD_PROXY_SHAPE_BASE_TOKENS);
 
 
+class UsdMayaStageLoader;
+
+
 class MayaUsdProxyShapeBase : public MPxSurfaceShape,
                               public UsdMayaUsdPrimProvider
 {
@@ -113,6 +119,22 @@ class MayaUsdProxyShapeBase : public MPxSurfaceShape,
         static MObject drawProxyPurposeAttr;
         MAYAUSD_CORE_PUBLIC
         static MObject drawGuidePurposeAttr;
+        MAYAUSD_CORE_PUBLIC
+        static MObject cullingEnabledAttr;
+        MAYAUSD_CORE_PUBLIC
+        static MObject cullingPixelThresholdAttr;
+        MAYAUSD_CORE_PUBLIC
+        static MObject lodEnabledAttr;
+        MAYAUSD_CORE_PUBLIC
+        static MObject lodPixelThresholdAttr;
+        MAYAUSD_CORE_PUBLIC
+        static MObject instanceCullingEnabledAttr;
+        MAYAUSD_CORE_PUBLIC
+        static MObject asyncLoadAttr;
+        MAYAUSD_CORE_PUBLIC
+        static MObject progressiveLoadAttr;
+        MAYAUSD_CORE_PUBLIC
+        static MObject stageLoadedAttr;
 
         /// Delegate function for computing the closest point and surface normal
         /// on the proxy shape to a given ray.
@@ -185,8 +207,36 @@ class MayaUsdProxyShapeBase : public MPxSurfaceShape,
         MAYAUSD_CORE_PUBLIC
         virtual UsdTimeCode     getTime() const;
         MAYAUSD_CORE_PUBLIC
+        bool isCullingEnabled() const;
+        MAYAUSD_CORE_PUBLIC
+        float getCullingPixelThreshold() const;
+        MAYAUSD_CORE_PUBLIC
+        bool isLodEnabled() const;
+        MAYAUSD_CORE_PUBLIC
+        float getLodPixelThreshold() const;
+        MAYAUSD_CORE_PUBLIC
+        bool isInstanceCullingEnabled() const;
+        MAYAUSD_CORE_PUBLIC
         virtual UsdStageRefPtr  getUsdStage() const;
 
+        /// Whether the stage of the file path is loaded in background.
+        MAYAUSD_CORE_PUBLIC
+        bool isAsyncLoadEnabled() const;
+
+        /// Whether the stage of the file path is being loaded in background.
+        /// The stage of the shape is null until loaded.
+        MAYAUSD_CORE_PUBLIC
+        bool isStageLoading() const;
+
+        /// Return the loader of the stage loaded in background, or null if
+        /// the stage isn't loaded in background.
+        MAYAUSD_CORE_PUBLIC
+        const UsdMayaStageLoader* getStageLoader() const;
+
+        /// Cancel loading the stage in background, if any.
+        MAYAUSD_CORE_PUBLIC
+        void cancelStageLoad();
+
         MAYAUSD_CORE_PUBLIC
         bool GetAllRenderAttributes(
                 UsdPrim* usdPrimOut,
@@ -202,7 +252,8 @@ class MayaUsdProxyShapeBase : public MPxSurfaceShape,
                 const MPlug& plug,
                 MPlugArray& plugArray) override;
 
-        /// \brief  Clears the bounding box cache of the shape
+        /// \brief  Clears the bounding box cache of the shape. Cached bounds
+        ///         of prims are kept since stage changes invalidate them.
         MAYAUSD_CORE_PUBLIC
         void clearBoundingBoxCache();
 
@@ -266,9 +317,25 @@ class MayaUsdProxyShapeBase : public MPxSurfaceShape,
         MStatus computeInStageDataCached(MDataBlock& dataBlock);
         MStatus computeOutStageData(MDataBlock& dataBlock);
 
+        UsdStageRefPtr _GetLoadedStage(
+                MDataBlock& dataBlock,
+                const std::string& fileString);
+        void _ResetStageLoader();
+        void _OnStageLoaderTimer();
+        static void _StageLoaderTimerCallback(
+                float elapsedTime,
+                float lastTime,
+                void* clientData);
+
         SdfPathVector _GetExcludePrimPaths(MDataBlock dataBlock) const;
         int _GetComplexity(MDataBlock dataBlock) const;
         UsdTimeCode _GetTime(MDataBlock dataBlock) const;
+        bool _GetCullingEnabled(MDataBlock dataBlock) const;
+        float _GetCullingPixelThreshold(MDataBlock dataBlock) const;
+        bool _GetLodEnabled(MDataBlock dataBlock) const;
+        float _GetLodPixelThreshold(MDataBlock dataBlock) const;
+        bool _GetInstanceCullingEnabled(MDataBlock dataBlock) const;
+        bool _GetAsyncLoadEnabled(MDataBlock dataBlock) const;
 
         bool _GetDrawPurposeToggles(
                 MDataBlock dataBlock,
@@ -281,9 +348,12 @@ class MayaUsdProxyShapeBase : public MPxSurfaceShape,
 
         UsdMayaStageNoticeListener _stageNoticeListener;
 
-        std::map<UsdTimeCode, MBoundingBox> _boundingBoxCache;
+        UsdMayaBoundsCache                  _boundsCache;
         size_t                              _excludePrimPathsVersion{ 1 };
 
+        std::unique_ptr<UsdMayaStageLoader> _stageLoader;
+        MCallbackId                         _stageLoaderCallbackId{ 0 };
+
         static ClosestPointDelegate _sharedClosestPointDelegate;
 };
 
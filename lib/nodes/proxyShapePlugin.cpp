@@ -16,9 +16,12 @@
 #include "proxyShapePlugin.h"
 
 #include "../render/vp2RenderDelegate/proxyRenderDelegate.h"
+#include "../render/vp2RenderDelegate/renderStatsCommand.h"
 #include "../render/vp2ShaderFragments/shaderFragments.h"
 
+#include "stageCacheCommand.h"
 #include "stageData.h"
+#include "stageLoadCommand.h"
 #include "proxyShapeBase.h"
 
 #include "pxr/base/tf/envSetting.h"
@@ -85,6 +88,24 @@ MayaUsdProxyShapePlugin::initialize(MFnPlugin& plugin)
     status = HdVP2ShaderFragments::registerFragments();
     CHECK_MSTATUS(status);
 
+    status = plugin.registerCommand(
+        HdVP2RenderStatsCommand::commandName,
+        HdVP2RenderStatsCommand::creator,
+        HdVP2RenderStatsCommand::createSyntax);
+    CHECK_MSTATUS(status);
+
+    status = plugin.registerCommand(
+        MayaUsdStageLoadCommand::commandName,
+        MayaUsdStageLoadCommand::creator,
+        MayaUsdStageLoadCommand::createSyntax);
+    CHECK_MSTATUS(status);
+
+    status = plugin.registerCommand(
+        MayaUsdStageCacheCommand::commandName,
+        MayaUsdStageCacheCommand::creator,
+        MayaUsdStageCacheCommand::createSyntax);
+    CHECK_MSTATUS(status);
+
     return status;
 }
 
@@ -107,7 +128,16 @@ MayaUsdProxyShapePlugin::finalize(MFnPlugin& plugin)
         return MS::kSuccess;
     }
 
-    MStatus status = HdVP2ShaderFragments::deregisterFragments();
+    MStatus status = plugin.deregisterCommand(HdVP2RenderStatsCommand::commandName);
+    CHECK_MSTATUS(status);
+
+    status = plugin.deregisterCommand(MayaUsdStageLoadCommand::commandName);
+    CHECK_MSTATUS(status);
+
+    status = plugin.deregisterCommand(MayaUsdStageCacheCommand::commandName);
+    CHECK_MSTATUS(status);
+
+    status = HdVP2ShaderFragments::deregisterFragments();
     CHECK_MSTATUS(status);
     
         status = MHWRender::MDrawRegistry::deregisterSubSceneOverrideCreator(
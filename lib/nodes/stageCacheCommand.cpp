@@ -0,0 +1,138 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "stageCacheCommand.h"
+
+#include "../utils/stageCache.h"
+
+#include "pxr/base/js/json.h"
+
+#include <maya/MArgDatabase.h>
+
+#include <cstdint>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+
+const char* _rootLayerFlag = "rl";
+const char* _rootLayerFlagLong = "rootLayer";
+const char* _evictUnreferencedFlag = "eu";
+const char* _evictUnreferencedFlagLong = "evictUnreferenced";
+const char* _maxUnreferencedFlag = "mu";
+const char* _maxUnreferencedFlagLong = "maxUnreferenced";
+const char* _sessionLayerStatsFlag = "sls";
+const char* _sessionLayerStatsFlagLong = "sessionLayerStats";
+
+JsValue
+_ToJson(size_t value)
+{
+    return JsValue(static_cast<uint64_t>(value));
+}
+
+} // anonymous namespace
+
+
+const MString MayaUsdStageCacheCommand::commandName("mayaUsdStageCache");
+
+/* static */
+MSyntax
+MayaUsdStageCacheCommand::createSyntax()
+{
+    MSyntax syntax;
+    syntax.addFlag(_rootLayerFlag, _rootLayerFlagLong, MSyntax::kString);
+    syntax.addFlag(_evictUnreferencedFlag, _evictUnreferencedFlagLong);
+    syntax.addFlag(
+        _maxUnreferencedFlag, _maxUnreferencedFlagLong, MSyntax::kUnsigned);
+    syntax.addFlag(_sessionLayerStatsFlag, _sessionLayerStatsFlagLong);
+
+    syntax.enableQuery(false);
+    syntax.enableEdit(false);
+
+    return syntax;
+}
+
+/* static */
+void*
+MayaUsdStageCacheCommand::creator()
+{
+    return new MayaUsdStageCacheCommand();
+}
+
+/* virtual */
+MStatus
+MayaUsdStageCacheCommand::doIt(const MArgList& args)
+{
+    MStatus status;
+    MArgDatabase argData(syntax(), args, &status);
+    if (!status) {
+        return status;
+    }
+
+    if (argData.isFlagSet(_evictUnreferencedFlag)) {
+        unsigned int maxNumUnreferenced = 0u;
+        if (argData.isFlagSet(_maxUnreferencedFlag)) {
+            argData.getFlagArgument(_maxUnreferencedFlag, 0, maxNumUnreferenced);
+        }
+
+        const size_t numEvicted =
+            UsdMayaStageCache::EvictUnreferencedStages(maxNumUnreferenced);
+        setResult(static_cast<int>(numEvicted));
+        return MS::kSuccess;
+    }
+
+    if (argData.isFlagSet(_sessionLayerStatsFlag)) {
+        const UsdMayaStageCache::SessionLayerStats stats =
+            UsdMayaStageCache::GetSessionLayerStats();
+
+        JsObject result;
+        result["hits"] = _ToJson(stats.numHits);
+        result["misses"] = _ToJson(stats.numMisses);
+        result["collected"] = _ToJson(stats.numCollected);
+        result["live"] = _ToJson(stats.numLive);
+        setResult(MString(JsWriteToString(JsValue(result)).c_str()));
+        return MS::kSuccess;
+    }
+
+    MString rootLayerPath;
+    if (argData.isFlagSet(_rootLayerFlag)) {
+        argData.getFlagArgument(_rootLayerFlag, 0, rootLayerPath);
+    }
+
+    JsArray stages;
+    for (const UsdMayaStageCache::StageInfo& info :
+            UsdMayaStageCache::GetStageInfos(rootLayerPath.asChar())) {
+        JsObject stage;
+        stage["id"] = JsValue(UsdMayaStageCache::Get(info.forcePopulate)
+            .GetId(info.stage).ToString());
+        stage["rootLayer"] = JsValue(info.rootLayerPath);
+        stage["forcePopulate"] = JsValue(info.forcePopulate);
+        stage["tracked"] = JsValue(info.tracked);
+        stage["references"] = _ToJson(info.numReferences);
+        stage["layers"] = _ToJson(info.numLayers);
+        stage["prims"] = _ToJson(info.numPrims);
+        stage["memoryEstimate"] = _ToJson(info.memoryEstimate);
+        stages.push_back(JsValue(stage));
+    }
+
+    setResult(MString(JsWriteToString(JsValue(stages)).c_str()));
+
+    return MS::kSuccess;
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
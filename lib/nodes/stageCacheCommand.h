@@ -0,0 +1,81 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef PXRUSDMAYA_STAGE_CACHE_COMMAND_H
+#define PXRUSDMAYA_STAGE_CACHE_COMMAND_H
+
+/// \file usdMaya/stageCacheCommand.h
+
+#include "../base/api.h"
+
+#include "pxr/pxr.h"
+
+#include <maya/MPxCommand.h>
+#include <maya/MString.h>
+#include <maya/MSyntax.h>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Report the contents of the USD stage caches of Maya, or evict the stages
+/// no proxy shape references any more.
+///
+/// Without flags, the command returns a JSON string with an array of the
+/// cached stages, optionally filtered by root layer path:
+///
+///     import json
+///     stages = json.loads(cmds.mayaUsdStageCache())
+///     stages = json.loads(cmds.mayaUsdStageCache(rootLayer='/shots/a.usd'))
+///
+/// Each stage reports its cache id, root layer, whether it is force
+/// populated, its number of references by proxy shapes, and its numbers of
+/// layers and prims along with a rough memory estimate in bytes.
+///
+///     cmds.mayaUsdStageCache(evictUnreferenced=True)
+///
+/// evicts all unreferenced stages and returns their number, and
+///
+///     cmds.mayaUsdStageCache(evictUnreferenced=True, maxUnreferenced=2)
+///
+/// keeps the 2 most recently released of them.
+///
+///     stats = json.loads(cmds.mayaUsdStageCache(sessionLayerStats=True))
+///
+/// returns the numbers of hits, misses, collected and live shared session
+/// layers of the assemblies.
+class MayaUsdStageCacheCommand : public MPxCommand
+{
+public:
+    MAYAUSD_CORE_PUBLIC
+    static const MString commandName;
+
+    MAYAUSD_CORE_PUBLIC
+    static MSyntax createSyntax();
+
+    MAYAUSD_CORE_PUBLIC
+    static void* creator();
+
+    MAYAUSD_CORE_PUBLIC
+    MStatus doIt(const MArgList& args) override;
+
+    bool isUndoable() const override { return false; }
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+
+#endif
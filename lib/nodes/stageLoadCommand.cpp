@@ -0,0 +1,120 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "stageLoadCommand.h"
+
+#include "proxyShapeBase.h"
+#include "../utils/stageLoader.h"
+
+#include <maya/MArgDatabase.h>
+#include <maya/MDagPath.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MSelectionList.h>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+
+const char* _progressFlag = "p";
+const char* _progressFlagLong = "progress";
+const char* _stateFlag = "s";
+const char* _stateFlagLong = "state";
+const char* _cancelFlag = "c";
+const char* _cancelFlagLong = "cancel";
+
+} // anonymous namespace
+
+
+const MString MayaUsdStageLoadCommand::commandName("mayaUsdStageLoad");
+
+/* static */
+MSyntax
+MayaUsdStageLoadCommand::createSyntax()
+{
+    MSyntax syntax;
+    syntax.addFlag(_progressFlag, _progressFlagLong);
+    syntax.addFlag(_stateFlag, _stateFlagLong);
+    syntax.addFlag(_cancelFlag, _cancelFlagLong);
+
+    syntax.setObjectType(MSyntax::kSelectionList, 1, 1);
+    syntax.useSelectionAsDefault(true);
+
+    syntax.enableQuery(true);
+    syntax.enableEdit(false);
+
+    return syntax;
+}
+
+/* static */
+void*
+MayaUsdStageLoadCommand::creator()
+{
+    return new MayaUsdStageLoadCommand();
+}
+
+/* virtual */
+MStatus
+MayaUsdStageLoadCommand::doIt(const MArgList& args)
+{
+    MStatus status;
+    MArgDatabase argData(syntax(), args, &status);
+    if (!status) {
+        return status;
+    }
+
+    MSelectionList objects;
+    argData.getObjects(objects);
+
+    MDagPath dagPath;
+    status = objects.getDagPath(0, dagPath);
+    if (status) {
+        dagPath.extendToShape();
+    }
+
+    const MFnDependencyNode fnDepNode(dagPath.node(), &status);
+    auto* proxyShape = status ?
+        dynamic_cast<MayaUsdProxyShapeBase*>(fnDepNode.userNode()) : nullptr;
+    if (!proxyShape) {
+        displayError("A USD proxy shape is expected.");
+        return MS::kInvalidParameter;
+    }
+
+    const UsdMayaStageLoader* stageLoader = proxyShape->getStageLoader();
+
+    if (argData.isQuery()) {
+        if (argData.isFlagSet(_progressFlag)) {
+            setResult(stageLoader ? stageLoader->GetProgress() : 0.0f);
+        }
+        else if (argData.isFlagSet(_stateFlag)) {
+            setResult(stageLoader ?
+                UsdMayaStageLoader::GetStateName(stageLoader->GetState()) :
+                "none");
+        }
+        else {
+            displayError("The progress or state flag is expected in query mode.");
+            return MS::kInvalidParameter;
+        }
+    }
+    else if (argData.isFlagSet(_cancelFlag)) {
+        proxyShape->cancelStageLoad();
+    }
+
+    return MS::kSuccess;
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
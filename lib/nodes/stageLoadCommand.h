@@ -0,0 +1,66 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef PXRUSDMAYA_STAGE_LOAD_COMMAND_H
+#define PXRUSDMAYA_STAGE_LOAD_COMMAND_H
+
+/// \file usdMaya/stageLoadCommand.h
+
+#include "../base/api.h"
+
+#include "pxr/pxr.h"
+
+#include <maya/MPxCommand.h>
+#include <maya/MString.h>
+#include <maya/MSyntax.h>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Query or cancel the loading of the stage of a proxy shape whose
+/// asyncLoad attribute is on.
+///
+/// The command takes a proxy shape, or its transform:
+///
+///     cmds.mayaUsdStageLoad('stageShape1', query=True, progress=True)
+///     cmds.mayaUsdStageLoad('stageShape1', query=True, state=True)
+///     cmds.mayaUsdStageLoad('stageShape1', cancel=True)
+///
+/// The state is "loading", "ready", "cancelled" or "failed", or "none" when
+/// the stage isn't loaded in background.
+class MayaUsdStageLoadCommand : public MPxCommand
+{
+public:
+    MAYAUSD_CORE_PUBLIC
+    static const MString commandName;
+
+    MAYAUSD_CORE_PUBLIC
+    static MSyntax createSyntax();
+
+    MAYAUSD_CORE_PUBLIC
+    static void* creator();
+
+    MAYAUSD_CORE_PUBLIC
+    MStatus doIt(const MArgList& args) override;
+
+    bool isUndoable() const override { return false; }
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+
+#endif
@@ -0,0 +1,247 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "attributePrefetcher.h"
+#include "mesh.h"
+#include "render_delegate.h"
+
+#include "pxr/imaging/hd/changeTracker.h"
+#include "pxr/imaging/hd/renderIndex.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "pxr/usd/usdGeom/primvarsAPI.h"
+#include "pxr/usd/usdGeom/tokens.h"
+#include "pxr/usd/usdSkel/root.h"
+#include "pxr/usdImaging/usdImaging/delegate.h"
+
+#include <maya/MProfiler.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <vector>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+    //! Number of Rprims prefetched by each parallel task
+    constexpr size_t kPrefetchGrainSize = 64;
+
+    //! Helper utility function to create a query for a time-varying attribute
+    UsdAttributeQuery _CreateTimeVaryingQuery(const UsdAttribute& attr)
+    {
+        return (attr && attr.ValueMightBeTimeVarying()) ?
+            UsdAttributeQuery(attr) : UsdAttributeQuery();
+    }
+
+} // namespace
+
+/*! \brief  Constructor
+*/
+HdVP2AttributePrefetcher::HdVP2AttributePrefetcher()
+{
+    _stageListener.SetStageObjectsChangedCallback(
+        [this](const UsdNotice::ObjectsChanged& notice) {
+            _OnObjectsChanged(notice);
+        });
+}
+
+/*! \brief  Destructor
+*/
+HdVP2AttributePrefetcher::~HdVP2AttributePrefetcher() = default;
+
+/*! \brief  Set the stage of the prefetched prims, releasing cached queries.
+*/
+void HdVP2AttributePrefetcher::SetStage(const UsdStageRefPtr& stage)
+{
+    if (_stage == stage) {
+        return;
+    }
+
+    _stage = stage;
+    _stageListener.SetStage(stage);
+    _queries.clear();
+    _values.clear();
+}
+
+/*! \brief  Read time-varying points and normals of dirty Rprims at the
+            given time, replacing previously prefetched values.
+
+    Must be called after the time of the scene delegate has been set, so
+    Rprims with time-varying data are dirty.
+
+    \return Number of Rprims with prefetched values
+*/
+size_t HdVP2AttributePrefetcher::Prefetch(
+    HdRenderIndex& renderIndex,
+    UsdImagingDelegate& sceneDelegate,
+    UsdTimeCode time)
+{
+    _values.clear();
+
+    if (!_stage) {
+        return 0;
+    }
+
+    MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
+        MProfiler::kColorC_L1, "PrefetchAttributes");
+
+    //! An Rprim to prefetch. Map entries are inserted before the parallel
+    //! reads, which only fill them.
+    struct Item {
+        const SdfPath*  _primPath;
+        HdDirtyBits     _dirtyBits;
+        Queries*        _queries;
+        Values*         _values;
+    };
+    std::vector<Item> items;
+
+    constexpr HdDirtyBits kPrefetchedBits =
+        HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyNormals;
+
+    const HdChangeTracker& changeTracker = renderIndex.GetChangeTracker();
+    const SdfPathVector& rprimIds = renderIndex.GetRprimIds();
+
+    for (const SdfPath& id : rprimIds) {
+        const HdDirtyBits dirtyBits = changeTracker.GetRprimDirtyBits(id);
+        if (!(dirtyBits & kPrefetchedBits)) {
+            continue;
+        }
+
+        // Instanced Rprims are populated from prototypes, and culled Rprims
+        // defer their changes until they get into view.
+        const HdVP2Mesh* mesh = dynamic_cast<const HdVP2Mesh*>(renderIndex.GetRprim(id));
+        if (!mesh || !mesh->GetInstancerId().IsEmpty() ||
+            mesh->GetCullingResult() != kDrawFullDetail) {
+            continue;
+        }
+
+        auto it = _queries.emplace(
+            sceneDelegate.ConvertIndexPathToCachePath(id), Queries()).first;
+
+        items.push_back({ &it->first, dirtyBits, &it->second, &_values[id] });
+    }
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, items.size(), kPrefetchGrainSize),
+        [this, &items, time](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); i++) {
+                const Item& item = items[i];
+                Queries& queries = *item._queries;
+
+                if (!queries._valid) {
+                    _CreateQueries(_stage->GetPrimAtPath(*item._primPath), queries);
+                }
+
+                if ((item._dirtyBits & HdChangeTracker::DirtyPoints) && queries._points.IsValid()) {
+                    queries._points.Get(&item._values->_points, time);
+                }
+
+                if ((item._dirtyBits & HdChangeTracker::DirtyNormals) && queries._normals.IsValid()) {
+                    queries._normals.Get(&item._values->_normals, time);
+                }
+            }
+        }
+    );
+
+    return items.size();
+}
+
+/*! \brief  Create queries of time-varying points and normals of a mesh.
+
+    Skinned meshes are skipped since their points are computed by the scene
+    delegate. Like the scene delegate, normals primvar takes precedence over
+    normals attribute.
+*/
+void HdVP2AttributePrefetcher::_CreateQueries(const UsdPrim& prim, Queries& queries)
+{
+    queries._valid = true;
+
+    if (!prim.IsA<UsdGeomMesh>() || IsSkinned(prim)) {
+        return;
+    }
+
+    const UsdGeomMesh mesh(prim);
+    queries._points = _CreateTimeVaryingQuery(mesh.GetPointsAttr());
+
+    const UsdGeomPrimvar normals =
+        UsdGeomPrimvarsAPI(prim).GetPrimvar(UsdGeomTokens->normals);
+    if (normals && normals.HasAuthoredValue()) {
+        if (!normals.IsIndexed()) {
+            queries._normals = _CreateTimeVaryingQuery(normals.GetAttr());
+        }
+    }
+    else {
+        const UsdAttribute normalsAttr = mesh.GetNormalsAttr();
+        if (normalsAttr.HasAuthoredValue()) {
+            queries._normals = _CreateTimeVaryingQuery(normalsAttr);
+        }
+    }
+}
+
+/*! \brief  Returns whether points of the prim may be skinned by the scene delegate.
+
+    Skinning applies to meshes under a SkelRoot, bound to a skeleton either
+    directly or through bindings inherited from an ancestor, so any prim under
+    a SkelRoot is considered skinned rather than only prims with the binding
+    API applied.
+*/
+bool HdVP2AttributePrefetcher::IsSkinned(const UsdPrim& prim)
+{
+    return static_cast<bool>(UsdSkelRoot::Find(prim));
+}
+
+/*! \brief  Returns prefetched points of the Rprim, or null if not prefetched.
+*/
+const VtValue* HdVP2AttributePrefetcher::GetPoints(const SdfPath& id) const
+{
+    const auto it = _values.find(id);
+    return (it != _values.end() && !it->second._points.IsEmpty()) ?
+        &it->second._points : nullptr;
+}
+
+/*! \brief  Returns prefetched normals of the Rprim, or null if not prefetched.
+*/
+const VtValue* HdVP2AttributePrefetcher::GetNormals(const SdfPath& id) const
+{
+    const auto it = _values.find(id);
+    return (it != _values.end() && !it->second._normals.IsEmpty()) ?
+        &it->second._normals : nullptr;
+}
+
+/*! \brief  Release cached queries of changed prims, and all prefetched values.
+*/
+void HdVP2AttributePrefetcher::_OnObjectsChanged(const UsdNotice::ObjectsChanged& notice)
+{
+    _values.clear();
+
+    for (const SdfPath& path : notice.GetResyncedPaths()) {
+        for (auto it = _queries.begin(); it != _queries.end(); ) {
+            if (it->first.HasPrefix(path)) {
+                it = _queries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    for (const SdfPath& path : notice.GetChangedInfoOnlyPaths()) {
+        _queries.erase(path.GetPrimPath());
+    }
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,100 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HD_VP2_ATTRIBUTE_PREFETCHER
+#define HD_VP2_ATTRIBUTE_PREFETCHER
+
+#include "pxr/pxr.h"
+#include "pxr/base/vt/value.h"
+#include "pxr/usd/sdf/path.h"
+#include "pxr/usd/usd/attributeQuery.h"
+#include "pxr/usd/usd/notice.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usd/timeCode.h"
+
+#include "../../listeners/stageNoticeListener.h"
+
+#include <unordered_map>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+class HdRenderIndex;
+class UsdImagingDelegate;
+
+/*! \brief  Batched reads of time-varying points and normals of Rprims.
+    \class  HdVP2AttributePrefetcher
+
+    When the time of the scene delegate changes, values of time-varying points
+    and normals of all dirty Rprims are read in parallel, before Hydra sync,
+    through UsdAttributeQuery objects cached per Rprim. Rprims take prefetched
+    values in Sync instead of requesting them from the scene delegate, which
+    would resolve each attribute from scratch.
+
+    Only non-instanced, non-skinned meshes drawn with full detail are
+    prefetched, and normals only when they aren't indexed. Cached queries of
+    a prim are released when it changes in the stage.
+
+    Prefetch() and notice handling happen on main thread, values are read
+    from worker threads during sync.
+*/
+class HdVP2AttributePrefetcher final
+{
+public:
+    HdVP2AttributePrefetcher();
+    ~HdVP2AttributePrefetcher();
+
+    void SetStage(const UsdStageRefPtr& stage);
+
+    size_t Prefetch(HdRenderIndex& renderIndex,
+        UsdImagingDelegate& sceneDelegate, UsdTimeCode time);
+
+    const VtValue* GetPoints(const SdfPath& id) const;
+    const VtValue* GetNormals(const SdfPath& id) const;
+
+    static bool IsSkinned(const UsdPrim& prim);
+
+private:
+    HdVP2AttributePrefetcher(const HdVP2AttributePrefetcher&) = delete;
+    HdVP2AttributePrefetcher& operator=(const HdVP2AttributePrefetcher&) = delete;
+
+    void _OnObjectsChanged(const UsdNotice::ObjectsChanged& notice);
+
+    //! Queries of the prefetched attributes of a prim.
+    struct Queries {
+        UsdAttributeQuery   _points;    //!< Points, if time-varying
+        UsdAttributeQuery   _normals;   //!< Non-indexed normals, if time-varying
+        bool                _valid{ false };    //!< Whether the queries have been created
+    };
+
+    static void _CreateQueries(const UsdPrim& prim, Queries& queries);
+
+    //! Values prefetched for an Rprim.
+    struct Values {
+        VtValue             _points;    //!< Points, empty if not prefetched
+        VtValue             _normals;   //!< Normals, empty if not prefetched
+    };
+
+    using QueriesMap = std::unordered_map<SdfPath, Queries, SdfPath::Hash>;
+    using ValuesMap = std::unordered_map<SdfPath, Values, SdfPath::Hash>;
+
+    UsdStageRefPtr              _stage;             //!< Stage of the prefetched prims
+    UsdMayaStageNoticeListener  _stageListener;     //!< Listener invalidating queries of changed prims
+    QueriesMap                  _queries;           //!< Cached queries indexed by prim path
+    ValuesMap                   _values;            //!< Prefetched values indexed by Rprim id
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HD_VP2_ATTRIBUTE_PREFETCHER
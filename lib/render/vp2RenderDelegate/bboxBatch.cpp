@@ -0,0 +1,278 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "bboxBatch.h"
+#include "bboxGeom.h"
+#include "render_delegate.h"
+
+#include "pxr/base/tf/stringUtils.h"
+
+#include <maya/MProfiler.h>
+#include <maya/MSelectionMask.h>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+    const MColor kOpaqueBlue(0.0f, 0.0f, 1.0f, 1.0f);      //!< Opaque blue
+    const unsigned int kNumColorChannels = 4;              //!< The number of color channels
+    const MString kSolidColorStr("solidColor");            //!< Cached string for efficiency
+
+    //! Helper utility function to adapt Maya API changes.
+    void setWantConsolidation(MHWRender::MRenderItem& renderItem, bool state)
+    {
+#if MAYA_API_VERSION >= 20190000
+        renderItem.setWantConsolidation(state);
+#else
+        renderItem.setWantSubSceneConsolidation(state);
+#endif
+    }
+
+} // namespace
+
+/*! \brief  Constructor.
+*/
+HdVP2BBoxBatch::HdVP2BBoxBatch()
+{
+    _renderItemName = TfStringPrintf("HdVP2BBoxBatch_%p", this).c_str();
+}
+
+/*! \brief  Assign a slot to the bounding box of an Rprim.
+
+    The slot is hidden until its instance is set. Thread safe.
+*/
+size_t HdVP2BBoxBatch::AcquireSlot(const SdfPath& rprimId)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    size_t slot;
+    if (!_freeSlots.empty()) {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+    else {
+        slot = _slots.size();
+        _slots.emplace_back();
+    }
+
+    _slots[slot]._rprimId = rprimId;
+    _slots[slot]._visible = false;
+
+    return slot;
+}
+
+/*! \brief  Release the slot of an Rprim. Thread safe.
+*/
+void HdVP2BBoxBatch::ReleaseSlot(size_t slot)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!TF_VERIFY(slot < _slots.size())) {
+        return;
+    }
+
+    Slot& entry = _slots[slot];
+    if (entry._visible) {
+        _layoutDirty = true;
+    }
+
+    entry = Slot();
+    _freeSlots.push_back(slot);
+}
+
+/*! \brief  Update the bounding box of an Rprim. Thread safe.
+
+    \param slot     Slot of the Rprim
+    \param matrix   Matrix mapping the unit cube to world bounds of the Rprim
+    \param visible  Whether the bounding box is drawn
+    \param color    Wireframe or selection highlight color
+*/
+void HdVP2BBoxBatch::SetInstance(size_t slot,
+    const MMatrix& matrix, bool visible, const MColor& color)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!TF_VERIFY(slot < _slots.size())) {
+        return;
+    }
+
+    Slot& entry = _slots[slot];
+
+    if (entry._visible != visible) {
+        entry._visible = visible;
+        _layoutDirty = true;
+    }
+
+    if (entry._matrix != matrix) {
+        entry._matrix = matrix;
+        if (visible) {
+            _dirtySlots.push_back(slot);
+        }
+    }
+
+    if (entry._color != color) {
+        entry._color = color;
+        _colorsDirty |= visible;
+    }
+}
+
+/*! \brief  Transfer changes of slots to the batch render item.
+
+    The instance array is rebuilt when bounding boxes are shown or hidden,
+    otherwise only the instances whose matrix changed are updated, unless
+    they are too many. Call from main thread only.
+*/
+void HdVP2BBoxBatch::Commit(MSubSceneContainer& container,
+    MHWRender::MPxSubSceneOverride& subSceneOverride,
+    HdVP2RenderDelegate& delegate)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_layoutDirty && !_colorsDirty && _dirtySlots.empty()) {
+        return;
+    }
+
+    MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
+        MProfiler::kColorC_L2, "CommitBBoxBatch");
+
+    MHWRender::MRenderItem* renderItem = container.find(_renderItemName);
+    if (!renderItem) {
+        renderItem = _CreateRenderItem(delegate);
+        container.add(renderItem);
+
+        const HdVP2BBoxGeom& sharedBBoxGeom = delegate.GetSharedBBoxGeom();
+
+        MHWRender::MVertexBufferArray vertexBuffers;
+        vertexBuffers.addBuffer("positions", const_cast<MHWRender::MVertexBuffer*>(
+            sharedBBoxGeom.GetPositionBuffer()));
+
+        const GfVec3d& min = sharedBBoxGeom.GetRange().GetMin();
+        const GfVec3d& max = sharedBBoxGeom.GetRange().GetMax();
+        const MBoundingBox bounds(MPoint(min[0], min[1], min[2]), MPoint(max[0], max[1], max[2]));
+
+        subSceneOverride.setGeometryForRenderItem(*renderItem, vertexBuffers,
+            *const_cast<MHWRender::MIndexBuffer*>(sharedBBoxGeom.GetIndexBuffer()), &bounds);
+
+        _layoutDirty = true;
+    }
+
+    // Updating a few instances in place is cheaper than transferring the
+    // whole instance array.
+    const bool updateInPlace = !_layoutDirty && (_dirtySlots.size() * 4 < _drawnSlots.size());
+
+    if (_layoutDirty) {
+        _drawnSlots.clear();
+        for (size_t slot = 0; slot < _slots.size(); slot++) {
+            Slot& entry = _slots[slot];
+            if (entry._visible) {
+                entry._drawnIndex = static_cast<unsigned int>(_drawnSlots.size());
+                _drawnSlots.push_back(slot);
+            }
+        }
+    }
+
+    if (updateInPlace) {
+        for (const size_t slot : _dirtySlots) {
+            const Slot& entry = _slots[slot];
+            if (entry._visible) {
+                // VP2 defines instance ID of the first instance to be 1.
+                subSceneOverride.updateInstanceTransform(*renderItem,
+                    entry._drawnIndex + 1, entry._matrix);
+            }
+        }
+    }
+    else if (!_drawnSlots.empty()) {
+        MMatrixArray matrices;
+        matrices.setLength(static_cast<unsigned int>(_drawnSlots.size()));
+        for (unsigned int i = 0; i < matrices.length(); i++) {
+            matrices[i] = _slots[_drawnSlots[i]]._matrix;
+        }
+        subSceneOverride.setInstanceTransformArray(*renderItem, matrices);
+    }
+
+    if ((_layoutDirty || _colorsDirty) && !_drawnSlots.empty()) {
+        MFloatArray colors;
+        colors.setLength(static_cast<unsigned int>(_drawnSlots.size()) * kNumColorChannels);
+
+        unsigned int offset = 0;
+        for (const size_t slot : _drawnSlots) {
+            const MColor& color = _slots[slot]._color;
+            for (unsigned int j = 0; j < kNumColorChannels; j++) {
+                colors[offset++] = color[j];
+            }
+        }
+        subSceneOverride.setExtraInstanceData(*renderItem, kSolidColorStr, colors);
+    }
+
+    renderItem->enable(!_drawnSlots.empty());
+
+    _dirtySlots.clear();
+    _layoutDirty = false;
+    _colorsDirty = false;
+}
+
+/*! \brief  Remove the batch render item from the container. Call from main
+            thread only.
+*/
+void HdVP2BBoxBatch::RemoveRenderItem(MSubSceneContainer& container)
+{
+    container.remove(_renderItemName);
+}
+
+/*! \brief  Get the Rprim of an instance of the batch render item.
+
+    \param drawnInstanceIndex   Index of the instance, starting from 0
+
+    \return Id of the Rprim, or an empty path if the index is invalid
+*/
+SdfPath HdVP2BBoxBatch::GetRprimId(int drawnInstanceIndex) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (drawnInstanceIndex < 0 ||
+        static_cast<size_t>(drawnInstanceIndex) >= _drawnSlots.size()) {
+        return SdfPath();
+    }
+
+    return _slots[_drawnSlots[drawnInstanceIndex]]._rprimId;
+}
+
+/*! \brief  Create the batch render item.
+
+    GPU instancing is used from the first commit, so consolidation is turned
+    off.
+*/
+MHWRender::MRenderItem* HdVP2BBoxBatch::_CreateRenderItem(
+    HdVP2RenderDelegate& delegate) const
+{
+    MHWRender::MRenderItem* const renderItem = MHWRender::MRenderItem::Create(
+        _renderItemName,
+        MHWRender::MRenderItem::DecorationItem,
+        MHWRender::MGeometry::kLines
+    );
+
+    renderItem->setDrawMode(MHWRender::MGeometry::kBoundingBox);
+    renderItem->castsShadows(false);
+    renderItem->receivesShadows(false);
+    renderItem->setShader(delegate.Get3dSolidShader(kOpaqueBlue));
+    renderItem->setSelectionMask(MSelectionMask::kSelectMeshes);
+
+    setWantConsolidation(*renderItem, false);
+
+    return renderItem;
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
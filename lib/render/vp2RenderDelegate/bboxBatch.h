@@ -0,0 +1,103 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HD_VP2_BBOX_BATCH
+#define HD_VP2_BBOX_BATCH
+
+#include "pxr/pxr.h"
+#include "pxr/usd/sdf/path.h"
+
+#include <maya/MColor.h>
+#include <maya/MFloatArray.h>
+#include <maya/MMatrix.h>
+#include <maya/MMatrixArray.h>
+#include <maya/MPxSubSceneOverride.h>
+#include <maya/MString.h>
+
+#include <mutex>
+#include <vector>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+class HdVP2RenderDelegate;
+
+/*! \brief  Single instanced render item drawing bounding boxes of all Rprims.
+    \class  HdVP2BBoxBatch
+
+    Instead of one render item per Rprim, bounding box display of the Rprims
+    of a render delegate is drawn by one instanced render item using the
+    shared unit wire cube. Each Rprim owns a slot holding the matrix mapping
+    the unit cube to its world bounds, its visibility and its color. Slots
+    are updated by Rprims during sync from worker threads, and only the
+    changes are transferred to the render item by Commit() from main thread.
+*/
+class HdVP2BBoxBatch final
+{
+public:
+    //! Index of an unassigned slot
+    static constexpr size_t kInvalidSlot = static_cast<size_t>(-1);
+
+    HdVP2BBoxBatch();
+    ~HdVP2BBoxBatch() = default;
+
+    size_t AcquireSlot(const SdfPath& rprimId);
+    void ReleaseSlot(size_t slot);
+
+    void SetInstance(size_t slot, const MMatrix& matrix, bool visible, const MColor& color);
+
+    void Commit(MSubSceneContainer& container,
+        MHWRender::MPxSubSceneOverride& subSceneOverride,
+        HdVP2RenderDelegate& delegate);
+
+    void RemoveRenderItem(MSubSceneContainer& container);
+
+    /*! \brief  Get the name of the batch render item.
+    */
+    const MString& GetRenderItemName() const { return _renderItemName; }
+
+    SdfPath GetRprimId(int drawnInstanceIndex) const;
+
+private:
+    HdVP2BBoxBatch(const HdVP2BBoxBatch&) = delete;
+    HdVP2BBoxBatch& operator=(const HdVP2BBoxBatch&) = delete;
+
+    MHWRender::MRenderItem* _CreateRenderItem(HdVP2RenderDelegate& delegate) const;
+
+    //! Bounding box of an Rprim.
+    struct Slot {
+        SdfPath       _rprimId;                     //!< Owner Rprim, or empty if the slot is free
+        MMatrix       _matrix;                      //!< Matrix mapping the unit cube to world bounds
+        MColor        _color;                       //!< Wireframe or selection highlight color
+        bool          _visible{ false };            //!< Whether the bounding box is drawn
+        unsigned int  _drawnIndex{ 0 };             //!< Index in the instance array if drawn
+    };
+
+    std::vector<Slot>   _slots;                     //!< Slots of all Rprims
+    std::vector<size_t> _freeSlots;                 //!< Released slots, reused first
+    std::vector<size_t> _dirtySlots;                //!< Slots whose matrix changed since last commit
+    std::vector<size_t> _drawnSlots;                //!< Slot of each drawn instance, as of last commit
+
+    bool                _layoutDirty{ false };      //!< Whether the set of drawn slots changed
+    bool                _colorsDirty{ false };      //!< Whether any color changed
+
+    MString             _renderItemName;            //!< Unique name of the batch render item
+
+    //! Synchronization used to protect slots from concurrent updates
+    mutable std::mutex  _mutex;
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HD_VP2_BBOX_BATCH
@@ -30,9 +30,11 @@ Position buffer is held by HdVP2Mesh and shared among its render items.
 HdVP2DrawItem::HdVP2DrawItem(
     HdVP2RenderDelegate* delegate,
     const HdRprimSharedData* sharedData,
+    const TfToken& reprToken,
     const HdMeshReprDesc& desc)
 : HdDrawItem(sharedData)
 , _delegate(delegate)
+, _reprToken(reprToken)
 , _reprDesc(desc)
 {
     // In the case of instancing, the ID of a proto has an attribute at the end,
@@ -44,14 +46,7 @@ HdVP2DrawItem::HdVP2DrawItem(
     _renderItemName  = GetRprimID().GetText();
     _renderItemName += TfStringPrintf("/DrawItem_%p", this).c_str();
 
-    _renderItemData._indexBuffer.reset(
-        new MHWRender::MIndexBuffer(MHWRender::MGeometry::kUnsignedInt32));
-
-    if (desc.geomStyle == HdMeshGeomStyleHull) {
-        const MHWRender::MVertexBufferDescriptor desc("",
-            MHWRender::MGeometry::kNormal, MHWRender::MGeometry::kFloat, 3);
-        _renderItemData._normalsBuffer.reset(new MHWRender::MVertexBuffer(desc));
-    }
+    _CreateBuffers();
 }
 
 //! \brief  Destructor.
@@ -62,7 +57,46 @@ HdVP2DrawItem::~HdVP2DrawItem() {
         if(subSceneContainer) {
             subSceneContainer->remove(GetRenderItemName());
         }
+
+        if (_renderItemData._bboxBatchSlot != HdVP2BBoxBatch::kInvalidSlot) {
+            _delegate->GetBBoxBatch().ReleaseSlot(_renderItemData._bboxBatchSlot);
+        }
+
+        _delegate->GetResidencyManager().Remove(this);
+    }
+}
+
+//! \brief  Create the buffers owned by the draw item, filled on update.
+void HdVP2DrawItem::_CreateBuffers() {
+    _renderItemData._indexBuffer.reset(
+        new MHWRender::MIndexBuffer(MHWRender::MGeometry::kUnsignedInt32));
+
+    if (_reprDesc.geomStyle == HdMeshGeomStyleHull) {
+        const MHWRender::MVertexBufferDescriptor desc("",
+            MHWRender::MGeometry::kNormal, MHWRender::MGeometry::kFloat, 3);
+        _renderItemData._normalsBuffer.reset(new HdVP2VertexBufferRing(desc));
+    }
+}
+
+/*! \brief  Release the render item and the buffers of the draw item.
+
+    The draw item gets all dirty, so all its data are filled again once a new
+    render item is set. The slot in the bounding box batch is kept. Main
+    thread only, with no pending commit referencing the buffers.
+*/
+void HdVP2DrawItem::Evict(MSubSceneContainer& container) {
+    if (_renderItem) {
+        container.remove(GetRenderItemName());
+        _renderItem = nullptr;
     }
+
+    const size_t bboxBatchSlot = _renderItemData._bboxBatchSlot;
+    _renderItemData = RenderItemData();
+    _renderItemData._bboxBatchSlot = bboxBatchSlot;
+    _CreateBuffers();
+
+    _dirtyBits = HdChangeTracker::AllDirty;
+    _evicted = true;
 }
 
 //! \brief  Get access to render item data.
@@ -24,9 +24,14 @@
 #include "pxr/imaging/hd/mesh.h"
 #include "pxr/usd/usd/timeCode.h"
 
+#include "bboxBatch.h"
+#include "meshTopologyCache.h"
+#include "vertexBufferRing.h"
+
 #include <maya/MBoundingBox.h>
 #include <maya/MHWGeometry.h>
 #include <maya/MMatrix.h>
+#include <maya/MPxSubSceneOverride.h>
 #include <maya/MString.h>
 
 PXR_NAMESPACE_OPEN_SCOPE
@@ -50,12 +55,22 @@ public:
     struct RenderItemData {
         //! Render item color buffer - use when updating data
         std::unique_ptr<MHWRender::MVertexBuffer>   _colorBuffer;
-        //! Render item normals buffer - use when updating data
-        std::unique_ptr<MHWRender::MVertexBuffer>   _normalsBuffer;
+        //! Render item normals buffers - use when updating data
+        std::unique_ptr<HdVP2VertexBufferRing>      _normalsBuffer;
         //! Render item primvar buffers - use when updating data
         PrimvarBufferMap                            _primvarBuffers;
         //! Render item index buffer - use when updating data
         std::unique_ptr<MHWRender::MIndexBuffer>    _indexBuffer;
+        //! Index buffer shared with other Rprims of identical topology. If
+        //! valid, it is used instead of _indexBuffer. No ownership is held.
+        MHWRender::MIndexBuffer*                    _sharedIndexBuffer{ nullptr };
+        //! Topology data owning the shared index buffer
+        HdVP2MeshTopologyDataSharedPtr              _topologyData;
+        //! Positions buffer associated with the render item, to detect a
+        //! switch of vertex buffer ring. No ownership is held.
+        MHWRender::MVertexBuffer*                   _boundPositionsBuffer{ nullptr };
+        //! Normals buffer associated with the render item. No ownership is held.
+        MHWRender::MVertexBuffer*                   _boundNormalsBuffer{ nullptr };
         //! Bounding box of the render item.
         MBoundingBox                                _boundingBox;
         //! World matrix of the render item.
@@ -70,8 +85,14 @@ public:
         //! Number of instances currently allocated for render item
         unsigned int                                _instanceCount{ 0 };
 
+        //! Version of the Rprim instance transforms set on the render item
+        size_t                                      _instanceTransformsVersion{ 0 };
+
         //! Whether or not the render item is using GPU instanced draw.
         bool                                        _usingInstancedDraw{ false };
+
+        //! Slot of the Rprim in the bounding box batch of the render delegate
+        size_t                                      _bboxBatchSlot{ HdVP2BBoxBatch::kInvalidSlot };
     };
 
     //! Bit fields indicating what the render item is created for. A render item
@@ -79,11 +100,14 @@ public:
     enum RenderItemUsage
     {
         kRegular            = 1 << 0,  //!< Regular drawing (shaded, wireframe etc.)
-        kSelectionHighlight = 1 << 1   //!< Selection highlight.
+        kSelectionHighlight = 1 << 1,  //!< Selection highlight.
+        kLowDetail          = 1 << 2,  //!< Bounding box drawn in place of the hull for low level of detail.
+        kBBoxBatch          = 1 << 3   //!< Bounding box drawn by the batch of the render delegate, without own render item.
     };
 
 public:
-    HdVP2DrawItem(HdVP2RenderDelegate* delegate, const HdRprimSharedData* sharedData, const HdMeshReprDesc& desc);
+    HdVP2DrawItem(HdVP2RenderDelegate* delegate, const HdRprimSharedData* sharedData,
+        const TfToken& reprToken, const HdMeshReprDesc& desc);
 
     ~HdVP2DrawItem();
 
@@ -99,7 +123,11 @@ public:
 
     /*! \brief  Set pointer of the associated render item
     */
-    void SetRenderItem(MHWRender::MRenderItem* item) { _renderItem = item; }
+    void SetRenderItem(MHWRender::MRenderItem* item) { _renderItem = item; _evicted = false; }
+
+    /*! \brief  Get the repr for which the draw item was created.
+    */
+    const TfToken& GetReprToken() const { return _reprToken; }
 
     /*! \brief  Get the repr desc for which the draw item was created.
     */
@@ -139,9 +167,18 @@ public:
         return _dirtyBits;
     }
 
+    void Evict(MSubSceneContainer& container);
+
+    /*! \brief  Has the draw item been evicted since its render item was set?
+    */
+    bool IsEvicted() const { return _evicted; }
+
 private:
+    void _CreateBuffers();
+
 
     HdVP2RenderDelegate*    _delegate{ nullptr };   //!< VP2 render delegate for which this draw item was created
+    const TfToken           _reprToken;             //!< The repr for which the draw item was created.
     const HdMeshReprDesc    _reprDesc;              //!< The repr desc for which the draw item was created.
     MString                 _renderItemName;        //!< Unique name for easier debugging and profiling.
     MHWRender::MRenderItem* _renderItem{ nullptr }; //!< Pointer of the render item for fast access. No ownership is held.
@@ -149,6 +186,7 @@ private:
 
     uint32_t                _renderItemUsage{ kRegular };            //!< What is the render item created for
     HdDirtyBits             _dirtyBits{ HdChangeTracker::AllDirty }; //!< Dirty bits to control data update of render item
+    bool                    _evicted{ false };                       //!< Whether the render item and buffers have been released
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
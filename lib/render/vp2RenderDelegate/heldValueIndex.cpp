@@ -0,0 +1,321 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "heldValueIndex.h"
+#include "attributePrefetcher.h"
+#include "render_delegate.h"
+
+#include "pxr/imaging/hd/changeTracker.h"
+#include "pxr/imaging/hd/renderIndex.h"
+#include "pxr/imaging/hd/rprim.h"
+#include "pxr/usd/usd/interpolation.h"
+#include "pxr/usd/usdGeom/mesh.h"
+#include "pxr/usd/usdGeom/primvarsAPI.h"
+#include "pxr/usd/usdGeom/tokens.h"
+#include "pxr/usdImaging/usdImaging/delegate.h"
+
+#include <maya/MProfiler.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+    //! Number of Rprims checked by each parallel task
+    constexpr size_t kHeldValueGrainSize = 64;
+
+    //! Dirty bits of the indexed attributes
+    constexpr HdDirtyBits kIndexedBits =
+        HdChangeTracker::DirtyPoints |
+        HdChangeTracker::DirtyNormals |
+        HdChangeTracker::DirtyExtent;
+
+} // namespace
+
+/*! \brief  Whether the attribute holds its value between two times.
+
+    Samples between the two times are compared in pairs, including the
+    samples bracketing the times when values are linearly interpolated.
+    The result of each comparison is kept for the next time changes.
+*/
+bool HdVP2HeldValueIndex::Attribute::IsHeld(
+    double time0, double time1, bool heldInterpolation)
+{
+    if (time0 > time1) {
+        std::swap(time0, time1);
+    }
+
+    const size_t numSamples = _times.size();
+    if (numSamples < 2) {
+        return true;
+    }
+
+    // Last sample at or before time0, or the first sample.
+    const size_t upper0 = std::upper_bound(_times.begin(), _times.end(), time0) - _times.begin();
+    const size_t first = upper0 > 0 ? upper0 - 1 : 0;
+
+    // Last sample at or before time1 with held interpolation, first sample
+    // at or after time1 with linear interpolation.
+    size_t last = 0;
+    if (heldInterpolation) {
+        const size_t upper1 = std::upper_bound(_times.begin(), _times.end(), time1) - _times.begin();
+        last = upper1 > 0 ? upper1 - 1 : 0;
+    }
+    else {
+        const size_t lower1 = std::lower_bound(_times.begin(), _times.end(), time1) - _times.begin();
+        last = std::min(lower1, numSamples - 1);
+    }
+
+    VtValue value;
+    for (size_t i = first; i < last; i++) {
+        if (_equal[i] < 0) {
+            if (value.IsEmpty()) {
+                _query.Get(&value, _times[i]);
+            }
+
+            VtValue nextValue;
+            _query.Get(&nextValue, _times[i + 1]);
+            _equal[i] = (value == nextValue) ? 1 : 0;
+
+            value.Swap(nextValue);
+        }
+        else {
+            value = VtValue();
+        }
+
+        if (_equal[i] == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*! \brief  Constructor
+*/
+HdVP2HeldValueIndex::HdVP2HeldValueIndex()
+{
+    _stageListener.SetStageObjectsChangedCallback(
+        [this](const UsdNotice::ObjectsChanged& notice) {
+            _OnObjectsChanged(notice);
+        });
+}
+
+/*! \brief  Destructor
+*/
+HdVP2HeldValueIndex::~HdVP2HeldValueIndex() = default;
+
+/*! \brief  Set the stage of the indexed prims, releasing all entries.
+*/
+void HdVP2HeldValueIndex::SetStage(const UsdStageRefPtr& stage)
+{
+    if (_stage == stage) {
+        return;
+    }
+
+    _stage = stage;
+    _stageListener.SetStage(stage);
+    _entries.clear();
+}
+
+/*! \brief  Set the time of the scene delegate, then clear dirty bits of
+            attributes holding their value since the previous time.
+
+    Pending scene changes are applied before the time change, so dirty bits
+    set by a time change are told apart from edits.
+
+    \return Number of Rprims whose dirty bits were cleared
+*/
+size_t HdVP2HeldValueIndex::SetTime(
+    HdRenderIndex& renderIndex,
+    UsdImagingDelegate& sceneDelegate,
+    UsdTimeCode time)
+{
+    const UsdTimeCode previousTime = sceneDelegate.GetTime();
+    if (!_stage || time == previousTime || time.IsDefault() || previousTime.IsDefault()) {
+        sceneDelegate.SetTime(time);
+        return 0;
+    }
+
+    sceneDelegate.ApplyPendingUpdates();
+
+    HdChangeTracker& changeTracker = renderIndex.GetChangeTracker();
+    const unsigned int rprimIndexVersion = changeTracker.GetRprimIndexVersion();
+
+    {
+        const SdfPathVector& rprimIds = renderIndex.GetRprimIds();
+        _previousBits.resize(rprimIds.size());
+        for (size_t i = 0; i < rprimIds.size(); i++) {
+            _previousBits[i] = changeTracker.GetRprimDirtyBits(rprimIds[i]);
+        }
+    }
+
+    sceneDelegate.SetTime(time);
+
+    if (changeTracker.GetRprimIndexVersion() != rprimIndexVersion) {
+        return 0;
+    }
+
+    MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
+        MProfiler::kColorC_L1, "FilterHeldValues");
+
+    //! An Rprim dirtied by the time change. Map entries are inserted before
+    //! the parallel checks, which only fill them.
+    struct Item {
+        const SdfPath*  _id;
+        const SdfPath*  _primPath;
+        HdDirtyBits     _addedBits;
+        HdDirtyBits     _heldBits;
+        Entry*          _entry;
+    };
+    std::vector<Item> items;
+
+    const SdfPathVector& rprimIds = renderIndex.GetRprimIds();
+    for (size_t i = 0; i < rprimIds.size(); i++) {
+        const SdfPath& id = rprimIds[i];
+
+        const HdDirtyBits addedBits = kIndexedBits &
+            changeTracker.GetRprimDirtyBits(id) & ~_previousBits[i];
+        if (!addedBits) {
+            continue;
+        }
+
+        const HdRprim* rprim = renderIndex.GetRprim(id);
+        if (!rprim || !rprim->GetInstancerId().IsEmpty()) {
+            continue;
+        }
+
+        auto it = _entries.emplace(
+            sceneDelegate.ConvertIndexPathToCachePath(id), Entry()).first;
+
+        items.push_back({ &id, &it->first, addedBits, 0, &it->second });
+    }
+
+    const bool heldInterpolation =
+        (_stage->GetInterpolationType() == UsdInterpolationTypeHeld);
+    const double time0 = previousTime.GetValue();
+    const double time1 = time.GetValue();
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, items.size(), kHeldValueGrainSize),
+        [this, &items, heldInterpolation, time0, time1](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); i++) {
+                Item& item = items[i];
+                Entry& entry = *item._entry;
+
+                if (!entry._valid) {
+                    _CreateEntry(_stage->GetPrimAtPath(*item._primPath), entry);
+                }
+
+                // A bit is cleared when all attributes setting it are held.
+                HdDirtyBits heldBits = 0;
+                HdDirtyBits changedBits = 0;
+                for (Attribute& attribute : entry._attributes) {
+                    if (!(attribute._dirtyBits & item._addedBits)) {
+                        continue;
+                    }
+
+                    if (attribute.IsHeld(time0, time1, heldInterpolation)) {
+                        heldBits |= attribute._dirtyBits;
+                    }
+                    else {
+                        changedBits |= attribute._dirtyBits;
+                    }
+                }
+
+                item._heldBits = item._addedBits & heldBits & ~changedBits;
+            }
+        }
+    );
+
+    size_t numHeldRprims = 0;
+    for (const Item& item : items) {
+        if (item._heldBits) {
+            changeTracker.MarkRprimClean(*item._id,
+                changeTracker.GetRprimDirtyBits(*item._id) & ~item._heldBits);
+            numHeldRprims++;
+        }
+    }
+
+    return numHeldRprims;
+}
+
+/*! \brief  Index time samples of the points, normals and extent of a mesh.
+
+    Skinned meshes are skipped since their points are computed by the scene
+    delegate.
+*/
+void HdVP2HeldValueIndex::_CreateEntry(const UsdPrim& prim, Entry& entry)
+{
+    entry._valid = true;
+
+    if (!prim.IsA<UsdGeomMesh>() || HdVP2AttributePrefetcher::IsSkinned(prim)) {
+        return;
+    }
+
+    const auto addAttribute = [&entry](const UsdAttribute& attr, HdDirtyBits dirtyBits) {
+        if (!attr || !attr.ValueMightBeTimeVarying()) {
+            return;
+        }
+
+        Attribute attribute;
+        attribute._query = UsdAttributeQuery(attr);
+        attribute._dirtyBits = dirtyBits;
+        attribute._query.GetTimeSamples(&attribute._times);
+        attribute._equal.assign(
+            attribute._times.empty() ? 0 : attribute._times.size() - 1, -1);
+
+        entry._attributes.push_back(std::move(attribute));
+    };
+
+    const UsdGeomMesh mesh(prim);
+    addAttribute(mesh.GetPointsAttr(), HdChangeTracker::DirtyPoints);
+    addAttribute(mesh.GetNormalsAttr(), HdChangeTracker::DirtyNormals);
+    addAttribute(mesh.GetExtentAttr(), HdChangeTracker::DirtyExtent);
+
+    const UsdGeomPrimvar normals =
+        UsdGeomPrimvarsAPI(prim).GetPrimvar(UsdGeomTokens->normals);
+    if (normals) {
+        addAttribute(normals.GetAttr(), HdChangeTracker::DirtyNormals);
+        addAttribute(normals.GetIndicesAttr(), HdChangeTracker::DirtyNormals);
+    }
+}
+
+/*! \brief  Release entries of changed prims.
+*/
+void HdVP2HeldValueIndex::_OnObjectsChanged(const UsdNotice::ObjectsChanged& notice)
+{
+    for (const SdfPath& path : notice.GetResyncedPaths()) {
+        for (auto it = _entries.begin(); it != _entries.end(); ) {
+            if (it->first.HasPrefix(path)) {
+                it = _entries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    for (const SdfPath& path : notice.GetChangedInfoOnlyPaths()) {
+        _entries.erase(path.GetPrimPath());
+    }
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,102 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HD_VP2_HELD_VALUE_INDEX
+#define HD_VP2_HELD_VALUE_INDEX
+
+#include "pxr/pxr.h"
+#include "pxr/imaging/hd/types.h"
+#include "pxr/usd/sdf/path.h"
+#include "pxr/usd/usd/attributeQuery.h"
+#include "pxr/usd/usd/notice.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usd/timeCode.h"
+
+#include "../../listeners/stageNoticeListener.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+class HdRenderIndex;
+class UsdImagingDelegate;
+
+/*! \brief  Index of the intervals over which time-varying attributes of
+            Rprims hold their value.
+    \class  HdVP2HeldValueIndex
+
+    A time change of the scene delegate dirties every Rprim with any
+    time-varying attribute, even when its time samples are identical around
+    both times, which is common in animation caches holding still. The index
+    keeps the time samples of the points, normals and extent of meshes, and
+    whether consecutive samples are equal, compared once when first crossed.
+    Dirty bits of attributes holding their value between the previous and
+    the new time are cleared right after the time change, so these Rprims
+    are neither synchronized nor uploaded for them.
+
+    Only non-instanced, non-skinned meshes are indexed. Transform, visibility
+    and primvars other than normals may come from ancestors and are always
+    left dirty. Entries of a prim are released when it changes in the stage.
+
+    Main thread only.
+*/
+class HdVP2HeldValueIndex final
+{
+public:
+    HdVP2HeldValueIndex();
+    ~HdVP2HeldValueIndex();
+
+    void SetStage(const UsdStageRefPtr& stage);
+
+    size_t SetTime(HdRenderIndex& renderIndex,
+        UsdImagingDelegate& sceneDelegate, UsdTimeCode time);
+
+private:
+    HdVP2HeldValueIndex(const HdVP2HeldValueIndex&) = delete;
+    HdVP2HeldValueIndex& operator=(const HdVP2HeldValueIndex&) = delete;
+
+    void _OnObjectsChanged(const UsdNotice::ObjectsChanged& notice);
+
+    //! Time samples of a time-varying attribute.
+    struct Attribute {
+        UsdAttributeQuery       _query;     //!< Query of the attribute
+        HdDirtyBits             _dirtyBits; //!< Dirty bits set when the value changes
+        std::vector<double>     _times;     //!< Times of the samples
+        std::vector<int8_t>     _equal;     //!< Whether each sample equals the next one, -1 until compared
+
+        bool IsHeld(double time0, double time1, bool heldInterpolation);
+    };
+
+    //! Indexed attributes of a prim.
+    struct Entry {
+        std::vector<Attribute>  _attributes;        //!< Time-varying attributes
+        bool                    _valid{ false };    //!< Whether the attributes have been indexed
+    };
+
+    static void _CreateEntry(const UsdPrim& prim, Entry& entry);
+
+    using EntryMap = std::unordered_map<SdfPath, Entry, SdfPath::Hash>;
+
+    UsdStageRefPtr              _stage;             //!< Stage of the indexed prims
+    UsdMayaStageNoticeListener  _stageListener;     //!< Listener invalidating entries of changed prims
+    EntryMap                    _entries;           //!< Entries indexed by prim path
+    std::vector<HdDirtyBits>    _previousBits;      //!< Dirty bits of all Rprims before the time change
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HD_VP2_HELD_VALUE_INDEX
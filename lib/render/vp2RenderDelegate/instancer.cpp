@@ -24,11 +24,16 @@
 
 #include "pxr/base/gf/vec3f.h"
 #include "pxr/base/gf/vec4f.h"
+#include "pxr/base/gf/matrix3d.h"
 #include "pxr/base/gf/matrix4d.h"
-#include "pxr/base/gf/rotation.h"
-#include "pxr/base/gf/quaternion.h"
+#include "pxr/base/gf/quatd.h"
 #include "pxr/base/tf/staticTokens.h"
 
+#include <cstring>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
 // Define local tokens for the names of the primvars the instancer
@@ -42,6 +47,134 @@ TF_DEFINE_PRIVATE_TOKENS(
     (translate)
 );
 
+namespace {
+
+    //! Number of instances below which transforms are computed serially
+    constexpr size_t kParallelThreshold = 1024;
+
+    //! Number of instances computed by one task
+    constexpr size_t kParallelGrainSize = 256;
+
+    //! Helper utility function to run body(begin, end) over [0, count),
+    //! in parallel when count is large enough to amortize the tasks.
+    template <typename BODY>
+    void _ParallelFor(size_t count, const BODY& body)
+    {
+        if (count < kParallelThreshold) {
+            body(size_t(0), count);
+        }
+        else {
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, count, kParallelGrainSize),
+                [&body](const tbb::blocked_range<size_t>& range) {
+                    body(range.begin(), range.end());
+                });
+        }
+    }
+
+    //! Helper utility function to get typed data of a primvar buffer, or null
+    //! if the primvar is missing or has another type.
+    template <typename T>
+    const T* _GetPrimvarData(
+        const TfHashMap<TfToken, HdVtBufferSource*, TfToken::HashFunctor>& primvarMap,
+        const TfToken& name,
+        size_t& numElements)
+    {
+        numElements = 0;
+
+        auto it = primvarMap.find(name);
+        if (it == primvarMap.end() ||
+            it->second->GetTupleType() != HdVP2TypeHelper::GetTupleType<T>()) {
+            return nullptr;
+        }
+
+        numElements = it->second->GetNumElements();
+        return static_cast<const T*>(it->second->GetData());
+    }
+
+    /*! \brief  Instance primvars as separate arrays of translations, rotations,
+                scales and matrices, each of which can be missing.
+
+        Transform of an instance is computed in a single pass by building the
+        scaled rotation rows directly, rather than multiplying four matrices.
+    */
+    struct _InstancePrimvars {
+        const GfVec3f*    _translate{ nullptr };
+        const GfVec4f*    _rotate{ nullptr };
+        const GfVec3f*    _scale{ nullptr };
+        const GfMatrix4d* _instanceTransform{ nullptr };
+
+        size_t _numTranslate{ 0 };
+        size_t _numRotate{ 0 };
+        size_t _numScale{ 0 };
+        size_t _numInstanceTransform{ 0 };
+
+        //! Compute instanceTransform * scale * rotate * translate * instancerTransform
+        GfMatrix4d Compute(int index, const GfMatrix4d& instancerTransform) const
+        {
+            const size_t i = static_cast<size_t>(index);
+
+            // "rotate" holds a quaternion in <real, i, j, k> format.
+            GfMatrix3d rotate(1.0);
+            if (i < _numRotate) {
+                const GfVec4f& q = _rotate[i];
+                rotate.SetRotate(GfQuatd(q[0], q[1], q[2], q[3]).GetNormalized());
+            }
+
+            // "scale" holds an axis-aligned scale vector.
+            const GfVec3f scale = (i < _numScale) ? _scale[i] : GfVec3f(1.0f);
+
+            // "translate" holds a translation vector.
+            const GfVec3f translate = (i < _numTranslate) ? _translate[i] : GfVec3f(0.0f);
+
+            GfMatrix4d result;
+            double* m = result.data();
+            for (int r = 0; r < 3; ++r) {
+                m[r * 4 + 0] = scale[r] * rotate[r][0];
+                m[r * 4 + 1] = scale[r] * rotate[r][1];
+                m[r * 4 + 2] = scale[r] * rotate[r][2];
+                m[r * 4 + 3] = 0.0;
+            }
+            m[12] = translate[0];
+            m[13] = translate[1];
+            m[14] = translate[2];
+            m[15] = 1.0;
+
+            result *= instancerTransform;
+
+            // "instanceTransform" holds a 4x4 transform matrix.
+            if (i < _numInstanceTransform) {
+                result = _instanceTransform[i] * result;
+            }
+
+            return result;
+        }
+    };
+
+    //! Helper utility function to get instance primvars of known names.
+    _InstancePrimvars _GetInstancePrimvars(
+        const TfHashMap<TfToken, HdVtBufferSource*, TfToken::HashFunctor>& primvarMap)
+    {
+        _InstancePrimvars primvars;
+        primvars._translate = _GetPrimvarData<GfVec3f>(
+            primvarMap, _tokens->translate, primvars._numTranslate);
+        primvars._rotate = _GetPrimvarData<GfVec4f>(
+            primvarMap, _tokens->rotate, primvars._numRotate);
+        primvars._scale = _GetPrimvarData<GfVec3f>(
+            primvarMap, _tokens->scale, primvars._numScale);
+        primvars._instanceTransform = _GetPrimvarData<GfMatrix4d>(
+            primvarMap, _tokens->instanceTransform, primvars._numInstanceTransform);
+        return primvars;
+    }
+
+    //! Helper utility function to copy a GfMatrix4d into a MMatrix.
+    void _CopyMatrix(const GfMatrix4d& src, MMatrix& dst)
+    {
+        memcpy(dst.matrix, src.GetArray(), sizeof(double) * 16);
+    }
+
+} // namespace
+
 /*! \brief  Constructor.
 
     \param delegate     The scene delegate backing this instancer's data.
@@ -67,59 +200,114 @@ HdVP2Instancer::~HdVP2Instancer()
 }
 
  
-/*! \brief  Checks the change tracker to determine whether instance primvars are
-            dirty, and if so pulls them. 
-            
-    Since primvars can only be pulled once, and are cached, this function is not 
-    re-entrant. However, this function is called by ComputeInstanceTransforms, 
+/*! \brief  Checks the change tracker to determine whether instance primvars or
+            the instancer transform are dirty, and if so pulls them.
+
+    Since primvars can only be pulled once, and are cached, this function is not
+    re-entrant. However, this function is called by ComputeInstanceTransforms,
     which is called by HdVP2Mesh::Sync(), which is dispatched in parallel, so it needs
-    to be guarded by _instanceLock.
+    to be guarded by _instanceLock. Each pull bumps the transforms version.
 */
 void HdVP2Instancer::_SyncPrimvars()
 {
     HD_TRACE_FUNCTION();
     HF_MALLOC_TAG_FUNCTION();
 
-    HdChangeTracker &changeTracker = 
+    HdChangeTracker &changeTracker =
         GetDelegate()->GetRenderIndex().GetChangeTracker();
     SdfPath const& id = GetId();
 
-    // Use the double-checked locking pattern to check if this instancer's
-    // primvars are dirty.
+    // Use the double-checked locking pattern to check if this instancer is
+    // dirty.
     int dirtyBits = changeTracker.GetInstancerDirtyBits(id);
-    if (HdChangeTracker::IsAnyPrimvarDirty(dirtyBits, id)) {
+    if (dirtyBits != HdChangeTracker::Clean) {
         std::lock_guard<std::mutex> lock(_instanceLock);
 
         // If not dirty, then another thread did the job
         dirtyBits = changeTracker.GetInstancerDirtyBits(id);
-        if (HdChangeTracker::IsAnyPrimvarDirty(dirtyBits, id)) {
+        if (dirtyBits != HdChangeTracker::Clean) {
 
             // If this instancer has dirty primvars, get the list of
             // primvar names and then cache each one.
-
-            TfTokenVector primvarNames;
-            HdPrimvarDescriptorVector primvars = GetDelegate()
-                ->GetPrimvarDescriptors(id, HdInterpolationInstance);
-
-            for (HdPrimvarDescriptor const& pv: primvars) {
-                if (HdChangeTracker::IsPrimvarDirty(dirtyBits, id, pv.name)) {
-                    VtValue value = GetDelegate()->Get(id, pv.name);
-                    if (!value.IsEmpty()) {
-                        if (_primvarMap.count(pv.name) > 0) {
-                            delete _primvarMap[pv.name];
+            if (HdChangeTracker::IsAnyPrimvarDirty(dirtyBits, id)) {
+                HdPrimvarDescriptorVector primvars = GetDelegate()
+                    ->GetPrimvarDescriptors(id, HdInterpolationInstance);
+
+                for (HdPrimvarDescriptor const& pv: primvars) {
+                    if (HdChangeTracker::IsPrimvarDirty(dirtyBits, id, pv.name)) {
+                        VtValue value = GetDelegate()->Get(id, pv.name);
+                        if (!value.IsEmpty()) {
+                            if (_primvarMap.count(pv.name) > 0) {
+                                delete _primvarMap[pv.name];
+                            }
+                            _primvarMap[pv.name] =
+                                new HdVtBufferSource(pv.name, value);
                         }
-                        _primvarMap[pv.name] =
-                            new HdVtBufferSource(pv.name, value);
                     }
                 }
             }
 
+            // The instancer transform doesn't have its own dirty bit, it is
+            // pulled along with any other change of the instancer.
+            _instancerTransform = GetDelegate()->GetInstancerTransform(id);
+
+            ++_version;
+
             // Mark the instancer as clean
             changeTracker.MarkInstancerClean(id);
         }
     }
 }
 
+/*! \brief  Return the version of instance transforms of this instancer.
+
+    The version changes whenever instance primvars or the instancer transform
+    of this instancer or any of its parents are pulled. Prototypes compare it
+    with the version of their last computation to skip unchanged transforms.
+*/
+size_t HdVP2Instancer::GetTransformsVersion()
+{
+    _SyncPrimvars();
+
+    size_t version = _version;
+
+    if (!GetParentId().IsEmpty()) {
+        HdInstancer *parentInstancer =
+            GetDelegate()->GetRenderIndex().GetInstancer(GetParentId());
+        if (TF_VERIFY(parentInstancer)) {
+            version += static_cast<HdVP2Instancer*>(parentInstancer)->
+                GetTransformsVersion();
+        }
+    }
+
+    return version;
+}
+
+/*! \brief  Computes transforms of this level of instancer for the given indices.
+
+    Instances are independent from each other, so they are computed in
+    parallel with a single fused kernel.
+*/
+VtMatrix4dArray HdVP2Instancer::_ComputeLocalTransforms(
+    VtIntArray const &instanceIndices) const
+{
+    const _InstancePrimvars primvars = _GetInstancePrimvars(_primvarMap);
+    const GfMatrix4d& instancerTransform = _instancerTransform;
+    const int* indices = instanceIndices.cdata();
+
+    VtMatrix4dArray transforms(instanceIndices.size());
+    GfMatrix4d* dst = transforms.data();
+
+    _ParallelFor(instanceIndices.size(),
+        [&primvars, &instancerTransform, indices, dst](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                dst[i] = primvars.Compute(indices[i], instancerTransform);
+            }
+        });
+
+    return transforms;
+}
+
 /*! \brief  Computes all instance transforms for the provided prototype id.
 
     Taking into account the scene delegate's instancerTransform and the
@@ -127,7 +315,7 @@ void HdVP2Instancer::_SyncPrimvars()
     Computes and flattens nested transforms, if necessary.
 
     \param prototypeId The prototype to compute transforms for.
-        
+
     \return One transform per instance, to apply when drawing.
 */
 VtMatrix4dArray HdVP2Instancer::ComputeInstanceTransforms(SdfPath const &prototypeId)
@@ -139,71 +327,14 @@ VtMatrix4dArray HdVP2Instancer::ComputeInstanceTransforms(SdfPath const &prototy
 
     // The transforms for this level of instancer are computed by:
     // foreach(index : indices) {
-    //     instancerTransform * translate(index) * rotate(index) *
-    //     scale(index) * instanceTransform(index)
+    //     instanceTransform(index) * scale(index) * rotate(index) *
+    //     translate(index) * instancerTransform
     // }
     // If any transform isn't provided, it's assumed to be the identity.
-
-    GfMatrix4d instancerTransform =
-        GetDelegate()->GetInstancerTransform(GetId());
     VtIntArray instanceIndices =
         GetDelegate()->GetInstanceIndices(GetId(), prototypeId);
 
-    VtMatrix4dArray transforms(instanceIndices.size());
-    for (size_t i = 0; i < instanceIndices.size(); ++i) {
-        transforms[i] = instancerTransform;
-    }
-
-    // "translate" holds a translation vector for each index.
-    if (_primvarMap.count(_tokens->translate) > 0) {
-        HdVP2BufferSampler sampler(*_primvarMap[_tokens->translate]);
-        for (size_t i = 0; i < instanceIndices.size(); ++i) {
-            GfVec3f translate;
-            if (sampler.Sample(instanceIndices[i], &translate)) {
-                GfMatrix4d translateMat(1);
-                translateMat.SetTranslate(GfVec3d(translate));
-                transforms[i] = translateMat * transforms[i];
-            }
-        }
-    }
-
-    // "rotate" holds a quaternion in <real, i, j, k> format for each index.
-    if (_primvarMap.count(_tokens->rotate) > 0) {
-        HdVP2BufferSampler sampler(*_primvarMap[_tokens->rotate]);
-        for (size_t i = 0; i < instanceIndices.size(); ++i) {
-            GfVec4f quat;
-            if (sampler.Sample(instanceIndices[i], &quat)) {
-                GfMatrix4d rotateMat(1);
-                rotateMat.SetRotate(GfRotation(GfQuaternion(
-                    quat[0], GfVec3d(quat[1], quat[2], quat[3]))));
-                transforms[i] = rotateMat * transforms[i];
-            }
-        }
-    }
-
-    // "scale" holds an axis-aligned scale vector for each index.
-    if (_primvarMap.count(_tokens->scale) > 0) {
-        HdVP2BufferSampler sampler(*_primvarMap[_tokens->scale]);
-        for (size_t i = 0; i < instanceIndices.size(); ++i) {
-            GfVec3f scale;
-            if (sampler.Sample(instanceIndices[i], &scale)) {
-                GfMatrix4d scaleMat(1);
-                scaleMat.SetScale(GfVec3d(scale));
-                transforms[i] = scaleMat * transforms[i];
-            }
-        }
-    }
-
-    // "instanceTransform" holds a 4x4 transform matrix for each index.
-    if (_primvarMap.count(_tokens->instanceTransform) > 0) {
-        HdVP2BufferSampler sampler(*_primvarMap[_tokens->instanceTransform]);
-        for (size_t i = 0; i < instanceIndices.size(); ++i) {
-            GfMatrix4d instanceTransform;
-            if (sampler.Sample(instanceIndices[i], &instanceTransform)) {
-                transforms[i] = instanceTransform * transforms[i];
-            }
-        }
-    }
+    VtMatrix4dArray transforms = _ComputeLocalTransforms(instanceIndices);
 
     if (GetParentId().IsEmpty()) {
         return transforms;
@@ -224,15 +355,73 @@ VtMatrix4dArray HdVP2Instancer::ComputeInstanceTransforms(SdfPath const &prototy
         static_cast<HdVP2Instancer*>(parentInstancer)->
             ComputeInstanceTransforms(GetId());
 
-    VtMatrix4dArray final(parentTransforms.size() * transforms.size());
-    for (size_t i = 0; i < parentTransforms.size(); ++i) {
-        for (size_t j = 0; j < transforms.size(); ++j) {
-            final[i * transforms.size() + j] = transforms[j] *
-                                               parentTransforms[i];
+    const size_t numLocal = transforms.size();
+    const GfMatrix4d* local = transforms.cdata();
+    const GfMatrix4d* parent = parentTransforms.cdata();
+
+    VtMatrix4dArray final(parentTransforms.size() * numLocal);
+    GfMatrix4d* dst = final.data();
+
+    _ParallelFor(final.size(), [numLocal, local, parent, dst](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            dst[k] = local[k % numLocal] * parent[k / numLocal];
         }
-    }
+    });
+
     return final;
 }
 
-PXR_NAMESPACE_CLOSE_SCOPE
+/*! \brief  Computes all instance transforms for the provided prototype id,
+            premultiplied by the prototype's world matrix.
+
+    Same as ComputeInstanceTransforms(), except the result is written straight
+    into the array VP2 consumes. Without nesting, instance and world matrices
+    are composed by the same parallel pass.
+
+    \param prototypeId The prototype to compute transforms for.
+    \param worldMatrix World matrix of the prototype.
+    \param transforms  Receives one transform per instance.
+*/
+void HdVP2Instancer::ComputeInstanceTransforms(SdfPath const &prototypeId,
+    GfMatrix4d const &worldMatrix, MMatrixArray &transforms)
+{
+    HD_TRACE_FUNCTION();
+    HF_MALLOC_TAG_FUNCTION();
+
+    MMatrixArray* dst = &transforms;
+
+    if (GetParentId().IsEmpty()) {
+        _SyncPrimvars();
 
+        const VtIntArray instanceIndices =
+            GetDelegate()->GetInstanceIndices(GetId(), prototypeId);
+        const int* indices = instanceIndices.cdata();
+
+        const _InstancePrimvars primvars = _GetInstancePrimvars(_primvarMap);
+        const GfMatrix4d& instancerTransform = _instancerTransform;
+
+        transforms.setLength(static_cast<unsigned int>(instanceIndices.size()));
+
+        _ParallelFor(instanceIndices.size(),
+            [&primvars, &instancerTransform, &worldMatrix, indices, dst](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    _CopyMatrix(worldMatrix * primvars.Compute(indices[i], instancerTransform),
+                        (*dst)[static_cast<unsigned int>(i)]);
+                }
+            });
+        return;
+    }
+
+    const VtMatrix4dArray instanceTransforms = ComputeInstanceTransforms(prototypeId);
+    const GfMatrix4d* src = instanceTransforms.cdata();
+
+    transforms.setLength(static_cast<unsigned int>(instanceTransforms.size()));
+
+    _ParallelFor(instanceTransforms.size(), [&worldMatrix, src, dst](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            _CopyMatrix(worldMatrix * src[i], (*dst)[static_cast<unsigned int>(i)]);
+        }
+    });
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -23,9 +23,13 @@
 #include "pxr/imaging/hd/instancer.h"
 #include "pxr/imaging/hd/vtBufferSource.h"
 
+#include "pxr/base/gf/matrix4d.h"
 #include "pxr/base/tf/hashmap.h"
 #include "pxr/base/tf/token.h"
 
+#include <maya/MMatrixArray.h>
+
+#include <atomic>
 #include <mutex>
 
 PXR_NAMESPACE_OPEN_SCOPE
@@ -36,6 +40,10 @@ PXR_NAMESPACE_OPEN_SCOPE
     Nested instancing can be handled by recursion, and by taking the
     cartesian product of the transform arrays at each nesting level, to
     create a flattened transform array.
+
+    Instance primvars and the instancer transform are pulled only when the
+    change tracker reports them dirty, which bumps a version that prototypes
+    compare to skip recomputing unchanged instance transforms.
 */
 class HdVP2Instancer final : public HdInstancer 
 {
@@ -47,12 +55,26 @@ public:
 
     VtMatrix4dArray ComputeInstanceTransforms(SdfPath const &prototypeId);
 
+    void ComputeInstanceTransforms(SdfPath const &prototypeId,
+        GfMatrix4d const &worldMatrix, MMatrixArray &transforms);
+
+    size_t GetTransformsVersion();
+
 private:
     void _SyncPrimvars();
 
+    VtMatrix4dArray _ComputeLocalTransforms(VtIntArray const &instanceIndices) const;
+
     //! Mutex guard for _SyncPrimvars().
     std::mutex _instanceLock;
 
+    //! Instancer transform, pulled when dirty.
+    GfMatrix4d _instancerTransform{ 1.0 };
+
+    //! Version of instance primvars and instancer transform, bumped when any
+    //! of them gets pulled.
+    std::atomic<size_t> _version{ 1 };
+
     /*! Map of the latest primvar data for this instancer, keyed by
         primvar name. Primvar values are VtValue, an any-type; they are
         interpreted at consumption time (here, in ComputeInstanceTransforms).
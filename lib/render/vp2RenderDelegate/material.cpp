@@ -18,7 +18,6 @@
 #include "material.h"
 #include "render_delegate.h"
 
-#include "pxr/imaging/glf/image.h"
 #include "pxr/imaging/hd/sceneDelegate.h"
 #include "pxr/usd/ar/packageUtils.h"
 #include "pxr/usd/sdf/assetPath.h"
@@ -31,6 +30,7 @@
 #include "pxr/base/gf/matrix4d.h"
 #include "pxr/base/gf/matrix4f.h"
 #include "pxr/base/tf/diagnostic.h"
+#include "pxr/base/tf/stringUtils.h"
 
 #include <maya/MProfiler.h>
 #include <maya/MStatus.h>
@@ -44,6 +44,7 @@
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -257,111 +258,183 @@ MHWRender::MSamplerStateDesc _GetSamplerStateDesc(const HdMaterialNode& node)
     return desc;
 }
 
-//! Load texture from the specified path
-MHWRender::MTexture* _LoadTexture(
-    const std::string& path,
-    bool& isColorSpaceSRGB)
+//! Get the key describing the topology of a material network, i.e. what
+//! determines the fragment graph of its shader instance.
+std::string _GetTopologyKey(const HdMaterialNetwork& mat)
 {
-    isColorSpaceSRGB = false;
+    std::string key;
 
-    MHWRender::MRenderer* const renderer = MHWRender::MRenderer::theRenderer();
-    MHWRender::MTextureManager* const textureMgr =
-        renderer ? renderer->getTextureManager() : nullptr;
-    if (!TF_VERIFY(textureMgr)) {
-        return nullptr;
+    for (const HdMaterialNode& node : mat.nodes) {
+        key += node.identifier.GetString();
+        key += ':';
+        key += node.path.GetName();
+
+        // Primvar names are baked into the fragment graph.
+        if (_IsUsdPrimvarReader(node)) {
+            auto it = node.parameters.find(_tokens->varname);
+            if (it != node.parameters.end()) {
+                key += '(';
+                key += TfStringify(it->second);
+                key += ')';
+            }
+        }
+
+        key += ';';
     }
 
-    GlfImageSharedPtr image = GlfImage::OpenForReading(path);
-    if (!TF_VERIFY(image)) {
-        return nullptr;
+    for (const HdMaterialRelationship& rel : mat.relationships) {
+        key += rel.inputId.GetName();
+        key += '.';
+        key += rel.inputName.GetString();
+        key += '>';
+        key += rel.outputId.GetName();
+        key += '.';
+        key += rel.outputName.GetString();
+        key += ';';
     }
 
-    // GlfImage is used for loading pixel data from usdz only and should
-    // not trigger any OpenGL call. VP2RenderDelegate will transfer the
-    // texels to GPU memory with VP2 API which is 3D API agnostic.
-    GlfImage::StorageSpec spec;
-    spec.width = image->GetWidth();
-    spec.height = image->GetHeight();
-    spec.depth = 1;
-    spec.format = image->GetFormat();
-    spec.type = image->GetType();
-    spec.flipped = false;
+    return key;
+}
+
+//! Get the key describing parameter values of a material network.
+std::string _GetParametersKey(const HdMaterialNetwork& mat)
+{
+    std::string key;
 
-    const int bpp = image->GetBytesPerPixel();
-    const int bytesPerRow = spec.width * bpp;
-    const int bytesPerSlice = bytesPerRow * spec.height;
+    for (const HdMaterialNode& node : mat.nodes) {
+        key += node.path.GetName();
+        key += '{';
 
-    std::vector<unsigned char> storage(bytesPerSlice);
-    spec.data = storage.data();
+        for (auto const& entry : node.parameters) {
+            const VtValue& value = entry.second;
 
-    if (!image->Read(spec)) {
-        return nullptr;
+            key += entry.first.GetString();
+            key += '=';
+            key += TfStringify(value);
+
+            // The same asset path can resolve to different files.
+            if (value.IsHolding<SdfAssetPath>()) {
+                key += '@';
+                key += value.UncheckedGet<SdfAssetPath>().GetResolvedPath();
+            }
+
+            key += ';';
+        }
+
+        key += '}';
     }
 
-    MHWRender::MTexture* texture = nullptr;
+    return key;
+}
 
-    MHWRender::MTextureDescription desc;
-    desc.setToDefault2DTexture();
-    desc.fWidth = spec.width;
-    desc.fHeight = spec.height;
-    desc.fBytesPerRow = bytesPerRow;
-    desc.fBytesPerSlice = bytesPerSlice;
+} //anonymous namespace
 
-    switch (spec.format)
-    {
-    case GL_RED:
-        desc.fFormat = (spec.type == GL_FLOAT ?
-            MHWRender::kR32_FLOAT : MHWRender::kR8_UNORM);
-        texture = textureMgr->acquireTexture(path.c_str(), desc, spec.data);
-        break;
-    case GL_RGB:
-        if (spec.type == GL_FLOAT) {
-            desc.fFormat = MHWRender::kR32G32B32_FLOAT;
-            texture = textureMgr->acquireTexture(path.c_str(), desc, spec.data);
+/*! \brief  Returns the process-wide shader instance cache.
+*/
+HdVP2ShaderCache& HdVP2ShaderCache::GetInstance()
+{
+    static HdVP2ShaderCache sInstance;
+    return sInstance;
+}
+
+/*! \brief  Acquire the pristine template instance for a network topology.
+
+    The creator is called on cache miss, under the cache lock so that the
+    fragment graph of a topology is built only once when materials are
+    synchronized in parallel.
+*/
+HdVP2ShaderSharedPtr HdVP2ShaderCache::AcquireTemplate(
+    const std::string& topologyKey, const Creator& creator)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::weak_ptr<MHWRender::MShaderInstance>& entry = _templates[topologyKey];
+
+    HdVP2ShaderSharedPtr shaderTemplate = entry.lock();
+    if (!shaderTemplate) {
+        MHWRender::MShaderInstance* shader = creator();
+        if (!shader) {
+            return nullptr;
         }
-        else {
-            // R8G8B8 is not supported by VP2. Converted to R8G8B8A8.
-            constexpr int bpp_4 = 4;
-
-            desc.fFormat = MHWRender::kR8G8B8A8_UNORM;
-            desc.fBytesPerRow = spec.width * bpp_4;
-            desc.fBytesPerSlice = desc.fBytesPerRow * spec.height;
-
-            std::vector<unsigned char> texels(desc.fBytesPerSlice);
-
-            for (int y = 0; y < spec.height; y++) {
-                for (int x = 0; x < spec.width; x++) {
-                    const int t = spec.width * y + x;
-                    texels[t*bpp_4]     = storage[t*bpp];
-                    texels[t*bpp_4 + 1] = storage[t*bpp + 1];
-                    texels[t*bpp_4 + 2] = storage[t*bpp + 2];
-                    texels[t*bpp_4 + 3] = 255;
-                }
-            }
 
-            texture = textureMgr->acquireTexture(path.c_str(), desc, texels.data());
-            isColorSpaceSRGB = image->IsColorSpaceSRGB();
+        shaderTemplate.reset(shader, HdVP2ShaderDeleter());
+        entry = shaderTemplate;
+        _stats._numMisses++;
+
+        _Sweep(_templates, _templatesSweepSize);
+    }
+
+    return shaderTemplate;
+}
+
+/*! \brief  Acquire the shader instance of a material network.
+
+    Materials with the same network key share the same instance, otherwise
+    a new instance is cloned from the template. Parameters of a shared
+    instance must only be set to the values described by the network key.
+*/
+HdVP2ShaderSharedPtr HdVP2ShaderCache::Acquire(
+    const std::string& networkKey, const HdVP2ShaderSharedPtr& shaderTemplate)
+{
+    if (!shaderTemplate) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::weak_ptr<MHWRender::MShaderInstance>& entry = _instances[networkKey];
+
+    HdVP2ShaderSharedPtr shader = entry.lock();
+    if (shader) {
+        _stats._numHits++;
+    }
+    else {
+        MHWRender::MShaderInstance* clone = shaderTemplate->clone();
+        if (!clone) {
+            return nullptr;
         }
-        break;
-    case GL_RGBA:
-        if (spec.type == GL_FLOAT) {
-            desc.fFormat = MHWRender::kR32G32B32A32_FLOAT;
+
+        shader.reset(clone, HdVP2ShaderDeleter());
+        entry = shader;
+        _stats._numClones++;
+
+        _Sweep(_instances, _instancesSweepSize);
+    }
+
+    return shader;
+}
+
+/*! \brief  Returns the hit and miss counters of the cache.
+*/
+HdVP2ShaderCacheStats HdVP2ShaderCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+/*! \brief  Removes expired entries once the map reaches the sweep size.
+
+    The sweep size is then adjusted to twice the number of live entries so
+    that the cost of sweeping is amortized over insertions.
+*/
+void HdVP2ShaderCache::_Sweep(ShaderMap& map, size_t& sweepSize)
+{
+    if (map.size() < sweepSize) {
+        return;
+    }
+
+    for (auto it = map.begin(); it != map.end(); ) {
+        if (it->second.expired()) {
+            it = map.erase(it);
         }
         else {
-            desc.fFormat = MHWRender::kR8G8B8A8_UNORM;
-            isColorSpaceSRGB = image->IsColorSpaceSRGB();
+            ++it;
         }
-        texture = textureMgr->acquireTexture(path.c_str(), desc, spec.data);
-        break;
-    default:
-        break;
     }
 
-    return texture;
+    sweepSize = std::max(sweepSize, map.size() * 2);
 }
 
-} //anonymous namespace
-
 /*! \brief  Releases the reference to the shader owned by a smart pointer.
 */
 void
@@ -399,6 +472,7 @@ HdVP2Material::HdVP2Material(HdVP2RenderDelegate* renderDelegate, const SdfPath&
 /*! \brief  Destructor - will release allocated shader instances.
 */
 HdVP2Material::~HdVP2Material() {
+    _renderDelegate->RemoveMaterialWithPendingTextures(this);
 }
 
 /*! \brief  Synchronize VP2 state with scene delegate state based on dirty bits
@@ -425,8 +499,17 @@ void HdVP2Material::Sync(
                 HdMaterialNetwork vp2BxdfNet;
                 _ApplyVP2Fixes(vp2BxdfNet, bxdfNet);
 
-                // Create a shader instance for the material network.
-                _surfaceShader.reset(_CreateShaderInstance(vp2BxdfNet));
+                // Only the first material of a network topology builds a
+                // fragment graph, which is kept pristine as a template for
+                // cloning by structurally identical materials.
+                _topologyKey = _GetTopologyKey(bxdfNet);
+                _surfaceShaderId = !vp2BxdfNet.nodes.empty() ?
+                    vp2BxdfNet.nodes.back().path : SdfPath();
+                _surfaceShaderTemplate = HdVP2ShaderCache::GetInstance().AcquireTemplate(
+                    _topologyKey, [this, &vp2BxdfNet]() {
+                        return _CreateShaderInstance(vp2BxdfNet);
+                    });
+                _surfaceShader = _AcquireShaderInstance(bxdfNet);
 
                 if (TfDebug::IsEnabled(HDVP2_DEBUG_MATERIAL)) {
                     _PrintMaterialNetwork("BXDF", id, bxdfNet);
@@ -448,8 +531,15 @@ void HdVP2Material::Sync(
                 // Store primvar requirements.
                 _requiredPrimvars = std::move(vp2BxdfNet.primvars);
             }
+            else {
+                _surfaceShader = _AcquireShaderInstance(bxdfNet);
+            }
 
             _UpdateShaderInstance(bxdfNet);
+
+            if (!_pendingTextures.empty()) {
+                _renderDelegate->AddMaterialWithPendingTextures(this);
+            }
         }
         else {
             TF_WARN("Expected material resource for <%s> to hold HdMaterialNetworkMap,"
@@ -671,10 +761,23 @@ HdVP2Material::_CreateShaderInstance(const HdMaterialNetwork& mat) {
     return shaderInstance;
 }
 
+/*! \brief  Acquires the shader instance for the material network.
+
+    Materials never modify a cloned instance with parameter values different
+    from its network key: a parameter change acquires another instance.
+*/
+HdVP2ShaderSharedPtr HdVP2Material::_AcquireShaderInstance(const HdMaterialNetwork& mat)
+{
+    return HdVP2ShaderCache::GetInstance().Acquire(
+        _topologyKey + _GetParametersKey(mat), _surfaceShaderTemplate);
+}
+
 /*! \brief  Updates parameters for the surface shader.
 */
 void HdVP2Material::_UpdateShaderInstance(const HdMaterialNetwork& mat)
 {
+    _pendingTextures.clear();
+
     if (!_surfaceShader) {
         return;
     }
@@ -758,17 +861,15 @@ void HdVP2Material::_UpdateShaderInstance(const HdMaterialNetwork& mat)
                 const std::string& resolvedPath = val.GetResolvedPath();
                 const std::string& assetPath = val.GetAssetPath();
                 if (_IsUsdUVTexture(node) && token == _tokens->file) {
-                    const HdVP2TextureInfo& info = _AcquireTexture(
-                        !resolvedPath.empty() ? resolvedPath : assetPath);
+                    const std::string& path =
+                        !resolvedPath.empty() ? resolvedPath : assetPath;
+                    const HdVP2TextureInfo& info = _AcquireTexture(path);
 
-                    MHWRender::MTextureAssignment assignment;
-                    assignment.texture = info._texture.get();
-                    status = _surfaceShader->setParameter(paramName, assignment);
+                    status = _SetTextureParameters(nodeName, info);
 
-                    if (status) {
-                        paramName = nodeName + "isColorSpaceSRGB";
-                        status = _surfaceShader->setParameter(paramName,
-                            info._isColorSpaceSRGB);
+                    // The placeholder is replaced when decoding finishes.
+                    if (info._isPending) {
+                        _pendingTextures.push_back({ nodeName, path });
                     }
                 }
             }
@@ -782,22 +883,76 @@ void HdVP2Material::_UpdateShaderInstance(const HdMaterialNetwork& mat)
 }
 
 /*! \brief  Acquires a texture for the given image path.
+
+    Textures are shared with other materials through the texture cache. If the
+    image is still being decoded, a placeholder texture is returned and the
+    cache is queried again on next call.
 */
 const HdVP2TextureInfo&
 HdVP2Material::_AcquireTexture(const std::string& path)
 {
-    const auto it = _textureMap.find(path);
-    if (it != _textureMap.end()) {
-        return it->second;
+    HdVP2TextureInfo& info = _textureMap[path];
+    if (info._texture && !info._isPending) {
+        return info;
     }
 
-    bool isSRGB = false;
-    MHWRender::MTexture* texture = _LoadTexture(path, isSRGB);
-
-    HdVP2TextureInfo& info = _textureMap[path];
-    info._texture.reset(texture);
-    info._isColorSpaceSRGB = isSRGB;
+    info._texture = HdVP2TextureCache::GetInstance().Acquire(
+        path, info._isColorSpaceSRGB, info._isPending);
     return info;
 }
 
+/*! \brief  Sets the texture and its color space on the surface shader.
+
+    \param nodeName Prefix of the texture parameters
+    \param info     The texture to set
+*/
+MStatus HdVP2Material::_SetTextureParameters(
+    const MString& nodeName,
+    const HdVP2TextureInfo& info)
+{
+    MHWRender::MTextureAssignment assignment;
+    assignment.texture = info._texture.get();
+
+    const MString paramName = nodeName + _tokens->file.GetText();
+    MStatus status = _surfaceShader->setParameter(paramName, assignment);
+
+    if (status) {
+        const MString srgbParamName = nodeName + "isColorSpaceSRGB";
+        status = _surfaceShader->setParameter(srgbParamName,
+            info._isColorSpaceSRGB);
+    }
+
+    return status;
+}
+
+/*! \brief  Replaces placeholder textures whose decoding has finished. Main thread only.
+
+    \return True if some textures are still pending
+*/
+bool HdVP2Material::UpdatePendingTextures()
+{
+    if (!_surfaceShader) {
+        _pendingTextures.clear();
+        return false;
+    }
+
+    auto it = _pendingTextures.begin();
+    while (it != _pendingTextures.end()) {
+        const HdVP2TextureInfo& info = _AcquireTexture(it->_path);
+        if (info._isPending) {
+            ++it;
+            continue;
+        }
+
+        if (!_SetTextureParameters(it->_nodeName, info)) {
+            TF_DEBUG(HDVP2_DEBUG_MATERIAL).Msg(
+                "Failed to set texture %s\n", it->_path.c_str());
+        }
+
+        it = _pendingTextures.erase(it);
+    }
+
+    return !_pendingTextures.empty();
+}
+
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -20,9 +20,15 @@
 #include "pxr/pxr.h"
 #include "pxr/imaging/hd/material.h"
 
+#include "textureCache.h"
+
 #include <maya/MShaderManager.h>
 
+#include <functional>
+#include <mutex>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
@@ -43,6 +49,64 @@ using HdVP2ShaderUniquePtr = std::unique_ptr<
     HdVP2ShaderDeleter
 >;
 
+/*! \brief  A MShaderInstance shared by materials with identical networks.
+*/
+using HdVP2ShaderSharedPtr = std::shared_ptr<MHWRender::MShaderInstance>;
+
+/*! \brief  Statistics of the shader instance cache.
+*/
+struct HdVP2ShaderCacheStats {
+    size_t _numHits{ 0 };       //!< Materials sharing the instance of a fully identical network
+    size_t _numClones{ 0 };     //!< Materials getting a new instance cloned from a template
+    size_t _numMisses{ 0 };     //!< Network topologies requiring a new fragment graph
+};
+
+/*! \brief  Process-wide cache of shader instances for material networks.
+    \class  HdVP2ShaderCache
+
+    Shader instances are looked up by a key describing network topology, i.e.
+    node types and names, connections and primvar names. Materials with the
+    same topology clone a pristine template instance instead of building and
+    compiling a new fragment graph, and materials whose parameter values are
+    also identical share one instance. The cache holds no ownership of the
+    instances, which are released when no material uses them.
+*/
+class HdVP2ShaderCache final
+{
+public:
+    //! Creates a new shader instance for a template cache miss.
+    using Creator = std::function<MHWRender::MShaderInstance*()>;
+
+    static HdVP2ShaderCache& GetInstance();
+
+    HdVP2ShaderSharedPtr AcquireTemplate(const std::string& topologyKey,
+        const Creator& creator);
+
+    HdVP2ShaderSharedPtr Acquire(const std::string& networkKey,
+        const HdVP2ShaderSharedPtr& shaderTemplate);
+
+    HdVP2ShaderCacheStats GetStats() const;
+
+private:
+    HdVP2ShaderCache() = default;
+    ~HdVP2ShaderCache() = default;
+
+    HdVP2ShaderCache(const HdVP2ShaderCache&) = delete;
+    HdVP2ShaderCache& operator=(const HdVP2ShaderCache&) = delete;
+
+    //! Map of shader instances without ownership.
+    using ShaderMap = std::unordered_map<std::string, std::weak_ptr<MHWRender::MShaderInstance>>;
+
+    static void _Sweep(ShaderMap& map, size_t& sweepSize);
+
+    ShaderMap               _templates;             //!< Pristine instances indexed by topology key
+    ShaderMap               _instances;             //!< Material instances indexed by network key
+    size_t                  _templatesSweepSize{ 64 };  //!< Map size triggering removal of expired templates
+    size_t                  _instancesSweepSize{ 64 };  //!< Map size triggering removal of expired instances
+    HdVP2ShaderCacheStats   _stats;                 //!< Hit and miss counters
+    mutable std::mutex      _mutex;                 //!< Synchronization used to protect all data above
+};
+
 /*! \brief  A deleter for MTexture, for use with smart pointers.
 */
 struct HdVP2TextureDeleter
@@ -61,8 +125,9 @@ using HdVP2TextureUniquePtr = std::unique_ptr<
 */
 struct HdVP2TextureInfo
 {
-    HdVP2TextureUniquePtr  _texture;          //!< Unique pointer of the texture
-    bool                   _isColorSpaceSRGB; //!< Whether sRGB linearization is needed
+    HdVP2TextureSharedPtr  _texture;                    //!< Shared pointer of the texture
+    bool                   _isColorSpaceSRGB{ false };  //!< Whether sRGB linearization is needed
+    bool                   _isPending{ false };         //!< Whether _texture is a placeholder until decoding finishes
 };
 
 /*! \brief  An unordered string-indexed map to cache texture information.
@@ -93,17 +158,31 @@ public:
         return _requiredPrimvars;
     }
 
+    bool UpdatePendingTextures();
+
 private:
+    //! A texture parameter bound to a placeholder until decoding finishes.
+    struct PendingTexture {
+        MString     _nodeName;  //!< Prefix of the texture parameters
+        std::string _path;      //!< Path of the image
+    };
+
     MHWRender::MShaderInstance* _CreateShaderInstance(const HdMaterialNetwork& mat);
+    HdVP2ShaderSharedPtr _AcquireShaderInstance(const HdMaterialNetwork& mat);
     void _UpdateShaderInstance(const HdMaterialNetwork& mat);
     const HdVP2TextureInfo& _AcquireTexture(const std::string& path);
+    MStatus _SetTextureParameters(const MString& nodeName, const HdVP2TextureInfo& info);
 
     HdVP2RenderDelegate* const _renderDelegate; //!< VP2 render delegate for which this material was created
 
-    HdVP2ShaderUniquePtr  _surfaceShader;       //!< VP2 surface shader instance
+    HdVP2ShaderSharedPtr  _surfaceShader;       //!< VP2 surface shader instance, shared with identical materials
+    HdVP2ShaderSharedPtr  _surfaceShaderTemplate;   //!< Pristine instance the surface shader is cloned from
+    std::string           _topologyKey;         //!< Key of the network topology in the shader cache
     SdfPath               _surfaceShaderId;     //!< Path of the surface shader
     HdVP2TextureMap       _textureMap;          //!< Textures used by this material
     TfTokenVector         _requiredPrimvars;    //!< primvars required by this material
+
+    std::vector<PendingTexture> _pendingTextures;   //!< Texture parameters bound to placeholders
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -15,29 +15,45 @@
 //
 
 #include "mesh.h"
+#include "attributePrefetcher.h"
 #include "bboxGeom.h"
 #include "debugCodes.h"
 #include "draw_item.h"
 #include "material.h"
 #include "instancer.h"
+#include "primvarFill.h"
 #include "proxyRenderDelegate.h"
 #include "render_delegate.h"
 #include "tokens.h"
 
 #include "pxr/base/gf/matrix4d.h"
+#include "pxr/base/tf/envSetting.h"
 #include "pxr/imaging/hd/sceneDelegate.h"
-#include "pxr/imaging/hd/meshUtil.h"
-#include "pxr/imaging/hd/smoothNormals.h"
 #include "pxr/imaging/hd/vertexAdjacency.h"
 
 #include <maya/MMatrix.h>
 #include <maya/MProfiler.h>
 #include <maya/MSelectionMask.h>
 
-#include <numeric>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+TF_DEFINE_ENV_SETTING(VP2_RENDER_DELEGATE_WELD_VERTICES, false,
+    "Weld face vertices with identical point and primvar values instead of "
+    "fully unsharing vertices of meshes with uniform or face-varying primvars.");
+
+TF_DEFINE_ENV_SETTING(VP2_RENDER_DELEGATE_VERTEX_BUFFER_RING_SIZE, 1,
+    "Number of position and normal buffers (up to 3) cycled by Rprims whose "
+    "points are refilled, e.g. during playback. 1 disables the ring.");
+
 namespace {
 
     //! Required primvars when there is no material binding.
@@ -69,8 +85,10 @@ namespace {
     struct CommitState {
         HdVP2DrawItem::RenderItemData& _drawItemData;
 
-        //! If valid, new index buffer data to commit
-        int*    _indexBufferData{ nullptr };
+        //! If valid, new shared index buffer to set on the render item
+        MHWRender::MIndexBuffer* _sharedIndexBuffer{ nullptr };
+        //! If valid, topology data owning the new shared index buffer
+        HdVP2MeshTopologyDataSharedPtr _topologyData;
         //! If valid, new color buffer data to commit
         void*   _colorBufferData{ nullptr };
         //! If valid, new normals buffer data to commit
@@ -93,12 +111,15 @@ namespace {
         //! Is this object transparent
         bool _isTransparent{ false };
 
-        //! Instancing doesn't have dirty bits, every time we do update, we must update instance transforms
-        MMatrixArray _instanceTransforms;
+        //! If valid, new instance transforms to set
+        std::shared_ptr<const MMatrixArray> _instanceTransforms;
 
         //! Color array to support per-instance color and selection highlight.
         MFloatArray _instanceColors;
 
+        //! Number of bytes to commit for each buffer kind
+        size_t _numBytes[kBufferKindCount]{};
+
         //! Construct valid commit state
         CommitState(HdVP2DrawItem& item) : _drawItemData(item.GetRenderItemData())
         {}
@@ -132,30 +153,31 @@ namespace {
         size_t numVertices,
         size_t channelOffset,
         bool requiresUnsharedVertices,
+        const HdVP2WeldedVertices* weldedVertices,
         const MString& rprimId,
         const HdMeshTopology& topology,
         const TfToken& primvarName,
         const VtArray<SRC_TYPE>& primvarData,
         const HdInterpolation& primvarInterp)
     {
+        using Fill = HdVP2PrimvarFill<DEST_TYPE, SRC_TYPE>;
+
+        const SRC_TYPE* src = primvarData.cdata();
+
         switch (primvarInterp) {
         case HdInterpolationConstant:
-            for (size_t v = 0; v < numVertices; v++) {
-                SRC_TYPE* pointer = reinterpret_cast<SRC_TYPE*>(
-                    reinterpret_cast<float*>(&vertexBuffer[v]) + channelOffset);
-                *pointer = primvarData[0];
-            }
+            Fill::FillConstant(vertexBuffer, numVertices, channelOffset, primvarData[0]);
             break;
         case HdInterpolationVarying:
         case HdInterpolationVertex:
             if (requiresUnsharedVertices) {
-                const VtIntArray& faceVertexIndices = topology.GetFaceVertexIndices();
+                // Welded vertices are gathered from the points they are taken
+                // from, unshared vertices from the face vertex indices.
+                const VtIntArray& faceVertexIndices = weldedVertices ?
+                    weldedVertices->_points : topology.GetFaceVertexIndices();
                 if (numVertices == faceVertexIndices.size()) {
-                    for (size_t v = 0; v < numVertices; v++) {
-                        SRC_TYPE* pointer = reinterpret_cast<SRC_TYPE*>(
-                            reinterpret_cast<float*>(&vertexBuffer[v]) + channelOffset);
-                        *pointer = primvarData[faceVertexIndices[v]];
-                    }
+                    Fill::FillGather(vertexBuffer, numVertices, channelOffset,
+                        src, faceVertexIndices.cdata());
                 }
                 else {
                     // numVertices must have been assigned with the number of
@@ -178,16 +200,7 @@ namespace {
                         primvarData.size(), numVertices);
                 }
 
-                if (channelOffset == 0 && sizeof(DEST_TYPE) == sizeof(SRC_TYPE)) {
-                    memcpy(vertexBuffer, primvarData.cdata(), sizeof(DEST_TYPE) * numVertices);
-                }
-                else {
-                    for (size_t v = 0; v < numVertices; v++) {
-                        SRC_TYPE* pointer = reinterpret_cast<SRC_TYPE*>(
-                            reinterpret_cast<float*>(&vertexBuffer[v]) + channelOffset);
-                        *pointer = primvarData[v];
-                    }
-                }
+                Fill::FillCopy(vertexBuffer, numVertices, channelOffset, src);
             }
             else {
                 // The primvar has less data than needed. Issue warning and skip
@@ -216,14 +229,13 @@ namespace {
                             primvarData.size(), numFaces);
                     }
 
-                    for (size_t f = 0, v = 0; f < numFaces; f++) {
-                        const size_t faceVertexCount = faceVertexCounts[f];
-                        const size_t faceVertexEnd = v + faceVertexCount;
-                        for (; v < faceVertexEnd; v++) {
-                            SRC_TYPE* pointer = reinterpret_cast<SRC_TYPE*>(
-                                reinterpret_cast<float*>(&vertexBuffer[v]) + channelOffset);
-                            *pointer = primvarData[f];
-                        }
+                    if (weldedVertices) {
+                        Fill::FillGather(vertexBuffer, numVertices, channelOffset,
+                            src, weldedVertices->_faces.cdata());
+                    }
+                    else {
+                        Fill::FillUniform(vertexBuffer, numVertices, channelOffset,
+                            src, faceVertexCounts.cdata(), numFaces);
                     }
                 }
                 else {
@@ -246,27 +258,26 @@ namespace {
             break;
         case HdInterpolationFaceVarying:
             if (requiresUnsharedVertices) {
-                if (numVertices <= primvarData.size()) {
+                const size_t numFaceVertices = weldedVertices ?
+                    topology.GetFaceVertexIndices().size() : numVertices;
+                if (numFaceVertices <= primvarData.size()) {
                     // If the primvar has more data than needed, we issue a warning,
                     // but don't skip the primvar update. Truncate the buffer to the
                     // expected length.
-                    if (numVertices < primvarData.size()) {
+                    if (numFaceVertices < primvarData.size()) {
                         TF_DEBUG(HDVP2_DEBUG_MESH).Msg("Invalid Hydra prim '%s': "
                             "primvar %s has %zu elements, while its topology references "
                             "only upto element index %zu.\n",
                             rprimId.asChar(), primvarName.GetText(),
-                            primvarData.size(), numVertices);
+                            primvarData.size(), numFaceVertices);
                     }
 
-                    if (channelOffset == 0 && sizeof(DEST_TYPE) == sizeof(SRC_TYPE)) {
-                        memcpy(vertexBuffer, primvarData.cdata(), sizeof(DEST_TYPE) * numVertices);
+                    if (weldedVertices) {
+                        Fill::FillGather(vertexBuffer, numVertices, channelOffset,
+                            src, weldedVertices->_faceVertices.cdata());
                     }
                     else {
-                        for (size_t v = 0; v < numVertices; v++) {
-                            SRC_TYPE* pointer = reinterpret_cast<SRC_TYPE*>(
-                                reinterpret_cast<float*>(&vertexBuffer[v]) + channelOffset);
-                            *pointer = primvarData[v];
-                        }
+                        Fill::FillCopy(vertexBuffer, numVertices, channelOffset, src);
                     }
                 }
                 else {
@@ -276,7 +287,7 @@ namespace {
                         "primvar %s has only %zu elements, while its topology expects "
                         "at least %zu elements. Skipping primvar update.\n",
                         rprimId.asChar(), primvarName.GetText(),
-                        primvarData.size(), numVertices);
+                        primvarData.size(), numFaceVertices);
 
                     memset(vertexBuffer, 0, sizeof(DEST_TYPE) * numVertices);
                 }
@@ -295,39 +306,347 @@ namespace {
         }
     }
 
-    //! Helper utility function to get number of edge indices
-    unsigned int _GetNumOfEdgeIndices(const HdMeshTopology& topology)
+    /*! \brief  Helper utility function to compute smooth normals.
+
+        Computes normals of points [0, numNormals) from the adjacency table and
+        writes them directly to the destination, in parallel chunks for large
+        meshes. The result is identical to Hd_SmoothNormals::ComputeSmoothNormals.
+    */
+    void _FillSmoothNormals(GfVec3f* normals,
+        size_t numNormals,
+        const GfVec3f* points,
+        const Hd_VertexAdjacency& adjacency)
+    {
+        const int* entry = adjacency.GetAdjacencyTable().cdata();
+
+        HdVP2ParallelFill(numNormals, [normals, points, entry](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const int offset = entry[i * 2];
+                const int valence = entry[i * 2 + 1];
+                const int* e = &entry[offset];
+
+                GfVec3f normal(0);
+                const GfVec3f& curr = points[i];
+                for (int j = 0; j < valence; j++) {
+                    const GfVec3f& prev = points[*e++];
+                    const GfVec3f& next = points[*e++];
+                    // All meshes have all been converted to rightHanded
+                    normal += GfCross(next - curr, prev - curr);
+                }
+                normal.Normalize();
+                normals[i] = normal;
+            }
+        });
+    }
+
+    //! Raw view of the uniform or face-varying elements of a primvar.
+    struct _PrimvarElements {
+        const unsigned char* _data{ nullptr };  //!< First byte of the elements
+        size_t               _size{ 0 };        //!< Size of an element in bytes
+        HdInterpolation      _interp{ HdInterpolationConstant };
+    };
+
+    //! Helper utility function to get a raw view of the array if it has
+    //! enough elements.
+    template <typename T>
+    bool _GetPrimvarElements(const VtValue& value, HdInterpolation interp,
+        size_t numElements, _PrimvarElements& elements)
     {
-        const VtIntArray &faceVertexCounts = topology.GetFaceVertexCounts();
+        if (!value.IsHolding<VtArray<T>>()) {
+            return false;
+        }
 
-        unsigned int numIndex = 0;
-        for (int i = 0; i < faceVertexCounts.size(); i++)
-        {
-            numIndex += faceVertexCounts[i];
+        const VtArray<T>& array = value.UncheckedGet<VtArray<T>>();
+        if (array.size() < numElements) {
+            // Primvars with insufficient data are skipped at fill time, they
+            // don't contribute to welding either.
+            elements._data = nullptr;
+            return true;
         }
-        numIndex *= 2; // each edge has two ends.
-        return numIndex;
+
+        elements._data = reinterpret_cast<const unsigned char*>(array.cdata());
+        elements._size = sizeof(T);
+        elements._interp = interp;
+        return true;
     }
 
-    //! Helper utility function to extract edge indices
-    void _FillEdgeIndices(int* indices, const HdMeshTopology& topology)
+    /*! \brief  Helper utility function to weld face vertices.
+
+        Face vertices sharing the same point and the same values of all uniform
+        and face-varying primvars are welded into a single vertex. Scene
+        delegate doesn't provide face-varying value indices, so values are
+        compared exactly.
+
+        \return False if welding is not supported for the primvars or the
+                topology is invalid, in which case full unsharing is used.
+    */
+    bool _ComputeWeldedVertices(
+        HdVP2MeshTopologyCache& topologyCache,
+        const HdMeshTopology& topology,
+        const HdVP2MeshSharedData::PrimvarSourceMap& primvarSourceMap,
+        HdVP2WeldedVertices& welded)
     {
-        const VtIntArray &faceVertexCounts = topology.GetFaceVertexCounts();
-        const int* currentFaceStart = topology.GetFaceVertexIndices().cdata();
-        for (int faceId = 0; faceId < faceVertexCounts.size(); faceId++)
-        {
-            int numVertexIndicesInFace = faceVertexCounts[faceId];
-            if (numVertexIndicesInFace >= 2)
-            {
-                for (int faceVertexId = 0; faceVertexId < numVertexIndicesInFace; faceVertexId++)
-                {
-                    bool isLastVertex = faceVertexId == numVertexIndicesInFace - 1;
-                    *(indices++) = *(currentFaceStart + faceVertexId);
-                    *(indices++) = isLastVertex ? *currentFaceStart : *(currentFaceStart + faceVertexId + 1);
+        const VtIntArray& faceVertexCounts = topology.GetFaceVertexCounts();
+        const VtIntArray& faceVertexIndices = topology.GetFaceVertexIndices();
+        const size_t numFaces = faceVertexCounts.size();
+        const size_t numFaceVertices = faceVertexIndices.size();
+
+        std::vector<_PrimvarElements> primvars;
+        for (const auto& it : primvarSourceMap) {
+            const HdInterpolation interp = it.second.interpolation;
+            size_t numElements = 0;
+            if (interp == HdInterpolationUniform) {
+                numElements = numFaces;
+            }
+            else if (interp == HdInterpolationFaceVarying) {
+                numElements = numFaceVertices;
+            }
+            else {
+                continue;
+            }
+
+            const VtValue& value = it.second.data;
+            _PrimvarElements elements;
+            if (!_GetPrimvarElements<float>(value, interp, numElements, elements) &&
+                !_GetPrimvarElements<GfVec2f>(value, interp, numElements, elements) &&
+                !_GetPrimvarElements<GfVec3f>(value, interp, numElements, elements) &&
+                !_GetPrimvarElements<GfVec4f>(value, interp, numElements, elements)) {
+                return false;
+            }
+
+            if (elements._data) {
+                primvars.push_back(elements);
+            }
+        }
+
+        // Face index of each face vertex, also validating the topology.
+        std::vector<int> faceOfFaceVertex(numFaceVertices);
+        size_t faceVertex = 0;
+        for (size_t face = 0; face < numFaces; face++) {
+            const int count = faceVertexCounts[face];
+            if (count < 0 || faceVertex + count > numFaceVertices) {
+                return false;
+            }
+            std::fill_n(faceOfFaceVertex.begin() + faceVertex, count, (int)face);
+            faceVertex += count;
+        }
+        if (faceVertex != numFaceVertices) {
+            return false;
+        }
+
+        auto elementOf = [&faceOfFaceVertex](const _PrimvarElements& pv, size_t fv) {
+            const size_t index = (pv._interp == HdInterpolationUniform) ?
+                faceOfFaceVertex[fv] : fv;
+            return pv._data + index * pv._size;
+        };
+
+        auto equal = [&](size_t a, size_t b) {
+            if (faceVertexIndices[a] != faceVertexIndices[b]) {
+                return false;
+            }
+            for (const _PrimvarElements& pv : primvars) {
+                if (memcmp(elementOf(pv, a), elementOf(pv, b), pv._size) != 0) {
+                    return false;
                 }
             }
-            currentFaceStart += numVertexIndicesInFace;
+            return true;
+        };
+
+        // Open hashing with a power-of-two bucket array and chained entries.
+        size_t numBuckets = 1;
+        while (numBuckets < numFaceVertices) {
+            numBuckets <<= 1;
+        }
+        std::vector<int> buckets(numBuckets, -1);
+        std::vector<int> next;
+        next.reserve(numFaceVertices);
+
+        VtIntArray weldedFaceVertexIndices(numFaceVertices);
+        welded._faceVertices.clear();
+        welded._points.clear();
+        welded._faces.clear();
+
+        for (size_t fv = 0; fv < numFaceVertices; fv++) {
+            size_t hash = faceVertexIndices[fv];
+            for (const _PrimvarElements& pv : primvars) {
+                const unsigned char* e = elementOf(pv, fv);
+                boost::hash_combine(hash, boost::hash_range(e, e + pv._size));
+            }
+
+            int& head = buckets[hash & (numBuckets - 1)];
+
+            int vertex = head;
+            while (vertex >= 0 && !equal(welded._faceVertices[vertex], fv)) {
+                vertex = next[vertex];
+            }
+
+            if (vertex < 0) {
+                vertex = (int)welded._faceVertices.size();
+                welded._faceVertices.push_back((int)fv);
+                welded._points.push_back(faceVertexIndices[fv]);
+                welded._faces.push_back(faceOfFaceVertex[fv]);
+                next.push_back(head);
+                head = vertex;
+            }
+
+            weldedFaceVertexIndices[fv] = vertex;
+        }
+
+        const HdMeshTopology weldedTopology(
+            topology.GetScheme(),
+            topology.GetOrientation(),
+            faceVertexCounts,
+            weldedFaceVertexIndices,
+            topology.GetHoleIndices(),
+            topology.GetRefineLevel()
+        );
+
+        welded._topologyData = topologyCache.Acquire(weldedTopology);
+        return true;
+    }
+
+    //! Helper utility function to get the size of vertex buffer rings.
+    unsigned int _GetVertexBufferRingSize()
+    {
+        static const int ringSize =
+            TfGetEnvSetting(VP2_RENDER_DELEGATE_VERTEX_BUFFER_RING_SIZE);
+        return static_cast<unsigned int>(std::max(ringSize, 1));
+    }
+
+    //! Helper utility function to get the number of bytes of the buffers
+    //! owned by a draw item. Index buffers shared with other Rprims of
+    //! identical topology are owned by the topology cache.
+    size_t _GetNumOwnedBytes(const HdVP2DrawItem::RenderItemData& drawItemData)
+    {
+        size_t numBytes = 0;
+
+        if (drawItemData._normalsBuffer) {
+            numBytes += drawItemData._normalsBuffer->GetNumBytes();
+        }
+
+        if (drawItemData._colorBuffer) {
+            numBytes += drawItemData._colorBuffer->vertexCount() *
+                drawItemData._colorBuffer->descriptor().dimension() * sizeof(float);
+        }
+
+        for (const auto& entry : drawItemData._primvarBuffers) {
+            if (const MHWRender::MVertexBuffer* buffer = entry.second.get()) {
+                numBytes += buffer->vertexCount() *
+                    buffer->descriptor().dimension() * sizeof(float);
+            }
+        }
+
+        if (drawItemData._indexBuffer) {
+            numBytes += drawItemData._indexBuffer->size() * sizeof(unsigned int);
         }
+
+        return numBytes;
+    }
+
+    //! Number of instances tested by each parallel block of the visible
+    //! instances compaction.
+    constexpr size_t kCompactionBlockSize = 4 * 1024;
+
+    /*! \brief  Get indices of instances passing the culling test.
+
+        Stream compaction in three steps: parallel blocks test their instances
+        and count the visible ones, an exclusive scan of block counts gives the
+        output offset of each block, then parallel blocks write the indices of
+        their visible instances from that offset. Indices are in increasing
+        order.
+
+        \return Indices of visible instances, or null if all instances are visible
+    */
+    std::shared_ptr<const std::vector<unsigned int>> _CompactVisibleInstances(
+        const MMatrixArray& transforms,
+        const GfRange3d& range,
+        const ProxyRenderDelegate& drawScene)
+    {
+        const size_t numInstances = transforms.length();
+        const size_t numBlocks =
+            (numInstances + kCompactionBlockSize - 1) / kCompactionBlockSize;
+
+        std::vector<unsigned char> visible(numInstances);
+        std::vector<size_t> blockOffsets(numBlocks + 1, 0);
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks),
+            [&](const tbb::blocked_range<size_t>& blocks) {
+                for (size_t b = blocks.begin(); b < blocks.end(); ++b) {
+                    const size_t begin = b * kCompactionBlockSize;
+                    const size_t end = std::min(begin + kCompactionBlockSize, numInstances);
+
+                    size_t numVisible = 0;
+                    for (size_t i = begin; i < end; ++i) {
+                        const MMatrix& matrix = transforms[static_cast<unsigned int>(i)];
+                        visible[i] = drawScene.IsInstanceCulled(
+                            range, GfMatrix4d(matrix.matrix)) ? 0 : 1;
+                        numVisible += visible[i];
+                    }
+                    blockOffsets[b + 1] = numVisible;
+                }
+            });
+
+        for (size_t b = 0; b < numBlocks; ++b) {
+            blockOffsets[b + 1] += blockOffsets[b];
+        }
+
+        const size_t numVisible = blockOffsets[numBlocks];
+        if (numVisible == numInstances) {
+            return nullptr;
+        }
+
+        auto visibleInstances = std::make_shared<std::vector<unsigned int>>(numVisible);
+        unsigned int* dst = visibleInstances->data();
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks),
+            [&](const tbb::blocked_range<size_t>& blocks) {
+                for (size_t b = blocks.begin(); b < blocks.end(); ++b) {
+                    const size_t begin = b * kCompactionBlockSize;
+                    const size_t end = std::min(begin + kCompactionBlockSize, numInstances);
+
+                    size_t offset = blockOffsets[b];
+                    for (size_t i = begin; i < end; ++i) {
+                        if (visible[i]) {
+                            dst[offset++] = static_cast<unsigned int>(i);
+                        }
+                    }
+                }
+            });
+
+        return visibleInstances;
+    }
+
+    //! Helper utility function to get the transforms of drawn instances,
+    //! optionally premultiplied by a matrix. The shared transforms are
+    //! returned as is when all instances are drawn without premultiplication.
+    std::shared_ptr<const MMatrixArray> _GatherInstanceTransforms(
+        const std::shared_ptr<const MMatrixArray>& transforms,
+        const std::vector<unsigned int>* visibleInstances,
+        const MMatrix* matrix)
+    {
+        if (!visibleInstances && !matrix) {
+            return transforms;
+        }
+
+        const unsigned int count = visibleInstances ?
+            static_cast<unsigned int>(visibleInstances->size()) : transforms->length();
+
+        auto result = std::make_shared<MMatrixArray>();
+        result->setLength(count);
+
+        MMatrixArray* dst = result.get();
+        const MMatrixArray* src = transforms.get();
+        const unsigned int* indices = visibleInstances ? visibleInstances->data() : nullptr;
+
+        HdVP2ParallelFill(count, [dst, src, indices, matrix](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const unsigned int k = static_cast<unsigned int>(i);
+                const MMatrix& instance = (*src)[indices ? indices[k] : k];
+                (*dst)[k] = matrix ? (*matrix) * instance : instance;
+            }
+        });
+
+        return result;
     }
 
     //! Helper utility function to adapt Maya API changes.
@@ -350,7 +669,7 @@ HdVP2Mesh::HdVP2Mesh(HdVP2RenderDelegate* delegate, const SdfPath& id, const Sdf
 {
     const MHWRender::MVertexBufferDescriptor vbDesc(
         "", MHWRender::MGeometry::kPosition, MHWRender::MGeometry::kFloat, 3);
-    _meshSharedData._positionsBuffer.reset(new MHWRender::MVertexBuffer(vbDesc));
+    _meshSharedData._positionsBuffer.reset(new HdVP2VertexBufferRing(vbDesc));
 }
 
 //! \brief  Destructor
@@ -366,16 +685,28 @@ void HdVP2Mesh::Sync(
 {
     // We don't create a repr for the selection token because this token serves
     // for selection state update only. Return early to reserve dirty bits so
-    // they can be used to sync regular reprs later.
+    // they can be used to sync regular reprs later, including the bits
+    // withheld from the scene delegate for prefetched values.
     if (reprToken == HdVP2ReprTokens->selection) {
+        *dirtyBits |= _prefetchedBits;
         return;
     }
 
     MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
         MProfiler::kColorC_L2, _rprimId.asChar(), "HdVP2Mesh::Sync");
 
+    _delegate->GetVP2ResourceRegistry().GetStatsCounters().AddSyncedRprim(*dirtyBits);
+
     const SdfPath& id = GetId();
 
+    // Values prefetched for bits withheld from the scene delegate.
+    const HdDirtyBits prefetchedBits = _prefetchedBits;
+    _prefetchedBits = 0;
+
+    const HdVP2AttributePrefetcher* prefetcher = prefetchedBits ?
+        static_cast<HdVP2RenderParam*>(renderParam)->GetDrawScene().GetAttributePrefetcher() :
+        nullptr;
+
     if (*dirtyBits & HdChangeTracker::DirtyMaterialId) {
         _SetMaterialId(delegate->GetRenderIndex().GetChangeTracker(),
             delegate->GetMaterialId(id));
@@ -395,8 +726,17 @@ void HdVP2Mesh::Sync(
         _UpdatePrimvarSources(delegate, *dirtyBits, requiredPrimvars);
     }
 
+    if (prefetchedBits & HdChangeTracker::DirtyNormals) {
+        const VtValue* normals = prefetcher ? prefetcher->GetNormals(id) : nullptr;
+        const auto it = _meshSharedData._primvarSourceMap.find(HdTokens->normals);
+        if (it != _meshSharedData._primvarSourceMap.end()) {
+            it->second.data = normals ? *normals : GetPrimvar(delegate, HdTokens->normals);
+        }
+    }
+
     if (HdChangeTracker::IsTopologyDirty(*dirtyBits, id)) {
         _meshSharedData._topology = GetMeshTopology(delegate);
+        _meshSharedData._adjacency.reset();
 
         // If there is uniform or face-varying primvar, we have to expand shared
         // vertices in CPU because OpenGL SSBO technique is not widely supported
@@ -411,66 +751,97 @@ void HdVP2Mesh::Sync(
             }
         }
 
-        if (requiresUnsharedVertices) {
-            const HdMeshTopology& topology = _meshSharedData._topology;
-
-            // Fill with sequentially increasing values, starting from 0. The
-            // new face vertex indices will then be implicitly used to assemble
-            // all primvar vertex buffers.
-            VtIntArray newFaceVtxIds;
-            newFaceVtxIds.resize(topology.GetFaceVertexIndices().size());
-            std::iota(newFaceVtxIds.begin(), newFaceVtxIds.end(), 0);
-
-            _meshSharedData._unsharedTopology.reset(
-                new HdMeshTopology(
-                    topology.GetScheme(),
-                    topology.GetOrientation(),
-                    topology.GetFaceVertexCounts(),
-                    newFaceVtxIds,
-                    topology.GetHoleIndices(),
-                    topology.GetRefineLevel()
-                )
+        // Topology-dependent data is shared with all Rprims of identical
+        // topology. The previous data is released from main thread because
+        // it might own the last reference to VP2 index buffers.
+        HdVP2MeshTopologyDataSharedPtr topologyData =
+            _delegate->GetMeshTopologyCache().Acquire(_meshSharedData._topology);
+        _meshSharedData._topologyData.swap(topologyData);
+        if (topologyData) {
+            _delegate->GetVP2ResourceRegistry().EnqueueCommit(
+                [topologyData]() {}
             );
         }
-        else {
-            _meshSharedData._unsharedTopology.reset(nullptr);
+
+        _meshSharedData._unsharedTopology = requiresUnsharedVertices ?
+            &_meshSharedData._topologyData->GetUnsharedTopology() : nullptr;
+    }
+
+    // When welded vertices change without a topology change, all vertex
+    // buffers and index buffers of the draw items have to be refilled.
+    const bool topologyDirty = HdChangeTracker::IsTopologyDirty(*dirtyBits, id);
+    const bool weldedVerticesChanged =
+        _UpdateWeldedVertices(*dirtyBits, topologyDirty);
+    if (weldedVerticesChanged && !topologyDirty) {
+        const HdDirtyBits vertexBits = HdChangeTracker::DirtyTopology |
+            HdChangeTracker::DirtyPoints |
+            HdChangeTracker::DirtyNormals |
+            HdChangeTracker::DirtyPrimvar |
+            (_customDirtyBitsInUse & (DirtySmoothNormals | DirtyFlatNormals |
+                DirtyIndices | DirtyHullIndices | DirtyPointsIndices));
+
+        for (const std::pair<TfToken, HdReprSharedPtr>& pair : _reprs) {
+            const HdRepr::DrawItems& items = pair.second->GetDrawItems();
+            for (HdDrawItem* item : items) {
+                if (HdVP2DrawItem* drawItem = static_cast<HdVP2DrawItem*>(item)) {
+                    drawItem->SetDirtyBits(vertexBits);
+                }
+            }
         }
     }
 
-    // Prepare position buffer. It is shared among all draw items so it should
-    // be updated only once when it gets dirty.
-    if (HdChangeTracker::IsPrimvarDirty(*dirtyBits, id, HdTokens->points)) {
-        const VtValue value = delegate->Get(id, HdTokens->points);
+    const bool pointsDirty =
+        HdChangeTracker::IsPrimvarDirty(*dirtyBits, id, HdTokens->points) ||
+        (prefetchedBits & HdChangeTracker::DirtyPoints);
+    if (pointsDirty) {
+        const VtValue* points = prefetcher ? prefetcher->GetPoints(id) : nullptr;
+        const VtValue value = points ? *points : delegate->Get(id, HdTokens->points);
         _meshSharedData._points = value.Get<VtVec3fArray>();
+    }
 
+    // Prepare position buffer. It is shared among all draw items so it should
+    // be updated only once when it gets dirty.
+    if (pointsDirty || weldedVerticesChanged) {
         const HdMeshTopology& topology = _meshSharedData._topology;
 
         const bool requiresUnsharedVertices =
             _meshSharedData._unsharedTopology != nullptr;
+        const HdVP2WeldedVertices* weldedVertices =
+            _meshSharedData._weldedVertices.get();
 
-        const size_t numVertices = requiresUnsharedVertices ?
-            topology.GetFaceVertexIndices().size() :
-            topology.GetNumPoints();
+        const size_t numVertices = weldedVertices ?
+            weldedVertices->GetNumVertices() : requiresUnsharedVertices ?
+            topology.GetFaceVertexIndices().size() : topology.GetNumPoints();
 
-        void* bufferData = _meshSharedData._positionsBuffer->acquire(numVertices, true);
+        // Animated points are filled into the next buffer of the ring while
+        // the render items keep drawing from the current one.
+        void* bufferData = _meshSharedData._positionsBuffer->Acquire(
+            numVertices, _GetVertexBufferRingSize());
         if (bufferData) {
             _FillPrimvarData(static_cast<GfVec3f*>(bufferData),
-                numVertices, 0, requiresUnsharedVertices,
+                numVertices, 0, requiresUnsharedVertices, weldedVertices,
                 _rprimId, topology,
                 HdTokens->points, _meshSharedData._points, HdInterpolationVertex);
 
             // Capture class member for lambda
             MHWRender::MVertexBuffer* const positionsBuffer =
-                _meshSharedData._positionsBuffer.get();
+                _meshSharedData._positionsBuffer->GetCurrent();
             const MString& rprimId = _rprimId;
 
-            _delegate->GetVP2ResourceRegistry().EnqueueCommit(
-                [positionsBuffer, bufferData, rprimId]() {
+            HdVP2ResourceRegistry& registry = _delegate->GetVP2ResourceRegistry();
+            HdVP2RenderStatsCounters& stats = registry.GetStatsCounters();
+            const size_t numBytes = numVertices * sizeof(GfVec3f);
+            stats.AddAcquiredBytes(kBufferKindPositions, numBytes);
+
+            registry.EnqueueCommit(
+                [positionsBuffer, bufferData, rprimId, &stats, numBytes]() {
                     MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
                         MProfiler::kColorC_L2, rprimId.asChar(), "CommitPositions");
 
                     positionsBuffer->commit(bufferData);
-                }
+                    stats.AddCommittedBytes(kBufferKindPositions, numBytes);
+                },
+                numBytes, _GetCommitPriority()
             );
         }
     }
@@ -487,10 +858,230 @@ void HdVP2Mesh::Sync(
         _sharedData.visible = delegate->GetVisible(id);
     }
 
+    // A culled or low detail Rprim whose bounds moved closer requests another
+    // culling pass, which replays the changes deferred until then.
+    if (_cullingResult != kDrawFullDetail &&
+        (HdChangeTracker::IsExtentDirty(*dirtyBits, id) ||
+        HdChangeTracker::IsTransformDirty(*dirtyBits, id))) {
+        auto* const param = static_cast<HdVP2RenderParam*>(renderParam);
+        ProxyRenderDelegate& drawScene = param->GetDrawScene();
+        if (drawScene.TestBounds(_sharedData.bounds, _cullingResult) != _cullingResult) {
+            drawScene.InvalidateCulling();
+        }
+    }
+
+    // Draw items not used by the current level of detail are disabled when
+    // it changes, which comes with dirty visibility.
+    if (HdChangeTracker::IsVisibilityDirty(*dirtyBits, id)) {
+        _DisableInactiveDrawItems();
+    }
+
+    // Instance transforms are computed once for all draw items, and only
+    // when the instancer, the instance indices or the transform changed.
+    if (!GetInstancerId().IsEmpty()) {
+        HdVP2Instancer* instancer = static_cast<HdVP2Instancer*>(
+            delegate->GetRenderIndex().GetInstancer(GetInstancerId()));
+        if (TF_VERIFY(instancer)) {
+            const size_t instancerVersion = instancer->GetTransformsVersion();
+            if (!_meshSharedData._instanceTransforms ||
+                (instancerVersion != _meshSharedData._instancerVersion) ||
+                (*dirtyBits & (HdChangeTracker::DirtyInstanceIndex |
+                    HdChangeTracker::DirtyInstancer |
+                    HdChangeTracker::DirtyTransform))) {
+                auto transforms = std::make_shared<MMatrixArray>();
+                instancer->ComputeInstanceTransforms(
+                    id, _sharedData.bounds.GetMatrix(), *transforms);
+
+                _meshSharedData._instanceTransforms = transforms;
+                _meshSharedData._instancerVersion = instancerVersion;
+                ++_meshSharedData._instanceTransformsVersion;
+
+                auto* const param = static_cast<HdVP2RenderParam*>(renderParam);
+                _UpdateVisibleInstances(param->GetDrawScene());
+            }
+        }
+    }
+
     *dirtyBits = HdChangeTracker::Clean;
 
     // Draw item update is controlled by its own dirty bits.
-    _UpdateRepr(delegate, reprToken);
+    _UpdateRepr(delegate, _GetReprTokenForCullingResult(reprToken));
+}
+
+/*! \brief  Get the repr to use in place of the requested one.
+
+    Rprims drawn with low level of detail use the bounding box of the
+    lowDetail repr in place of hull and wireframe.
+*/
+const TfToken& HdVP2Mesh::_GetReprTokenForCullingResult(const TfToken& reprToken) const
+{
+    if (_cullingResult == kDrawLowDetail &&
+        (reprToken == HdReprTokens->smoothHull || reprToken == HdReprTokens->wire)) {
+        return HdVP2ReprTokens->lowDetail;
+    }
+
+    return reprToken;
+}
+
+/*! \brief  Whether the draw item is used by the current level of detail.
+
+    Draw items of the lowDetail repr replace the hull and wireframe ones for
+    low level of detail. Bounding box display and point snapping items are
+    used by all levels of detail.
+*/
+bool HdVP2Mesh::_IsDrawItemActive(const HdVP2DrawItem& drawItem) const
+{
+    const bool lowDetail = (_cullingResult == kDrawLowDetail);
+
+    if (drawItem.ContainsUsage(HdVP2DrawItem::kBBoxBatch)) {
+        return true;
+    }
+
+    if (drawItem.ContainsUsage(HdVP2DrawItem::kLowDetail)) {
+        return lowDetail;
+    }
+
+    if (!lowDetail) {
+        return true;
+    }
+
+    const MHWRender::MRenderItem* renderItem = drawItem.GetRenderItem();
+    return renderItem && (
+        renderItem->drawMode() == MHWRender::MGeometry::kBoundingBox ||
+        renderItem->primitive() == MHWRender::MGeometry::kPoints);
+}
+
+/*! \brief  Disable render items not used by the current level of detail.
+
+    Their dirty visibility is kept so they get enabled again by their next
+    update.
+*/
+void HdVP2Mesh::_DisableInactiveDrawItems()
+{
+    for (const std::pair<TfToken, HdReprSharedPtr>& pair : _reprs) {
+        const HdRepr::DrawItems& items = pair.second->GetDrawItems();
+        for (HdDrawItem* item : items) {
+            auto* drawItem = static_cast<HdVP2DrawItem*>(item);
+            if (!drawItem || _IsDrawItemActive(*drawItem)) {
+                continue;
+            }
+
+            HdVP2DrawItem::RenderItemData& drawItemData = drawItem->GetRenderItemData();
+            if (drawItemData._enabled) {
+                drawItemData._enabled = false;
+
+                _delegate->GetVP2ResourceRegistry().EnqueueCommit(
+                    [drawItem]() {
+                        MHWRender::MRenderItem* renderItem = drawItem->GetRenderItem();
+                        if (renderItem) {
+                            renderItem->enable(false);
+                        }
+                    },
+                    0, _GetCommitPriority()
+                );
+            }
+
+            drawItem->SetDirtyBits(HdChangeTracker::DirtyVisibility);
+        }
+    }
+}
+
+/*! \brief  Update the culling state against the frustum of the culling pass.
+
+    Instanced Rprims are never culled as a whole nor drawn with low detail
+    because their bounds don't enclose their instances. Instead, each of
+    their instances is culled against the frustum when instance culling is
+    enabled, and only the instances passing the test are drawn.
+
+    \return The dirty bits to mark on the Rprim when its culling state has
+            changed: visibility to switch its render items, and the changes
+            deferred while culled or drawn with low detail when it switches
+            back to full detail. For instanced Rprims, the instance culling
+            bit when the set of drawn instances changed. Not thread safe for
+            the same Rprim.
+*/
+HdDirtyBits HdVP2Mesh::UpdateCulling(const ProxyRenderDelegate& drawScene)
+{
+    // Instanced Rprims are never culled as a whole, only their instances.
+    if (!GetInstancerId().IsEmpty()) {
+        return _UpdateVisibleInstances(drawScene) ?
+            DirtyInstanceCulling : HdChangeTracker::Clean;
+    }
+
+    const HdVP2CullingResult result =
+        drawScene.TestBounds(_sharedData.bounds, _cullingResult);
+    if (_cullingResult == result) {
+        return HdChangeTracker::Clean;
+    }
+
+    _cullingResult = result;
+
+    if (_cullingResult != kDrawFullDetail) {
+        return HdChangeTracker::DirtyVisibility;
+    }
+
+    HdDirtyBits bits = _culledDirtyBits | HdChangeTracker::DirtyVisibility;
+    _culledDirtyBits = 0;
+
+    // Selection highlight is only synchronized with this bit, which is set
+    // by _InitRepr before the deferred selection bit gets propagated.
+    if (bits & DirtySelection) {
+        bits |= DirtySelectionHighlight;
+    }
+
+    return bits;
+}
+
+/*! \brief  Update the set of instances passing the culling test.
+
+    \return True if the set of drawn instances changed
+*/
+bool HdVP2Mesh::_UpdateVisibleInstances(const ProxyRenderDelegate& drawScene)
+{
+    std::shared_ptr<const std::vector<unsigned int>> visibleInstances;
+
+    const MMatrixArray* transforms = _meshSharedData._instanceTransforms.get();
+    if (transforms && drawScene.IsInstanceCullingEnabled()) {
+        visibleInstances = _CompactVisibleInstances(
+            *transforms, _sharedData.bounds.GetRange(), drawScene);
+    }
+
+    const auto& current = _meshSharedData._visibleInstances;
+    const bool changed = visibleInstances ?
+        (!current || *current != *visibleInstances) : (current != nullptr);
+
+    if (changed) {
+        _meshSharedData._visibleInstances = visibleInstances;
+        ++_meshSharedData._instanceTransformsVersion;
+    }
+
+    return changed;
+}
+
+/*! \brief  Returns the number of instances skipped by the last culling pass.
+*/
+size_t HdVP2Mesh::GetNumCulledInstances() const
+{
+    const auto& transforms = _meshSharedData._instanceTransforms;
+    const auto& visibleInstances = _meshSharedData._visibleInstances;
+
+    return (transforms && visibleInstances) ?
+        transforms->length() - visibleInstances->size() : 0;
+}
+
+/*! \brief  Map the index of a drawn instance to the USD instance index.
+
+    Both are the same unless culling of instances skipped some of them.
+*/
+int HdVP2Mesh::GetInstanceIndex(int drawnInstanceIndex) const
+{
+    const auto& visibleInstances = _meshSharedData._visibleInstances;
+    if (visibleInstances && drawnInstanceIndex >= 0 &&
+        static_cast<size_t>(drawnInstanceIndex) < visibleInstances->size()) {
+        return static_cast<int>((*visibleInstances)[drawnInstanceIndex]);
+    }
+
+    return drawnInstanceIndex;
 }
 
 /*! \brief  Returns the minimal set of dirty bits to place in the
@@ -577,6 +1168,21 @@ HdDirtyBits HdVP2Mesh::_PropagateDirtyBits(HdDirtyBits bits) const {
         bits |= HdChangeTracker::DirtyExtent;
     }
 
+    // A culled or low detail Rprim only pulls the data required by the
+    // culling pass and its bounding box, and defers other changes until it
+    // switches back to full detail.
+    if (_cullingResult != kDrawFullDetail) {
+        constexpr HdDirtyBits kCullingBits =
+            HdChangeTracker::DirtyTransform |
+            HdChangeTracker::DirtyExtent |
+            HdChangeTracker::DirtyVisibility;
+
+        _culledDirtyBits |= bits & ~(HdChangeTracker::Varying |
+            HdChangeTracker::InitRepr | HdChangeTracker::NewRepr);
+
+        bits &= (kCullingBits | HdChangeTracker::Varying);
+    }
+
     // Propagate dirty bits to all draw items.
     for (const std::pair<TfToken, HdReprSharedPtr>& pair : _reprs) {
         const HdReprSharedPtr& repr = pair.second;
@@ -588,6 +1194,42 @@ HdDirtyBits HdVP2Mesh::_PropagateDirtyBits(HdDirtyBits bits) const {
         }
     }
 
+    // Points and normals prefetched for the current time are taken in Sync,
+    // so the scene delegate doesn't need to resolve them again. Prefetched
+    // normals replace the previous value of the primvar source, which keeps
+    // its interpolation, so only vertex or varying normals are taken.
+    if (_cullingResult == kDrawFullDetail &&
+        (bits & (HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyNormals))) {
+        auto* const param = static_cast<HdVP2RenderParam*>(_delegate->GetRenderParam());
+        const HdVP2AttributePrefetcher* prefetcher =
+            param->GetDrawScene().GetAttributePrefetcher();
+        const SdfPath& id = GetId();
+
+        if (bits & HdChangeTracker::DirtyPoints) {
+            if (prefetcher && prefetcher->GetPoints(id)) {
+                _prefetchedBits |= HdChangeTracker::DirtyPoints;
+            }
+            else {
+                _prefetchedBits &= ~HdChangeTracker::DirtyPoints;
+            }
+        }
+
+        if (bits & HdChangeTracker::DirtyNormals) {
+            const auto it = _meshSharedData._primvarSourceMap.find(HdTokens->normals);
+            if (prefetcher && prefetcher->GetNormals(id) &&
+                it != _meshSharedData._primvarSourceMap.end() &&
+                (it->second.interpolation == HdInterpolationVertex ||
+                 it->second.interpolation == HdInterpolationVarying)) {
+                _prefetchedBits |= HdChangeTracker::DirtyNormals;
+            }
+            else {
+                _prefetchedBits &= ~HdChangeTracker::DirtyNormals;
+            }
+        }
+
+        bits &= ~_prefetchedBits;
+    }
+
     return bits;
 }
 
@@ -596,8 +1238,8 @@ HdDirtyBits HdVP2Mesh::_PropagateDirtyBits(HdDirtyBits bits) const {
     This is called prior to syncing the prim, the first time the repr
     is used.
 
-    \param  reprToken   the name of the repr to initalize.  HdRprim has already
-                        resolved the reprName to its final value.
+    \param  requestedReprToken the name of the repr to initalize.  HdRprim has already
+                               resolved the reprName to its final value.
 
     \param  dirtyBits   an in/out value.  It is initialized to the dirty bits
                         from the change tracker.  InitRepr can then set additional
@@ -608,7 +1250,7 @@ HdDirtyBits HdVP2Mesh::_PropagateDirtyBits(HdDirtyBits bits) const {
 
     See HdRprim::InitRepr()
 */
-void HdVP2Mesh::_InitRepr(const TfToken& reprToken, HdDirtyBits* dirtyBits) {
+void HdVP2Mesh::_InitRepr(const TfToken& requestedReprToken, HdDirtyBits* dirtyBits) {
     auto* const param = static_cast<HdVP2RenderParam*>(_delegate->GetRenderParam());
     MSubSceneContainer* subSceneContainer = param->GetContainer();
     if (ARCH_UNLIKELY(!subSceneContainer))
@@ -617,7 +1259,7 @@ void HdVP2Mesh::_InitRepr(const TfToken& reprToken, HdDirtyBits* dirtyBits) {
     // We don't create a repr for the selection token because it serves for
     // selection state update only. Mark DirtySelection bit that will be
     // automatically propagated to all draw items of the rprim.
-    if (reprToken == HdVP2ReprTokens->selection) {
+    if (requestedReprToken == HdVP2ReprTokens->selection) {
         const HdVP2SelectionStatus selectionState =
             param->GetDrawScene().GetPrimSelectionStatus(GetId());
         if (_selectionState != selectionState) {
@@ -630,18 +1272,31 @@ void HdVP2Mesh::_InitRepr(const TfToken& reprToken, HdDirtyBits* dirtyBits) {
         return;
     }
 
+    // Rprims drawn with low detail initialize the repr used instead.
+    const TfToken& reprToken = _GetReprTokenForCullingResult(requestedReprToken);
+
     // If the repr has any draw item with the DirtySelection bit, mark the
-    // DirtySelectionHighlight bit to invoke the synchronization call.
+    // DirtySelectionHighlight bit to invoke the synchronization call. Draw
+    // items evicted by the residency manager get a new render item, and are
+    // filled again by the synchronization of the repr.
     _ReprVector::iterator it = std::find_if(
         _reprs.begin(), _reprs.end(), _ReprComparator(reprToken));
     if (it != _reprs.end()) {
         const HdReprSharedPtr& repr = it->second;
         const HdRepr::DrawItems& items = repr->GetDrawItems();
-        for (const HdDrawItem* item : items) {
-            const HdVP2DrawItem* drawItem = static_cast<const HdVP2DrawItem*>(item);
-            if (drawItem && (drawItem->GetDirtyBits() & DirtySelection)) {
+        for (HdDrawItem* item : items) {
+            HdVP2DrawItem* drawItem = static_cast<HdVP2DrawItem*>(item);
+            if (!drawItem) {
+                continue;
+            }
+
+            if (drawItem->IsEvicted()) {
+                _AddRenderItem(reprToken, drawItem, *subSceneContainer);
+                *dirtyBits |= HdChangeTracker::NewRepr;
+            }
+
+            if (drawItem->GetDirtyBits() & DirtySelection) {
                 *dirtyBits |= DirtySelectionHighlight;
-                break;
             }
         }
         return;
@@ -662,54 +1317,10 @@ void HdVP2Mesh::_InitRepr(const TfToken& reprToken, HdDirtyBits* dirtyBits) {
         if (numDrawItems == 0) continue;
 
         for (size_t itemId = 0; itemId < numDrawItems; itemId++) {
-            auto* drawItem = new HdVP2DrawItem(_delegate, &_sharedData, desc);
+            auto* drawItem = new HdVP2DrawItem(_delegate, &_sharedData, reprToken, desc);
             repr->AddDrawItem(drawItem);
 
-            const MString& renderItemName = drawItem->GetRenderItemName();
-
-            MHWRender::MRenderItem* renderItem = nullptr;
-
-            switch (desc.geomStyle) {
-            case HdMeshGeomStyleHull:
-                renderItem = _CreateSmoothHullRenderItem(renderItemName);
-                break;
-            case HdMeshGeomStyleHullEdgeOnly:
-                // The smoothHull repr uses the wireframe item for selection
-                // highlight only.
-                if (reprToken == HdReprTokens->smoothHull) {
-                    renderItem = _CreateSelectionHighlightRenderItem(renderItemName);
-                    drawItem->SetUsage(HdVP2DrawItem::kSelectionHighlight);
-                }
-                // The item is used for wireframe display and selection highlight.
-                else if (reprToken == HdReprTokens->wire) {
-                    renderItem = _CreateWireframeRenderItem(renderItemName);
-                    drawItem->AddUsage(HdVP2DrawItem::kSelectionHighlight);
-                }
-                // The item is used for bbox display and selection highlight.
-                else if (reprToken == HdVP2ReprTokens->bbox) {
-                    renderItem = _CreateBoundingBoxRenderItem(renderItemName);
-                    drawItem->AddUsage(HdVP2DrawItem::kSelectionHighlight);
-                }
-                break;
-            case HdMeshGeomStylePoints:
-                renderItem = _CreatePointsRenderItem(renderItemName);
-                break;
-            default:
-                TF_WARN("Unsupported geomStyle");
-                break;
-            }
-
-            if (renderItem) {
-                // Store the render item pointer to avoid expensive lookup in the
-                // subscene container.
-                drawItem->SetRenderItem(renderItem);
-
-                _delegate->GetVP2ResourceRegistry().EnqueueCommit(
-                    [subSceneContainer, renderItem]() {
-                        subSceneContainer->add(renderItem);
-                    }
-                );
-            }
+            _AddRenderItem(reprToken, drawItem, *subSceneContainer);
         }
 
         if (desc.geomStyle == HdMeshGeomStyleHull) {
@@ -729,6 +1340,79 @@ void HdVP2Mesh::_InitRepr(const TfToken& reprToken, HdDirtyBits* dirtyBits) {
     }
 }
 
+/*! \brief  Create the render item of a draw item of the repr, and enqueue
+            its addition to the subscene container.
+
+    The usage of the draw item is set according to the repr. Bounding boxes
+    of non-instanced Rprims are drawn by the batch of the render delegate and
+    get no render item.
+*/
+void HdVP2Mesh::_AddRenderItem(
+    const TfToken& reprToken,
+    HdVP2DrawItem* drawItem,
+    MSubSceneContainer& subSceneContainer) const
+{
+    const HdMeshReprDesc& desc = drawItem->GetReprDesc();
+    const MString& renderItemName = drawItem->GetRenderItemName();
+
+    MHWRender::MRenderItem* renderItem = nullptr;
+
+    switch (desc.geomStyle) {
+    case HdMeshGeomStyleHull:
+        renderItem = _CreateSmoothHullRenderItem(renderItemName);
+        break;
+    case HdMeshGeomStyleHullEdgeOnly:
+        // The smoothHull repr uses the wireframe item for selection
+        // highlight only.
+        if (reprToken == HdReprTokens->smoothHull) {
+            renderItem = _CreateSelectionHighlightRenderItem(renderItemName);
+            drawItem->SetUsage(HdVP2DrawItem::kSelectionHighlight);
+        }
+        // The item is used for wireframe display and selection highlight.
+        else if (reprToken == HdReprTokens->wire) {
+            renderItem = _CreateWireframeRenderItem(renderItemName);
+            drawItem->AddUsage(HdVP2DrawItem::kSelectionHighlight);
+        }
+        // Bounding boxes of non-instanced Rprims are drawn by the
+        // batch of the render delegate, without own render item.
+        else if (reprToken == HdVP2ReprTokens->bbox && GetInstancerId().IsEmpty()) {
+            drawItem->SetUsage(HdVP2DrawItem::kBBoxBatch);
+        }
+        // The item is used for bbox display and selection highlight.
+        else if (reprToken == HdVP2ReprTokens->bbox) {
+            renderItem = _CreateBoundingBoxRenderItem(renderItemName);
+            drawItem->AddUsage(HdVP2DrawItem::kSelectionHighlight);
+        }
+        // The item is used for low detail display and selection highlight.
+        else if (reprToken == HdVP2ReprTokens->lowDetail) {
+            renderItem = _CreateLowDetailRenderItem(renderItemName);
+            drawItem->AddUsage(HdVP2DrawItem::kLowDetail);
+            drawItem->AddUsage(HdVP2DrawItem::kSelectionHighlight);
+        }
+        break;
+    case HdMeshGeomStylePoints:
+        renderItem = _CreatePointsRenderItem(renderItemName);
+        break;
+    default:
+        TF_WARN("Unsupported geomStyle");
+        break;
+    }
+
+    if (renderItem) {
+        // Store the render item pointer to avoid expensive lookup in the
+        // subscene container.
+        drawItem->SetRenderItem(renderItem);
+
+        MSubSceneContainer* container = &subSceneContainer;
+        _delegate->GetVP2ResourceRegistry().EnqueueCommit(
+            [container, renderItem]() {
+                container->add(renderItem);
+            },
+            0, kCommitPriorityHigh
+        );
+    }
+}
+
 /*! \brief  Update the named repr object for this Rprim.
 
     Repr objects are created to support specific reprName tokens, and contain a list of
@@ -781,6 +1465,11 @@ void HdVP2Mesh::_UpdateDrawItem(
     bool requireSmoothNormals,
     bool requireFlatNormals)
 {
+    if (drawItem->ContainsUsage(HdVP2DrawItem::kBBoxBatch)) {
+        _UpdateBBoxBatchSlot(drawItem);
+        return;
+    }
+
     const MHWRender::MRenderItem* renderItem = drawItem->GetRenderItem();
     if (ARCH_UNLIKELY(!renderItem)) {
         return;
@@ -811,46 +1500,46 @@ void HdVP2Mesh::_UpdateDrawItem(
     const HdRenderIndex& renderIndex = sceneDelegate->GetRenderIndex();
 
     const HdMeshTopology& topology = _meshSharedData._topology;
-    const HdMeshTopology* unsharedTopology = _meshSharedData._unsharedTopology.get();
+    const HdMeshTopology* unsharedTopology = _meshSharedData._unsharedTopology;
     const auto& primvarSourceMap = _meshSharedData._primvarSourceMap;
 
     const bool requiresUnsharedVertices = (unsharedTopology != nullptr);
-    const size_t numVertices = requiresUnsharedVertices ?
+    const HdVP2WeldedVertices* weldedVertices = _meshSharedData._weldedVertices.get();
+    const size_t numVertices = weldedVertices ?
+        weldedVertices->GetNumVertices() : requiresUnsharedVertices ?
         topology.GetFaceVertexIndices().size() : topology.GetNumPoints();
 
     // The bounding box item uses a globally-shared geometry data therefore it
     // doesn't need to extract index data from topology. Points use non-indexed
     // draw.
     const bool isBBoxItem =
-        (renderItem->drawMode() == MHWRender::MGeometry::kBoundingBox);
+        (renderItem->drawMode() == MHWRender::MGeometry::kBoundingBox) ||
+        drawItem->ContainsUsage(HdVP2DrawItem::kLowDetail);
     const bool isPointSnappingItem =
         (renderItem->primitive() == MHWRender::MGeometry::kPoints);
     const bool requiresIndexUpdate = !isBBoxItem && !isPointSnappingItem;
 
-    // Prepare index buffer.
+    // Prepare index buffer. Index buffers are shared with all Rprims of
+    // identical topology and computed only by the first draw item requesting
+    // them.
     if (requiresIndexUpdate && (itemDirtyBits & HdChangeTracker::DirtyTopology)) {
-        const HdMeshTopology* topologyToUse = unsharedTopology ? unsharedTopology : &topology;
-
-        if (desc.geomStyle == HdMeshGeomStyleHull) {
-            HdMeshUtil meshUtil(topologyToUse, id);
-            VtVec3iArray trianglesFaceVertexIndices;
-            VtIntArray primitiveParam;
-            meshUtil.ComputeTriangleIndices(&trianglesFaceVertexIndices, &primitiveParam, nullptr);
-
-            const int numIndex = trianglesFaceVertexIndices.size() * 3;
-
-            stateToCommit._indexBufferData = static_cast<int*>(
-                drawItemData._indexBuffer->acquire(numIndex, true));
-
-            memcpy(stateToCommit._indexBufferData, trianglesFaceVertexIndices.data(), numIndex * sizeof(int));
+        // Welded topology indexes welded vertices directly.
+        const HdVP2MeshTopologyDataSharedPtr& topologyDataPtr = weldedVertices ?
+            weldedVertices->_topologyData : _meshSharedData._topologyData;
+        const bool unsharedIndices = requiresUnsharedVertices && !weldedVertices;
+
+        HdVP2MeshTopologyData* topologyData = topologyDataPtr.get();
+        HdVP2ResourceRegistry& registry = _delegate->GetVP2ResourceRegistry();
+
+        if (topologyData && desc.geomStyle == HdMeshGeomStyleHull) {
+            stateToCommit._sharedIndexBuffer = topologyData->GetTriangleIndexBuffer(
+                unsharedIndices, id, registry);
+            stateToCommit._topologyData = topologyDataPtr;
         }
-        else if (desc.geomStyle == HdMeshGeomStyleHullEdgeOnly) {
-            unsigned int numIndex = _GetNumOfEdgeIndices(*topologyToUse);
-
-            stateToCommit._indexBufferData = static_cast<int*>(
-                drawItemData._indexBuffer->acquire(numIndex, true));
-
-            _FillEdgeIndices(stateToCommit._indexBufferData, *topologyToUse);
+        else if (topologyData && desc.geomStyle == HdMeshGeomStyleHullEdgeOnly) {
+            stateToCommit._sharedIndexBuffer = topologyData->GetEdgeIndexBuffer(
+                unsharedIndices, id, registry);
+            stateToCommit._topologyData = topologyDataPtr;
         }
     }
 
@@ -869,6 +1558,7 @@ void HdVP2Mesh::_UpdateDrawItem(
         }
 
         bool prepareNormals = false;
+        bool prepareSmoothNormals = false;
 
         // If there is authored normals, prepare buffer only when it is dirty.
         // otherwise, compute smooth normals from points and adjacency and we
@@ -881,30 +1571,73 @@ void HdVP2Mesh::_UpdateDrawItem(
             // at change tracker.
             // HdC_TODO: move the normals computation to GPU to save expensive
             // computation and buffer transfer.
-            Hd_VertexAdjacencySharedPtr adjacency(new Hd_VertexAdjacency());
-            HdBufferSourceSharedPtr adjacencyComputation =
-                adjacency->GetSharedAdjacencyBuilderComputation(&topology);
-            adjacencyComputation->Resolve(); // IS the adjacency updated now?
-
-            // The topology doesn't have to reference all of the points, thus
-            // we compute the number of normals as required by the topology.
-            normals = Hd_SmoothNormals::ComputeSmoothNormals(
-                adjacency.get(), topology.GetNumPoints(),
-                _meshSharedData._points.cdata());
-
-            interp = HdInterpolationVertex;
-
-            prepareNormals = !normals.empty();
+            prepareSmoothNormals = true;
         }
 
         if (prepareNormals) {
-            void* bufferData = drawItemData._normalsBuffer->acquire(numVertices, true);
+            void* bufferData = drawItemData._normalsBuffer->Acquire(
+                numVertices, _GetVertexBufferRingSize());
             if (bufferData) {
                 _FillPrimvarData(static_cast<GfVec3f*>(bufferData),
-                    numVertices, 0, requiresUnsharedVertices,
+                    numVertices, 0, requiresUnsharedVertices, weldedVertices,
                     _rprimId, topology, HdTokens->normals, normals, interp);
 
                 stateToCommit._normalsBufferData = bufferData;
+                stateToCommit._numBytes[kBufferKindNormals] += numVertices * sizeof(GfVec3f);
+            }
+        }
+        else if (prepareSmoothNormals) {
+            // The adjacency only depends on topology, it is built once after
+            // each topology change and reused for every points change.
+            if (!_meshSharedData._adjacency) {
+                _meshSharedData._adjacency.reset(new Hd_VertexAdjacency());
+                HdBufferSourceSharedPtr adjacencyComputation =
+                    _meshSharedData._adjacency->GetSharedAdjacencyBuilderComputation(&topology);
+                adjacencyComputation->Resolve();
+            }
+
+            const Hd_VertexAdjacency& adjacency = *_meshSharedData._adjacency;
+            const VtVec3fArray& points = _meshSharedData._points;
+
+            // The topology doesn't have to reference all of the points, thus
+            // we compute the number of normals as required by the topology.
+            const size_t numNormals = std::min<size_t>(
+                topology.GetNumPoints(), adjacency.GetNumPoints());
+
+            void* bufferData = (numNormals > 0) ?
+                drawItemData._normalsBuffer->Acquire(numVertices, _GetVertexBufferRingSize()) :
+                nullptr;
+            if (bufferData) {
+                if (points.size() < numNormals) {
+                    TF_DEBUG(HDVP2_DEBUG_MESH).Msg("Invalid Hydra prim '%s': "
+                        "points has only %zu elements, while its topology expects "
+                        "at least %zu elements. Skipping normals update.\n",
+                        _rprimId.asChar(), points.size(), numNormals);
+
+                    memset(bufferData, 0, sizeof(GfVec3f) * numVertices);
+                }
+                else if (requiresUnsharedVertices) {
+                    normals.resize(numNormals);
+                    _FillSmoothNormals(normals.data(), numNormals,
+                        points.cdata(), adjacency);
+
+                    _FillPrimvarData(static_cast<GfVec3f*>(bufferData),
+                        numVertices, 0, requiresUnsharedVertices, weldedVertices,
+                        _rprimId, topology, HdTokens->normals, normals,
+                        HdInterpolationVertex);
+                }
+                else if (numNormals < numVertices) {
+                    // Same as a vertex primvar with less data than needed.
+                    memset(bufferData, 0, sizeof(GfVec3f) * numVertices);
+                }
+                else {
+                    // Write directly to the vertex buffer, no intermediate array.
+                    _FillSmoothNormals(static_cast<GfVec3f*>(bufferData),
+                        numNormals, points.cdata(), adjacency);
+                }
+
+                stateToCommit._normalsBufferData = bufferData;
+                stateToCommit._numBytes[kBufferKindNormals] += numVertices * sizeof(GfVec3f);
             }
         }
     }
@@ -988,14 +1721,15 @@ void HdVP2Mesh::_UpdateDrawItem(
                 // Fill color and opacity into the float4 color stream.
                 if (bufferData) {
                     _FillPrimvarData(static_cast<GfVec4f*>(bufferData),
-                        numVertices, 0, requiresUnsharedVertices,
+                        numVertices, 0, requiresUnsharedVertices, weldedVertices,
                         _rprimId, topology, HdTokens->displayColor, colorArray, colorInterp);
 
                     _FillPrimvarData(static_cast<GfVec4f*>(bufferData),
-                        numVertices, 3, requiresUnsharedVertices,
+                        numVertices, 3, requiresUnsharedVertices, weldedVertices,
                         _rprimId, topology, HdTokens->displayOpacity, alphaArray, alphaInterp);
 
                     stateToCommit._colorBufferData = bufferData;
+                    stateToCommit._numBytes[kBufferKindColors] += numVertices * sizeof(GfVec4f);
                 }
 
                 // Use fallback CPV shader if there is no material binding or
@@ -1064,7 +1798,7 @@ void HdVP2Mesh::_UpdateDrawItem(
                     bufferData = buffer->acquire(numVertices, true);
                     if (bufferData) {
                         _FillPrimvarData(static_cast<float*>(bufferData),
-                            numVertices, 0, requiresUnsharedVertices,
+                            numVertices, 0, requiresUnsharedVertices, weldedVertices,
                             _rprimId, topology,
                             token, value.UncheckedGet<VtFloatArray>(), interp);
                     }
@@ -1084,7 +1818,7 @@ void HdVP2Mesh::_UpdateDrawItem(
                     bufferData = buffer->acquire(numVertices, true);
                     if (bufferData) {
                         _FillPrimvarData(static_cast<GfVec2f*>(bufferData),
-                            numVertices, 0, requiresUnsharedVertices,
+                            numVertices, 0, requiresUnsharedVertices, weldedVertices,
                             _rprimId, topology,
                             token, value.UncheckedGet<VtVec2fArray>(), interp);
                     }
@@ -1104,7 +1838,7 @@ void HdVP2Mesh::_UpdateDrawItem(
                     bufferData = buffer->acquire(numVertices, true);
                     if (bufferData) {
                         _FillPrimvarData(static_cast<GfVec3f*>(bufferData),
-                            numVertices, 0, requiresUnsharedVertices,
+                            numVertices, 0, requiresUnsharedVertices, weldedVertices,
                             _rprimId, topology,
                             token, value.UncheckedGet<VtVec3fArray>(), interp);
                     }
@@ -1124,7 +1858,7 @@ void HdVP2Mesh::_UpdateDrawItem(
                     bufferData = buffer->acquire(numVertices, true);
                     if (bufferData) {
                         _FillPrimvarData(static_cast<GfVec4f*>(bufferData),
-                            numVertices, 0, requiresUnsharedVertices,
+                            numVertices, 0, requiresUnsharedVertices, weldedVertices,
                             _rprimId, topology,
                             token, value.UncheckedGet<VtVec4fArray>(), interp);
                     }
@@ -1135,6 +1869,10 @@ void HdVP2Mesh::_UpdateDrawItem(
             }
 
             stateToCommit._primvarBufferDataMap[token] = bufferData;
+            if (bufferData) {
+                stateToCommit._numBytes[kBufferKindPrimvars] += numVertices *
+                    sizeof(float) * buffer->descriptor().dimension();
+            }
         }
     }
 
@@ -1192,71 +1930,107 @@ void HdVP2Mesh::_UpdateDrawItem(
         stateToCommit._worldMatrix = &drawItemData._worldMatrix;
     }
 
-    // If the mesh is instanced, create one new instance per transform.
-    // The current instancer invalidation tracking makes it hard for
-    // us to tell whether transforms will be dirty, so this code
-    // pulls them every time something changes.
-    if (!GetInstancerId().IsEmpty()) {
+    // If the mesh is instanced, create one new instance per transform. The
+    // instance transforms are shared by all draw items and only set on the
+    // render item when they changed since its last update. Instances culled
+    // by the last culling pass are skipped, along with their colors.
+    if (_meshSharedData._instanceTransforms) {
+        const std::shared_ptr<const MMatrixArray>& transforms =
+            _meshSharedData._instanceTransforms;
+        const unsigned int instanceCount = transforms->length();
+
+        const std::vector<unsigned int>* visibleInstances =
+            _meshSharedData._visibleInstances.get();
 
-        // Retrieve instance transforms from the instancer.
-        HdInstancer *instancer = renderIndex.GetInstancer(GetInstancerId());
-        VtMatrix4dArray transforms = static_cast<HdVP2Instancer*>(instancer)->
-            ComputeInstanceTransforms(id);
+        const bool instanceTransformsChanged = (drawItemData._instanceTransformsVersion !=
+            _meshSharedData._instanceTransformsVersion);
+        drawItemData._instanceTransformsVersion = _meshSharedData._instanceTransformsVersion;
 
-        MMatrix instanceMatrix;
+        // The world matrix is set by the instance transforms.
+        stateToCommit._worldMatrix = nullptr;
 
         if (isDedicatedSelectionHighlightItem) {
-            if (_selectionState == kFullySelected) {
-                stateToCommit._instanceTransforms.setLength(transforms.size());
-                for (size_t i = 0; i < transforms.size(); ++i) {
-                    transforms[i].Get(instanceMatrix.matrix);
-                    instanceMatrix = worldMatrix * instanceMatrix;
-                    stateToCommit._instanceTransforms[i] = instanceMatrix;
+            if (instanceTransformsChanged || (itemDirtyBits & DirtySelectionHighlight)) {
+                if (_selectionState == kFullySelected) {
+                    stateToCommit._instanceTransforms =
+                        _GatherInstanceTransforms(transforms, visibleInstances, nullptr);
                 }
-            }
-            else if (auto state = drawScene.GetPrimSelectionState(id)) {
-                for (const auto& indexArray : state->instanceIndices) {
-                    for (const auto index : indexArray) {
-                        transforms[index].Get(instanceMatrix.matrix);
-                        instanceMatrix = worldMatrix * instanceMatrix;
-                        stateToCommit._instanceTransforms.append(instanceMatrix);
+                else {
+                    auto selected = std::make_shared<MMatrixArray>();
+                    if (auto state = drawScene.GetPrimSelectionState(id)) {
+                        for (const auto& indexArray : state->instanceIndices) {
+                            for (const auto index : indexArray) {
+                                if (index < 0 || static_cast<unsigned int>(index) >= instanceCount) {
+                                    continue;
+                                }
+                                if (visibleInstances && !std::binary_search(
+                                        visibleInstances->begin(), visibleInstances->end(),
+                                        static_cast<unsigned int>(index))) {
+                                    continue;
+                                }
+                                selected->append((*transforms)[index]);
+                            }
+                        }
                     }
+                    stateToCommit._instanceTransforms = selected;
                 }
             }
         }
         else {
-            const unsigned int instanceCount = transforms.size();
-            stateToCommit._instanceTransforms.setLength(instanceCount);
-            for (size_t i = 0; i < instanceCount; ++i) {
-                transforms[i].Get(instanceMatrix.matrix);
-                instanceMatrix = worldMatrix * instanceMatrix;
-                stateToCommit._instanceTransforms[i] = instanceMatrix;
+            if (isBBoxItem) {
+                // The bounding box item transfers scale and offset of the
+                // bounds to each instance transform.
+                if ((instanceTransformsChanged || (itemDirtyBits & HdChangeTracker::DirtyExtent)) &&
+                    !range.IsEmpty()) {
+                    const GfVec3d midpoint = range.GetMidpoint();
+                    const GfVec3d size = range.GetSize();
+
+                    MTransformationMatrix transformation;
+                    transformation.setScale(size.data(), MSpace::kTransform);
+                    transformation.setTranslation(midpoint.data(), MSpace::kTransform);
+                    const MMatrix bboxMatrix = transformation.asMatrix();
+
+                    stateToCommit._instanceTransforms =
+                        _GatherInstanceTransforms(transforms, visibleInstances, &bboxMatrix);
+                }
+            }
+            else if (instanceTransformsChanged) {
+                stateToCommit._instanceTransforms =
+                    _GatherInstanceTransforms(transforms, visibleInstances, nullptr);
             }
 
             // If the item is used for both regular draw and selection highlight,
             // it needs to display both wireframe color and selection highlight
             // with one color vertex buffer.
-            if (drawItem->ContainsUsage(HdVP2DrawItem::kSelectionHighlight)) {
-                const MColor& color = drawScene.GetWireframeColor();
-                unsigned int offset = 0;
-
-                stateToCommit._instanceColors.setLength(instanceCount * kNumColorChannels);
-                for (unsigned int i = 0; i < instanceCount; ++i) {
-                    for (unsigned int j = 0; j < kNumColorChannels; j++) {
-                        stateToCommit._instanceColors[offset++] = color[j];
-                    }
-                }
-
+            if (drawItem->ContainsUsage(HdVP2DrawItem::kSelectionHighlight) &&
+                (instanceTransformsChanged || (itemDirtyBits & DirtySelectionHighlight))) {
+                std::vector<unsigned char> selected;
                 if (auto state = drawScene.GetPrimSelectionState(id)) {
+                    selected.resize(instanceCount, 0);
                     for (const auto& indexArray : state->instanceIndices) {
                         for (const auto i : indexArray) {
-                            offset = i * kNumColorChannels;
-                            for (unsigned int j = 0; j < kNumColorChannels; j++) {
-                                stateToCommit._instanceColors[offset+j] = kSelectionHighlightColor[j];
+                            if (i >= 0 && static_cast<unsigned int>(i) < instanceCount) {
+                                selected[i] = 1;
                             }
                         }
                     }
                 }
+
+                const MColor& color = drawScene.GetWireframeColor();
+                const unsigned int drawnCount = visibleInstances ?
+                    static_cast<unsigned int>(visibleInstances->size()) : instanceCount;
+
+                stateToCommit._instanceColors.setLength(drawnCount * kNumColorChannels);
+
+                unsigned int offset = 0;
+                for (unsigned int k = 0; k < drawnCount; ++k) {
+                    const unsigned int i = visibleInstances ? (*visibleInstances)[k] : k;
+                    const bool isSelected = !selected.empty() && selected[i];
+                    for (unsigned int j = 0; j < kNumColorChannels; j++) {
+                        stateToCommit._instanceColors[offset++] = isSelected ?
+                            kSelectionHighlightColor[j] : color[j];
+                    }
+                }
             }
         }
     }
@@ -1280,15 +2054,20 @@ void HdVP2Mesh::_UpdateDrawItem(
         }
     }
 
+    // Culled Rprims keep their render items disabled, as do draw items not
+    // used by the current level of detail.
+    const bool isVisible = drawItem->GetVisible() &&
+        (_cullingResult != kCulled) && _IsDrawItemActive(*drawItem);
+
     if (itemDirtyBits & HdChangeTracker::DirtyVisibility) {
-        drawItemData._enabled = drawItem->GetVisible();
+        drawItemData._enabled = isVisible;
         stateToCommit._enabled = &drawItemData._enabled;
     }
 
     if (isDedicatedSelectionHighlightItem) {
         if (itemDirtyBits & DirtySelectionHighlight) {
             const bool enable =
-                (_selectionState != kUnselected) && drawItem->GetVisible();
+                (_selectionState != kUnselected) && isVisible;
             if (drawItemData._enabled != enable) {
                 drawItemData._enabled = enable;
                 stateToCommit._enabled = &drawItemData._enabled;
@@ -1297,7 +2076,7 @@ void HdVP2Mesh::_UpdateDrawItem(
     }
     else if (isBBoxItem) {
         if (itemDirtyBits & HdChangeTracker::DirtyExtent) {
-            const bool enable = !range.IsEmpty() && drawItem->GetVisible();
+            const bool enable = !range.IsEmpty() && isVisible;
             if (drawItemData._enabled != enable) {
                 drawItemData._enabled = enable;
                 stateToCommit._enabled = &drawItemData._enabled;
@@ -1308,9 +2087,27 @@ void HdVP2Mesh::_UpdateDrawItem(
     // Reset dirty bits because we've prepared commit state for this draw item.
     drawItem->ResetDirtyBits();
 
+    if (stateToCommit._instanceTransforms) {
+        stateToCommit._numBytes[kBufferKindInstances] +=
+            stateToCommit._instanceTransforms->length() * 16 * sizeof(float);
+    }
+    stateToCommit._numBytes[kBufferKindInstances] +=
+        stateToCommit._instanceColors.length() * sizeof(float);
+
+    // Number of bytes uploaded by the commit task, used for its scheduling.
+    HdVP2RenderStatsCounters& stats = _delegate->GetVP2ResourceRegistry().GetStatsCounters();
+    HdVP2ResidencyManager& residency = _delegate->GetResidencyManager();
+    size_t commitBytes = 0;
+    for (size_t i = 0; i < kBufferKindCount; i++) {
+        const size_t numBytes = stateToCommit._numBytes[i];
+        stats.AddAcquiredBytes(static_cast<HdVP2BufferKind>(i), numBytes);
+        commitBytes += numBytes;
+    }
+
     // Capture the valid position buffer and index buffer
-    MHWRender::MVertexBuffer* positionsBuffer = _meshSharedData._positionsBuffer.get();
-    MHWRender::MIndexBuffer* indexBuffer = drawItemData._indexBuffer.get();
+    MHWRender::MVertexBuffer* positionsBuffer = _meshSharedData._positionsBuffer->GetCurrent();
+    MHWRender::MIndexBuffer* indexBuffer = drawItemData._sharedIndexBuffer ?
+        drawItemData._sharedIndexBuffer : drawItemData._indexBuffer.get();
 
     if (isBBoxItem) {
         const HdVP2BBoxGeom& sharedBBoxGeom = _delegate->GetSharedBBoxGeom();
@@ -1321,7 +2118,7 @@ void HdVP2Mesh::_UpdateDrawItem(
     }
 
     _delegate->GetVP2ResourceRegistry().EnqueueCommit(
-        [drawItem, stateToCommit, param, positionsBuffer, indexBuffer]()
+        [drawItem, stateToCommit, param, positionsBuffer, indexBuffer, &stats, &residency]()
     {
         MHWRender::MRenderItem* renderItem = drawItem->GetRenderItem();
         if (ARCH_UNLIKELY(!renderItem))
@@ -1333,7 +2130,8 @@ void HdVP2Mesh::_UpdateDrawItem(
         const HdVP2DrawItem::RenderItemData& drawItemData = stateToCommit._drawItemData;
 
         MHWRender::MVertexBuffer* colorBuffer = drawItemData._colorBuffer.get();
-        MHWRender::MVertexBuffer* normalsBuffer = drawItemData._normalsBuffer.get();
+        MHWRender::MVertexBuffer* normalsBuffer = drawItemData._normalsBuffer ?
+            drawItemData._normalsBuffer->GetCurrent() : nullptr;
 
         const HdVP2DrawItem::PrimvarBufferMap& primvarBuffers = drawItemData._primvarBuffers;
 
@@ -1360,9 +2158,15 @@ void HdVP2Mesh::_UpdateDrawItem(
             }
         }
 
-        // If available, something changed
-        if (stateToCommit._indexBufferData)
-            indexBuffer->commit(stateToCommit._indexBufferData);
+        // If available, something changed. Hold the topology data from main
+        // thread so the previous shared index buffer is released here.
+        if (stateToCommit._sharedIndexBuffer) {
+            stateToCommit._drawItemData._sharedIndexBuffer = stateToCommit._sharedIndexBuffer;
+            stateToCommit._drawItemData._topologyData = stateToCommit._topologyData;
+        }
+
+        MHWRender::MIndexBuffer* indexBufferToUse = stateToCommit._sharedIndexBuffer ?
+            stateToCommit._sharedIndexBuffer : indexBuffer;
 
         // If available, something changed
         if (stateToCommit._shader != nullptr) {
@@ -1377,10 +2181,19 @@ void HdVP2Mesh::_UpdateDrawItem(
 
         ProxyRenderDelegate& drawScene = param->GetDrawScene();
 
-        // Associate geometries with the render item only if the shader or the
-        // bounding box is changed.
+        // Associate geometries with the render item only if the shader, the
+        // bounding box or the shared index buffer is changed, or if a vertex
+        // buffer ring switched to another buffer.
+        const bool vertexBufferSwitched =
+            (drawItemData._boundPositionsBuffer != nullptr &&
+             drawItemData._boundPositionsBuffer != positionsBuffer) ||
+            (drawItemData._boundNormalsBuffer != nullptr &&
+             drawItemData._boundNormalsBuffer != normalsBuffer);
+
         if (stateToCommit._shader != nullptr ||
-            stateToCommit._boundingBox != nullptr) {
+            stateToCommit._boundingBox != nullptr ||
+            stateToCommit._sharedIndexBuffer != nullptr ||
+            vertexBufferSwitched) {
             MHWRender::MVertexBufferArray vertexBuffers;
             vertexBuffers.addBuffer(kPositionsStr, positionsBuffer);
 
@@ -1399,52 +2212,36 @@ void HdVP2Mesh::_UpdateDrawItem(
             }
 
             drawScene.setGeometryForRenderItem(*renderItem,
-                vertexBuffers, *indexBuffer, stateToCommit._boundingBox);
+                vertexBuffers, *indexBufferToUse, stateToCommit._boundingBox);
+
+            stateToCommit._drawItemData._boundPositionsBuffer = positionsBuffer;
+            stateToCommit._drawItemData._boundNormalsBuffer = normalsBuffer;
         }
 
         // Important, update instance transforms after setting geometry on render items!
-        auto& oldInstanceCount = stateToCommit._drawItemData._instanceCount;
-        auto newInstanceCount = stateToCommit._instanceTransforms.length();
-
-        // GPU instancing has been enabled. We cannot switch to consolidation
-        // without recreating render item, so we keep using GPU instancing.
-        if (stateToCommit._drawItemData._usingInstancedDraw) {
-            if (oldInstanceCount == newInstanceCount) {
-                for (unsigned int i = 0; i < newInstanceCount; i++) {
-                    // VP2 defines instance ID of the first instance to be 1.
-                    drawScene.updateInstanceTransform(*renderItem,
-                        i+1, stateToCommit._instanceTransforms[i]);
-                }
-            } else {
-                drawScene.setInstanceTransformArray(*renderItem,
-                    stateToCommit._instanceTransforms);
-            }
+        auto& instanceCount = stateToCommit._drawItemData._instanceCount;
 
-            if (stateToCommit._instanceColors.length() ==
-                newInstanceCount * kNumColorChannels) {
-                drawScene.setExtraInstanceData(*renderItem,
-                    kSolidColorStr, stateToCommit._instanceColors);
-            }
-        }
-        else if (newInstanceCount > 1) {
-            // Turn off consolidation to allow GPU instancing to be used for
-            // multiple instances.
-            setWantConsolidation(*renderItem, false);
-            drawScene.setInstanceTransformArray(*renderItem,
-                stateToCommit._instanceTransforms);
+        if (stateToCommit._instanceTransforms) {
+            const MMatrixArray& instanceTransforms = *stateToCommit._instanceTransforms;
+            instanceCount = instanceTransforms.length();
 
-            if (stateToCommit._instanceColors.length() ==
-                newInstanceCount * kNumColorChannels) {
-                drawScene.setExtraInstanceData(*renderItem,
-                    kSolidColorStr, stateToCommit._instanceColors);
+            // GPU instancing has been enabled. We cannot switch to consolidation
+            // without recreating render item, so we keep using GPU instancing.
+            if (stateToCommit._drawItemData._usingInstancedDraw) {
+                drawScene.setInstanceTransformArray(*renderItem, instanceTransforms);
+            }
+            else if (instanceCount > 1) {
+                // Turn off consolidation to allow GPU instancing to be used for
+                // multiple instances.
+                setWantConsolidation(*renderItem, false);
+                drawScene.setInstanceTransformArray(*renderItem, instanceTransforms);
+                stateToCommit._drawItemData._usingInstancedDraw = true;
+            }
+            else if (instanceCount == 1) {
+                // Special case for single instance prims. We will keep the original
+                // render item to allow consolidation.
+                renderItem->setMatrix(&instanceTransforms[0]);
             }
-
-            stateToCommit._drawItemData._usingInstancedDraw = true;
-        }
-        else if (newInstanceCount == 1) {
-            // Special case for single instance prims. We will keep the original
-            // render item to allow consolidation.
-            renderItem->setMatrix(&stateToCommit._instanceTransforms[0]);
         }
         else if (stateToCommit._worldMatrix != nullptr) {
             // Regular non-instanced prims. Consolidation has been turned on by
@@ -1452,8 +2249,152 @@ void HdVP2Mesh::_UpdateDrawItem(
             renderItem->setMatrix(stateToCommit._worldMatrix);
         }
 
-        oldInstanceCount = newInstanceCount;
-    });
+        if (stateToCommit._drawItemData._usingInstancedDraw && instanceCount > 0 &&
+            stateToCommit._instanceColors.length() == instanceCount * kNumColorChannels) {
+            drawScene.setExtraInstanceData(*renderItem,
+                kSolidColorStr, stateToCommit._instanceColors);
+        }
+
+        // Render items of instanced Rprims stay disabled while they have no
+        // instance to draw, e.g. when all instances are culled, otherwise VP2
+        // would draw them once with their last matrix.
+        if (drawItemData._instanceTransformsVersion != 0 &&
+            (stateToCommit._instanceTransforms || stateToCommit._enabled)) {
+            renderItem->enable(drawItemData._enabled && instanceCount > 0);
+        }
+
+        for (size_t i = 0; i < kBufferKindCount; i++) {
+            stats.AddCommittedBytes(static_cast<HdVP2BufferKind>(i), stateToCommit._numBytes[i]);
+        }
+
+        residency.Update(drawItem, _GetNumOwnedBytes(drawItemData));
+    }, commitBytes, _GetCommitPriority());
+}
+
+/*! \brief  Update the slot of the Rprim in the bounding box batch.
+
+    The slot is assigned on first update. Like the bounding box render item,
+    the slot maps the shared unit wire cube to the world bounds of the Rprim
+    and holds the wireframe or selection highlight color.
+*/
+void HdVP2Mesh::_UpdateBBoxBatchSlot(HdVP2DrawItem* drawItem)
+{
+    const HdDirtyBits itemDirtyBits = drawItem->GetDirtyBits();
+    if ((itemDirtyBits & (HdChangeTracker::DirtyExtent |
+                          HdChangeTracker::DirtyTransform |
+                          HdChangeTracker::DirtyVisibility |
+                          DirtySelectionHighlight)) == 0) {
+        return;
+    }
+
+    HdVP2BBoxBatch& bboxBatch = _delegate->GetBBoxBatch();
+
+    HdVP2DrawItem::RenderItemData& drawItemData = drawItem->GetRenderItemData();
+    if (drawItemData._bboxBatchSlot == HdVP2BBoxBatch::kInvalidSlot) {
+        drawItemData._bboxBatchSlot = bboxBatch.AcquireSlot(GetId());
+    }
+
+    const GfRange3d& range = _sharedData.bounds.GetRange();
+
+    MMatrix& worldMatrix = drawItemData._worldMatrix;
+    _sharedData.bounds.GetMatrix().Get(worldMatrix.matrix);
+
+    if (!range.IsEmpty()) {
+        const GfVec3d midpoint = range.GetMidpoint();
+        const GfVec3d size = range.GetSize();
+
+        MTransformationMatrix transformation;
+        transformation.setScale(size.data(), MSpace::kTransform);
+        transformation.setTranslation(midpoint.data(), MSpace::kTransform);
+        worldMatrix = transformation.asMatrix() * worldMatrix;
+    }
+
+    const bool isVisible = drawItem->GetVisible() &&
+        (_cullingResult != kCulled) && !range.IsEmpty();
+    drawItemData._enabled = isVisible;
+
+    auto* const param = static_cast<HdVP2RenderParam*>(_delegate->GetRenderParam());
+    const MColor& color = (_selectionState != kUnselected) ?
+        kSelectionHighlightColor : param->GetDrawScene().GetWireframeColor();
+
+    bboxBatch.SetInstance(drawItemData._bboxBatchSlot, worldMatrix, isVisible, color);
+
+    drawItem->ResetDirtyBits();
+}
+
+/*! \brief  Returns the priority of commit tasks of this Rprim.
+
+    All tasks of an Rprim in a frame share the same priority, so they keep
+    their relative order. Selected Rprims are committed first to get
+    selection highlight updated without delay.
+*/
+HdVP2CommitPriority HdVP2Mesh::_GetCommitPriority() const
+{
+    return (_selectionState != kUnselected) ?
+        kCommitPriorityHigh : kCommitPriorityNormal;
+}
+
+/*! \brief  Update welded vertices used instead of full vertex unsharing.
+
+    Welding is recomputed only when topology or any uniform or face-varying
+    primvar is dirty. The previous welded vertices are released from main
+    thread because they might own the last reference to VP2 index buffers.
+
+    \return True if the welded face vertex indices changed.
+*/
+bool HdVP2Mesh::_UpdateWeldedVertices(HdDirtyBits dirtyBits, bool topologyDirty)
+{
+    static const bool weldVertices =
+        TfGetEnvSetting(VP2_RENDER_DELEGATE_WELD_VERTICES);
+
+    std::shared_ptr<const HdVP2WeldedVertices> weldedVertices;
+
+    if (weldVertices && _meshSharedData._unsharedTopology) {
+        const SdfPath& id = GetId();
+
+        bool weldingDirty = topologyDirty || !_meshSharedData._weldedVertices;
+        if (!weldingDirty) {
+            for (const auto& it : _meshSharedData._primvarSourceMap) {
+                const HdInterpolation interp = it.second.interpolation;
+                if ((interp == HdInterpolationUniform ||
+                     interp == HdInterpolationFaceVarying) &&
+                    HdChangeTracker::IsPrimvarDirty(dirtyBits, id, it.first)) {
+                    weldingDirty = true;
+                    break;
+                }
+            }
+        }
+
+        if (!weldingDirty) {
+            return false;
+        }
+
+        MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
+            MProfiler::kColorC_L2, _rprimId.asChar(), "WeldVertices");
+
+        auto welded = std::make_shared<HdVP2WeldedVertices>();
+        if (_ComputeWeldedVertices(_delegate->GetMeshTopologyCache(),
+                _meshSharedData._topology, _meshSharedData._primvarSourceMap,
+                *welded)) {
+            weldedVertices = welded;
+        }
+    }
+
+    if (!weldedVertices && !_meshSharedData._weldedVertices) {
+        return false;
+    }
+
+    const bool changed = !weldedVertices || !_meshSharedData._weldedVertices ||
+        weldedVertices->_topologyData != _meshSharedData._weldedVertices->_topologyData;
+
+    _meshSharedData._weldedVertices.swap(weldedVertices);
+    if (weldedVertices) {
+        _delegate->GetVP2ResourceRegistry().EnqueueCommit(
+            [weldedVertices]() {}
+        );
+    }
+
+    return changed;
 }
 
 /*! \brief  Update _primvarSourceMap, our local cache of raw primvar data.
@@ -1562,6 +2503,35 @@ MHWRender::MRenderItem* HdVP2Mesh::_CreateBoundingBoxRenderItem(
     return renderItem;
 }
 
+/*! \brief  Create render item for lowDetail repr.
+
+    The bounding box is drawn in shaded and wireframe modes, in place of the
+    hull and wireframe of Rprims drawn with low level of detail.
+*/
+MHWRender::MRenderItem* HdVP2Mesh::_CreateLowDetailRenderItem(
+    const MString& name) const
+{
+    MHWRender::MRenderItem* const renderItem = MHWRender::MRenderItem::Create(
+        name,
+        MHWRender::MRenderItem::DecorationItem,
+        MHWRender::MGeometry::kLines
+    );
+
+    constexpr MHWRender::MGeometry::DrawMode drawMode =
+        static_cast<MHWRender::MGeometry::DrawMode>(
+            MHWRender::MGeometry::kShaded | MHWRender::MGeometry::kTextured |
+            MHWRender::MGeometry::kWireframe);
+    renderItem->setDrawMode(drawMode);
+    renderItem->castsShadows(false);
+    renderItem->receivesShadows(false);
+    renderItem->setShader(_delegate->Get3dSolidShader(kOpaqueBlue));
+    renderItem->setSelectionMask(MSelectionMask::kSelectMeshes);
+
+    setWantConsolidation(*renderItem, true);
+
+    return renderItem;
+}
+
 /*! \brief  Create render item for smoothHull repr.
 */
 MHWRender::MRenderItem* HdVP2Mesh::_CreateSmoothHullRenderItem(const MString& name) const
@@ -19,10 +19,15 @@
 
 #include "pxr/pxr.h"
 #include "pxr/imaging/hd/mesh.h"
+#include "pxr/imaging/hd/vertexAdjacency.h"
 
 #include <maya/MHWGeometry.h>
+#include <maya/MMatrixArray.h>
 
+#include "meshTopologyCache.h"
 #include "proxyRenderDelegate.h"
+#include "resource_registry.h"
+#include "vertexBufferRing.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
 
@@ -30,6 +35,32 @@ class HdSceneDelegate;
 class HdVP2DrawItem;
 class HdVP2RenderDelegate;
 
+/*! \brief  Minimal set of unique vertices used instead of full vertex unsharing.
+    \class  HdVP2WeldedVertices
+
+    When uniform or face-varying primvars require vertex unsharing, face
+    vertices with the same point and identical uniform and face-varying primvar
+    values are welded into a single vertex. Each welded vertex is filled from
+    the first face vertex referencing it.
+*/
+struct HdVP2WeldedVertices {
+    //! The face vertex each welded vertex is taken from.
+    VtIntArray _faceVertices;
+
+    //! The point each welded vertex is taken from.
+    VtIntArray _points;
+
+    //! The face each welded vertex is taken from.
+    VtIntArray _faces;
+
+    //! Data of the welded topology, whose face vertex indices reference
+    //! welded vertices.
+    HdVP2MeshTopologyDataSharedPtr _topologyData;
+
+    //! Returns the number of welded vertices.
+    size_t GetNumVertices() const { return _faceVertices.size(); }
+};
+
 /*! \brief  HdVP2Mesh-specific data shared among all its draw items.
     \class  HdVP2MeshSharedData
 
@@ -43,9 +74,16 @@ struct HdVP2MeshSharedData {
     //! copy.
     HdMeshTopology _topology;
 
+    //! Topology-dependent data shared among all Rprims with identical topology.
+    HdVP2MeshTopologyDataSharedPtr _topologyData;
+
     //! Optional topology which is computed for conversion from shared vertices
-    //! to unshared when needed.
-    std::unique_ptr<HdMeshTopology> _unsharedTopology;
+    //! to unshared when needed. Owned by _topologyData.
+    const HdMeshTopology* _unsharedTopology{ nullptr };
+
+    //! Optional welded vertices, used instead of full vertex unsharing when
+    //! vertex welding is enabled.
+    std::shared_ptr<const HdVP2WeldedVertices> _weldedVertices;
 
     //! A local cache of primvar scene data. "data" is a copy-on-write handle to
     //! the actual primvar buffer, and "interpolation" is the interpolation mode
@@ -54,14 +92,35 @@ struct HdVP2MeshSharedData {
         VtValue data;
         HdInterpolation interpolation;
     };
-    TfHashMap<TfToken, PrimvarSource, TfToken::HashFunctor> _primvarSourceMap;
+    using PrimvarSourceMap = TfHashMap<TfToken, PrimvarSource, TfToken::HashFunctor>;
+    PrimvarSourceMap _primvarSourceMap;
 
     //! A local cache of points. It is not cached in the above primvar map
     //! but a separate VtArray for easier access.
     VtVec3fArray _points;
 
-    //!< Position buffer of the Rprim to be shared among all its draw items.
-    std::unique_ptr<MHWRender::MVertexBuffer> _positionsBuffer;
+    //! Vertex adjacency used to compute smooth normals. It is reset when the
+    //! topology gets dirty and rebuilt on demand.
+    Hd_VertexAdjacencySharedPtr _adjacency;
+
+    //!< Position buffers of the Rprim to be shared among all its draw items.
+    std::unique_ptr<HdVP2VertexBufferRing> _positionsBuffer;
+
+    //! World transforms of instances, recomputed only when the instancer or
+    //! the Rprim transform changes and shared by all draw items.
+    std::shared_ptr<const MMatrixArray> _instanceTransforms;
+
+    //! Instancer version used to compute the instance transforms.
+    size_t _instancerVersion{ 0 };
+
+    //! Indices of instances passing the culling test in increasing order,
+    //! or null if all instances are drawn.
+    std::shared_ptr<const std::vector<unsigned int>> _visibleInstances;
+
+    //! Version of the drawn instances, bumped when instance transforms or
+    //! visible instances change. Compared by draw items to skip unchanged
+    //! instances.
+    size_t _instanceTransformsVersion{ 0 };
 };
 
 /*! \brief  VP2 representation of poly-mesh object.
@@ -90,6 +149,15 @@ public:
 
     HdDirtyBits GetInitialDirtyBitsMask() const override;
 
+    HdDirtyBits UpdateCulling(const ProxyRenderDelegate& drawScene);
+
+    //! \brief  Result of the last culling pass for the Rprim
+    HdVP2CullingResult GetCullingResult() const { return _cullingResult; }
+
+    size_t GetNumCulledInstances() const;
+
+    int GetInstanceIndex(int drawnInstanceIndex) const;
+
 private:
     HdDirtyBits _PropagateDirtyBits(HdDirtyBits) const override;
 
@@ -97,10 +165,25 @@ private:
 
     void _UpdateRepr(HdSceneDelegate*, const TfToken&);
 
+    void _AddRenderItem(const TfToken& reprToken, HdVP2DrawItem* drawItem,
+        MSubSceneContainer& subSceneContainer) const;
+
     void _UpdateDrawItem(
         HdSceneDelegate*, HdVP2DrawItem*,
         bool requireSmoothNormals, bool requireFlatNormals);
 
+    void _UpdateBBoxBatchSlot(HdVP2DrawItem* drawItem);
+
+    bool _UpdateWeldedVertices(HdDirtyBits dirtyBits, bool topologyDirty);
+
+    bool _UpdateVisibleInstances(const ProxyRenderDelegate& drawScene);
+
+    HdVP2CommitPriority _GetCommitPriority() const;
+
+    const TfToken& _GetReprTokenForCullingResult(const TfToken& reprToken) const;
+    bool _IsDrawItemActive(const HdVP2DrawItem& drawItem) const;
+    void _DisableInactiveDrawItems();
+
     void _UpdatePrimvarSources(
         HdSceneDelegate* sceneDelegate,
         HdDirtyBits dirtyBits,
@@ -111,6 +194,7 @@ private:
     MHWRender::MRenderItem* _CreateWireframeRenderItem(const MString& name) const;
     MHWRender::MRenderItem* _CreatePointsRenderItem(const MString& name) const;
     MHWRender::MRenderItem* _CreateBoundingBoxRenderItem(const MString& name) const;
+    MHWRender::MRenderItem* _CreateLowDetailRenderItem(const MString& name) const;
 
     //! Custom dirty bits used by this mesh
     enum DirtyBits : HdDirtyBits {
@@ -120,7 +204,8 @@ private:
         DirtyHullIndices = (DirtyIndices << 1),
         DirtyPointsIndices = (DirtyHullIndices << 1),
         DirtySelection = (DirtyPointsIndices << 1),
-        DirtySelectionHighlight = (DirtySelection << 1)
+        DirtySelectionHighlight = (DirtySelection << 1),
+        DirtyInstanceCulling = (DirtySelectionHighlight << 1)
     };
     
     HdVP2RenderDelegate* _delegate{ nullptr };          //!< VP2 render delegate for which this mesh was created
@@ -128,6 +213,9 @@ private:
     const MString        _rprimId;                      //!< Rprim id cached as a maya string for easier debugging and profiling
     HdVP2MeshSharedData  _meshSharedData;               //!< Shared data for all draw items of the Rprim
     HdVP2SelectionStatus _selectionState{ kUnselected };//!< Selection status of the Rprim
+    HdVP2CullingResult   _cullingResult{ kDrawFullDetail }; //!< Whether the Rprim is culled or drawn with low detail
+    mutable HdDirtyBits  _culledDirtyBits{ 0 };         //!< Dirty bits deferred while the Rprim is culled or drawn with low detail
+    mutable HdDirtyBits  _prefetchedBits{ 0 };          //!< Dirty bits withheld from the scene delegate since values are prefetched
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
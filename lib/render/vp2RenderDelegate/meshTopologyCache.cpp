@@ -0,0 +1,272 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "meshTopologyCache.h"
+#include "render_delegate.h"
+#include "resource_registry.h"
+
+#include "pxr/imaging/hd/meshUtil.h"
+
+#include <maya/MProfiler.h>
+
+#include <numeric>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+    //! Helper utility function to get number of edge indices
+    unsigned int _GetNumOfEdgeIndices(const HdMeshTopology& topology)
+    {
+        const VtIntArray &faceVertexCounts = topology.GetFaceVertexCounts();
+
+        unsigned int numIndex = 0;
+        for (int i = 0; i < faceVertexCounts.size(); i++)
+        {
+            numIndex += faceVertexCounts[i];
+        }
+        numIndex *= 2; // each edge has two ends.
+        return numIndex;
+    }
+
+    //! Helper utility function to extract edge indices
+    void _FillEdgeIndices(int* indices, const HdMeshTopology& topology)
+    {
+        const VtIntArray &faceVertexCounts = topology.GetFaceVertexCounts();
+        const int* currentFaceStart = topology.GetFaceVertexIndices().cdata();
+        for (int faceId = 0; faceId < faceVertexCounts.size(); faceId++)
+        {
+            int numVertexIndicesInFace = faceVertexCounts[faceId];
+            if (numVertexIndicesInFace >= 2)
+            {
+                for (int faceVertexId = 0; faceVertexId < numVertexIndicesInFace; faceVertexId++)
+                {
+                    bool isLastVertex = faceVertexId == numVertexIndicesInFace - 1;
+                    *(indices++) = *(currentFaceStart + faceVertexId);
+                    *(indices++) = isLastVertex ? *currentFaceStart : *(currentFaceStart + faceVertexId + 1);
+                }
+            }
+            currentFaceStart += numVertexIndicesInFace;
+        }
+    }
+
+    //! Helper utility function to enqueue commit of an index buffer. The
+    //! topology data is captured to keep the buffer alive until commit.
+    //! Shared index buffers are committed with high priority because draw
+    //! items of any priority can use them.
+    void _EnqueueCommit(HdVP2ResourceRegistry& registry,
+        const HdVP2MeshTopologyDataSharedPtr& topologyData,
+        MHWRender::MIndexBuffer* indexBuffer, void* bufferData, size_t numIndex)
+    {
+        HdVP2RenderStatsCounters& stats = registry.GetStatsCounters();
+        const size_t numBytes = numIndex * sizeof(int);
+        stats.AddAcquiredBytes(kBufferKindIndices, numBytes);
+
+        registry.EnqueueCommit(
+            [topologyData, indexBuffer, bufferData, &stats, numBytes]() {
+                MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
+                    MProfiler::kColorC_L2, "CommitSharedIndices");
+
+                indexBuffer->commit(bufferData);
+                stats.AddCommittedBytes(kBufferKindIndices, numBytes);
+            },
+            numBytes, kCommitPriorityHigh
+        );
+    }
+
+} // namespace
+
+/*! \brief  Constructor.
+
+    \param cache    The cache owning the data, or empty if the data is not cached
+    \param topology The topology for which the data is created
+    \param key      Key of the data in the owning cache
+*/
+HdVP2MeshTopologyData::HdVP2MeshTopologyData(
+    const std::weak_ptr<HdVP2MeshTopologyCache>& cache,
+    const HdMeshTopology& topology,
+    size_t key)
+: _cache(cache)
+, _key(key)
+, _topology(topology)
+{
+}
+
+/*! \brief  Destructor. Removes the data from the owning cache, if still alive.
+*/
+HdVP2MeshTopologyData::~HdVP2MeshTopologyData()
+{
+    if (std::shared_ptr<HdVP2MeshTopologyCache> cache = _cache.lock()) {
+        cache->_Remove(_key);
+    }
+}
+
+/*! \brief  Get the topology used for conversion from shared vertices to unshared.
+
+    The unshared topology has the same faces as the topology, with face vertex
+    indices filled with sequentially increasing values starting from 0. The
+    new face vertex indices are then implicitly used to assemble all primvar
+    vertex buffers. It is computed on first request.
+*/
+const HdMeshTopology& HdVP2MeshTopologyData::GetUnsharedTopology()
+{
+    std::call_once(_unsharedTopologyOnce, [this]() {
+        VtIntArray newFaceVtxIds;
+        newFaceVtxIds.resize(_topology.GetFaceVertexIndices().size());
+        std::iota(newFaceVtxIds.begin(), newFaceVtxIds.end(), 0);
+
+        _unsharedTopology.reset(
+            new HdMeshTopology(
+                _topology.GetScheme(),
+                _topology.GetOrientation(),
+                _topology.GetFaceVertexCounts(),
+                newFaceVtxIds,
+                _topology.GetHoleIndices(),
+                _topology.GetRefineLevel()
+            )
+        );
+    });
+
+    return *_unsharedTopology;
+}
+
+/*! \brief  Get the triangle index buffer of the topology.
+
+    The index buffer is computed and its commit is enqueued by the first call,
+    subsequent calls return the same buffer.
+
+    \param unshared Whether the indices address unshared vertices
+    \param id       Id of the requesting Rprim, used for error reporting
+    \param registry Resource registry for commit of the index buffer
+*/
+MHWRender::MIndexBuffer* HdVP2MeshTopologyData::GetTriangleIndexBuffer(
+    bool unshared, const SdfPath& id, HdVP2ResourceRegistry& registry)
+{
+    IndexBufferSlot& slot = _triangles[unshared ? 1 : 0];
+
+    std::call_once(slot._once, [&]() {
+        const HdMeshTopology& topologyToUse =
+            unshared ? GetUnsharedTopology() : _topology;
+
+        HdMeshUtil meshUtil(&topologyToUse, id);
+        VtVec3iArray trianglesFaceVertexIndices;
+        VtIntArray primitiveParam;
+        meshUtil.ComputeTriangleIndices(&trianglesFaceVertexIndices, &primitiveParam, nullptr);
+
+        const int numIndex = trianglesFaceVertexIndices.size() * 3;
+
+        slot._buffer.reset(
+            new MHWRender::MIndexBuffer(MHWRender::MGeometry::kUnsignedInt32));
+
+        void* bufferData = slot._buffer->acquire(numIndex, true);
+        if (bufferData) {
+            memcpy(bufferData, trianglesFaceVertexIndices.data(), numIndex * sizeof(int));
+            _EnqueueCommit(registry, shared_from_this(), slot._buffer.get(), bufferData, numIndex);
+        }
+    });
+
+    return slot._buffer.get();
+}
+
+/*! \brief  Get the edge index buffer of the topology.
+
+    The index buffer is computed and its commit is enqueued by the first call,
+    subsequent calls return the same buffer.
+
+    \param unshared Whether the indices address unshared vertices
+    \param id       Id of the requesting Rprim, unused
+    \param registry Resource registry for commit of the index buffer
+*/
+MHWRender::MIndexBuffer* HdVP2MeshTopologyData::GetEdgeIndexBuffer(
+    bool unshared, const SdfPath& id, HdVP2ResourceRegistry& registry)
+{
+    TF_UNUSED(id);
+
+    IndexBufferSlot& slot = _edges[unshared ? 1 : 0];
+
+    std::call_once(slot._once, [&]() {
+        const HdMeshTopology& topologyToUse =
+            unshared ? GetUnsharedTopology() : _topology;
+
+        const unsigned int numIndex = _GetNumOfEdgeIndices(topologyToUse);
+
+        slot._buffer.reset(
+            new MHWRender::MIndexBuffer(MHWRender::MGeometry::kUnsignedInt32));
+
+        void* bufferData = slot._buffer->acquire(numIndex, true);
+        if (bufferData) {
+            _FillEdgeIndices(static_cast<int*>(bufferData), topologyToUse);
+            _EnqueueCommit(registry, shared_from_this(), slot._buffer.get(), bufferData, numIndex);
+        }
+    });
+
+    return slot._buffer.get();
+}
+
+/*! \brief  Acquire the shared data for the given topology.
+
+    Rprims with identical topology get the same data. In the unlikely event
+    of a hash collision with a different live topology, an uncached data is
+    returned.
+*/
+HdVP2MeshTopologyDataSharedPtr HdVP2MeshTopologyCache::Acquire(
+    const HdMeshTopology& topology)
+{
+    const size_t key = topology.ComputeHash();
+
+    // Existing data is released out of the lock, because releasing the last
+    // handle removes the data from the cache.
+    HdVP2MeshTopologyDataSharedPtr existing;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::weak_ptr<HdVP2MeshTopologyData>& entry = _map[key];
+
+        existing = entry.lock();
+        if (!existing) {
+            HdVP2MeshTopologyDataSharedPtr data =
+                std::make_shared<HdVP2MeshTopologyData>(shared_from_this(), topology, key);
+            entry = data;
+            return data;
+        }
+    }
+
+    if (existing->GetTopology() == topology) {
+        return existing;
+    }
+
+    return std::make_shared<HdVP2MeshTopologyData>(
+        std::weak_ptr<HdVP2MeshTopologyCache>(), topology, key);
+}
+
+/*! \brief  Remove an expired entry from the cache.
+
+    The entry might have been replaced by new data for the same topology
+    after the last handle of the previous data got released, in which case
+    it is kept.
+*/
+void HdVP2MeshTopologyCache::_Remove(size_t key)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _map.find(key);
+    if (it != _map.end() && it->second.expired()) {
+        _map.erase(it);
+    }
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
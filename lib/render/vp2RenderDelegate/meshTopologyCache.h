@@ -0,0 +1,125 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef HD_VP2_MESH_TOPOLOGY_CACHE
+#define HD_VP2_MESH_TOPOLOGY_CACHE
+
+#include "pxr/pxr.h"
+#include "pxr/imaging/hd/meshTopology.h"
+#include "pxr/usd/sdf/path.h"
+
+#include <maya/MHWGeometry.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+class HdVP2MeshTopologyCache;
+class HdVP2ResourceRegistry;
+
+/*! \brief  Topology-dependent data shared by all Rprims with identical topology.
+    \class  HdVP2MeshTopologyData
+
+    Triangle and edge index buffers are computed and committed once by the
+    first draw item requesting them, and the same MIndexBuffer is then set on
+    the render items of every Rprim referencing this data. The data is owned
+    by std::shared_ptr handles acquired from HdVP2MeshTopologyCache, and the
+    last handle must be released from main thread because it deletes the
+    index buffers.
+*/
+class HdVP2MeshTopologyData final
+    : public std::enable_shared_from_this<HdVP2MeshTopologyData>
+{
+public:
+    HdVP2MeshTopologyData(const std::weak_ptr<HdVP2MeshTopologyCache>& cache,
+        const HdMeshTopology& topology, size_t key);
+
+    ~HdVP2MeshTopologyData();
+
+    /*! \brief  Get the topology for which the data was created.
+    */
+    const HdMeshTopology& GetTopology() const { return _topology; }
+
+    const HdMeshTopology& GetUnsharedTopology();
+
+    MHWRender::MIndexBuffer* GetTriangleIndexBuffer(bool unshared,
+        const SdfPath& id, HdVP2ResourceRegistry& registry);
+
+    MHWRender::MIndexBuffer* GetEdgeIndexBuffer(bool unshared,
+        const SdfPath& id, HdVP2ResourceRegistry& registry);
+
+private:
+    HdVP2MeshTopologyData(const HdVP2MeshTopologyData&) = delete;
+    HdVP2MeshTopologyData& operator=(const HdVP2MeshTopologyData&) = delete;
+
+    //! An index buffer filled and committed only once.
+    struct IndexBufferSlot {
+        std::unique_ptr<MHWRender::MIndexBuffer> _buffer;
+        std::once_flag                           _once;
+    };
+
+    const std::weak_ptr<HdVP2MeshTopologyCache> _cache; //!< Owning cache, or empty if the data is not cached
+    const size_t            _key;                   //!< Key of the data in the owning cache
+    const HdMeshTopology    _topology;              //!< Topology for which the data was created
+
+    std::unique_ptr<HdMeshTopology> _unsharedTopology;  //!< Topology used for conversion from shared vertices to unshared
+    std::once_flag                  _unsharedTopologyOnce;
+
+    IndexBufferSlot         _triangles[2];          //!< Triangle index buffers indexing shared and unshared vertices
+    IndexBufferSlot         _edges[2];              //!< Edge index buffers indexing shared and unshared vertices
+
+    friend class HdVP2MeshTopologyCache;
+};
+
+/*! \brief  Shared pointer to topology data.
+*/
+using HdVP2MeshTopologyDataSharedPtr = std::shared_ptr<HdVP2MeshTopologyData>;
+
+/*! \brief  Render-delegate-wide cache of topology-dependent data, keyed by topology hash.
+    \class  HdVP2MeshTopologyCache
+
+    The cache holds no ownership: data stays alive as long as any Rprim holds
+    a handle to it and removes itself from the cache on destruction. Data only
+    keeps a weak reference to the cache, so the cache must be owned by a
+    std::shared_ptr and data may outlive it. Call is thread safe.
+*/
+class HdVP2MeshTopologyCache final
+    : public std::enable_shared_from_this<HdVP2MeshTopologyCache>
+{
+public:
+    HdVP2MeshTopologyCache() = default;
+    ~HdVP2MeshTopologyCache() = default;
+
+    HdVP2MeshTopologyDataSharedPtr Acquire(const HdMeshTopology& topology);
+
+private:
+    HdVP2MeshTopologyCache(const HdVP2MeshTopologyCache&) = delete;
+    HdVP2MeshTopologyCache& operator=(const HdVP2MeshTopologyCache&) = delete;
+
+    void _Remove(size_t key);
+
+    //! Topology data indexed by topology hash
+    std::unordered_map<size_t, std::weak_ptr<HdVP2MeshTopologyData>> _map;
+
+    //! Synchronization used to protect the map
+    std::mutex _mutex;
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HD_VP2_MESH_TOPOLOGY_CACHE
@@ -0,0 +1,195 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef HD_VP2_PRIMVAR_FILL
+#define HD_VP2_PRIMVAR_FILL
+
+#include "pxr/pxr.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+//! Number of elements from which primvar expansion is split into parallel chunks.
+constexpr size_t kHdVP2ParallelFillThreshold = 64 * 1024;
+
+//! Number of elements processed by each parallel chunk of primvar expansion.
+constexpr size_t kHdVP2ParallelFillGrainSize = 16 * 1024;
+
+/*! \brief  Run a fill kernel over [0, count).
+
+    Large ranges are split into chunks which are processed by TBB worker
+    threads.
+*/
+template <class BODY>
+void HdVP2ParallelFill(size_t count, const BODY& body)
+{
+    if (count < kHdVP2ParallelFillThreshold) {
+        body(0, count);
+    }
+    else {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, count, kHdVP2ParallelFillGrainSize),
+            [&body](const tbb::blocked_range<size_t>& range) {
+                body(range.begin(), range.end());
+            });
+    }
+}
+
+/*! \brief  Primvar expansion kernels of HdVP2Mesh.
+    \class  HdVP2PrimvarFill
+
+    The vertex buffer is addressed as a flat float array with a compile-time
+    stride and channel offset, so that the inner loops are plain strided
+    copies which the compiler can vectorize for the target instruction set.
+    Every kernel writes exactly the same values as a scalar per-element loop
+    and can be called for any sub-range of the destination buffer.
+
+    The Fill functions fill vertices [0, numVertices) of the buffer, in
+    parallel chunks for large buffers.
+*/
+template <class DEST_TYPE, class SRC_TYPE>
+struct HdVP2PrimvarFill final
+{
+    static_assert(sizeof(DEST_TYPE) % sizeof(float) == 0,
+        "Vertex buffer element must be made of floats");
+    static_assert(sizeof(SRC_TYPE) % sizeof(float) == 0,
+        "Primvar element must be made of floats");
+
+    //! Number of floats per vertex buffer element.
+    static constexpr size_t kStride = sizeof(DEST_TYPE) / sizeof(float);
+
+    //! Write the same primvar element to vertices [begin, end).
+    static void Broadcast(float* dst, size_t begin, size_t end,
+        const SRC_TYPE& value)
+    {
+        // Local copy, so the value isn't reloaded through the aliasing
+        // destination pointer.
+        const SRC_TYPE element = value;
+        for (size_t v = begin; v < end; v++) {
+            memcpy(dst + v * kStride, &element, sizeof(SRC_TYPE));
+        }
+    }
+
+    //! Copy primvar elements [begin, end) to vertices [begin, end).
+    static void Copy(float* dst, size_t begin, size_t end,
+        const SRC_TYPE* src)
+    {
+        for (size_t v = begin; v < end; v++) {
+            memcpy(dst + v * kStride, &src[v], sizeof(SRC_TYPE));
+        }
+    }
+
+    //! Gather primvar elements indexed by indices[begin, end) to vertices
+    //! [begin, end).
+    static void Gather(float* dst, size_t begin, size_t end,
+        const SRC_TYPE* src, const int* indices)
+    {
+        for (size_t v = begin; v < end; v++) {
+            memcpy(dst + v * kStride, &src[indices[v]], sizeof(SRC_TYPE));
+        }
+    }
+
+    //! Scatter each uniform primvar element of faces [faceBegin, faceEnd)
+    //! to all face vertices of the face, starting from vertex v.
+    static void Expand(float* dst, size_t faceBegin, size_t faceEnd,
+        size_t v, const SRC_TYPE* src, const int* faceVertexCounts)
+    {
+        for (size_t f = faceBegin; f < faceEnd; f++) {
+            const size_t faceVertexEnd = v + faceVertexCounts[f];
+            Broadcast(dst, v, faceVertexEnd, src[f]);
+            v = faceVertexEnd;
+        }
+    }
+
+    //! Fill all vertices with the same primvar element.
+    static void FillConstant(DEST_TYPE* vertexBuffer, size_t numVertices,
+        size_t channelOffset, const SRC_TYPE& value)
+    {
+        float* dst = reinterpret_cast<float*>(vertexBuffer) + channelOffset;
+        HdVP2ParallelFill(numVertices, [dst, &value](size_t begin, size_t end) {
+            Broadcast(dst, begin, end, value);
+        });
+    }
+
+    //! Fill vertices by copying primvar elements with the same index.
+    static void FillCopy(DEST_TYPE* vertexBuffer, size_t numVertices,
+        size_t channelOffset, const SRC_TYPE* src)
+    {
+        if (channelOffset == 0 && sizeof(DEST_TYPE) == sizeof(SRC_TYPE)) {
+            memcpy(vertexBuffer, src, sizeof(DEST_TYPE) * numVertices);
+        }
+        else {
+            float* dst = reinterpret_cast<float*>(vertexBuffer) + channelOffset;
+            HdVP2ParallelFill(numVertices, [dst, src](size_t begin, size_t end) {
+                Copy(dst, begin, end, src);
+            });
+        }
+    }
+
+    //! Fill vertices with the primvar elements at their indices.
+    static void FillGather(DEST_TYPE* vertexBuffer, size_t numVertices,
+        size_t channelOffset, const SRC_TYPE* src, const int* indices)
+    {
+        float* dst = reinterpret_cast<float*>(vertexBuffer) + channelOffset;
+        HdVP2ParallelFill(numVertices, [dst, src, indices](size_t begin, size_t end) {
+            Gather(dst, begin, end, src, indices);
+        });
+    }
+
+    //! Fill the face vertices of each face with the uniform primvar element
+    //! of the face.
+    static void FillUniform(DEST_TYPE* vertexBuffer, size_t numVertices,
+        size_t channelOffset, const SRC_TYPE* src,
+        const int* faceVertexCounts, size_t numFaces)
+    {
+        float* dst = reinterpret_cast<float*>(vertexBuffer) + channelOffset;
+
+        if (numVertices < kHdVP2ParallelFillThreshold) {
+            Expand(dst, 0, numFaces, 0, src, faceVertexCounts);
+            return;
+        }
+
+        // Compute the first face vertex of each chunk of faces so that the
+        // chunks can be expanded independently.
+        const size_t grainSize = kHdVP2ParallelFillGrainSize;
+        const size_t numChunks = (numFaces + grainSize - 1) / grainSize;
+        std::vector<size_t> chunkFirstVertex(numChunks);
+        for (size_t f = 0, v = 0; f < numFaces; f++) {
+            if (f % grainSize == 0) {
+                chunkFirstVertex[f / grainSize] = v;
+            }
+            v += faceVertexCounts[f];
+        }
+
+        tbb::parallel_for(size_t(0), numChunks,
+            [dst, src, faceVertexCounts, numFaces, grainSize, &chunkFirstVertex](size_t chunk) {
+                const size_t faceBegin = chunk * grainSize;
+                const size_t faceEnd = std::min(faceBegin + grainSize, numFaces);
+                Expand(dst, faceBegin, faceEnd,
+                    chunkFirstVertex[chunk], src, faceVertexCounts);
+            });
+    }
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HD_VP2_PRIMVAR_FILL
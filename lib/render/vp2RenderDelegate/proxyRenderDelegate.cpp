@@ -15,10 +15,16 @@
 //
 
 #include "proxyRenderDelegate.h"
+#include "attributePrefetcher.h"
+#include "bboxGeom.h"
+#include "heldValueIndex.h"
+#include "mesh.h"
 #include "render_delegate.h"
 #include "tokens.h"
 
 #include "pxr/base/tf/diagnostic.h"
+#include "pxr/base/tf/envSetting.h"
+#include "pxr/base/tf/stopwatch.h"
 #include "pxr/base/tf/stringUtils.h"
 #include "pxr/usdImaging/usdImaging/delegate.h"
 #include "pxr/imaging/hdx/renderTask.h"
@@ -28,17 +34,28 @@
 #include "pxr/imaging/hd/mesh.h"
 #include "pxr/imaging/hd/repr.h"
 #include "pxr/imaging/hd/rprimCollection.h"
+#include "pxr/usd/usdGeom/scope.h"
+#include "pxr/usd/usdGeom/xform.h"
 
 #include "../../nodes/proxyShapeBase.h"
 #include "../../nodes/stageData.h"
 #include "../../utils/util.h"
 
+#include <maya/M3dView.h>
 #include <maya/MFileIO.h>
 #include <maya/MFnPluginData.h>
 #include <maya/MHWGeometryUtilities.h>
 #include <maya/MEventMessage.h>
 #include <maya/MProfiler.h>
 #include <maya/MSelectionContext.h>
+#include <maya/MTransformationMatrix.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
 
 #if defined(WANT_UFE_BUILD)
 #include "ufe/sceneItem.h"
@@ -46,10 +63,25 @@
 #include "ufe/globalSelection.h"
 #include "ufe/observableSelection.h"
 #include "ufe/selectionNotification.h"
+
+#include "../../ufe/UsdSceneItem.h"
 #endif
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+TF_DEFINE_ENV_SETTING(VP2_RENDER_DELEGATE_PREFETCH_ATTRIBUTES, true,
+    "Read time-varying points and normals of all dirty meshes in parallel "
+    "when the time changes, before Rprim synchronization.");
+
+TF_DEFINE_ENV_SETTING(VP2_RENDER_DELEGATE_HELD_VALUE_INDEX, true,
+    "Skip synchronization of mesh points, normals and extent whose time "
+    "samples hold their value between the previous and the new time.");
+
+TF_DEFINE_ENV_SETTING(VP2_RENDER_DELEGATE_PROGRESSIVE_SYNC_RPRIMS, 4096,
+    "Number of Rprims added to synchronization at each update of a proxy "
+    "shape whose stage is loaded in background, 0 to synchronize all Rprims "
+    "in the first update.");
+
 namespace
 {
     //! Representation selector for shaded and textured viewport mode
@@ -67,6 +99,104 @@ namespace
     //! Representation selector for selection update
     const HdReprSelector kSelectionReprSelector(HdVP2ReprTokens->selection);
 
+    //! Grain size of the parallel culling pass
+    constexpr size_t kCullingGrainSize = 256;
+
+    //! Number of subtrees above which the stage isn't split any further for
+    //! progressive synchronization
+    constexpr size_t kMinProgressiveRoots = 64;
+
+    //! Name of the render item drawing bounds of a stage being loaded
+    const MString kLoadingBoundsItemName("loadingBounds");
+
+    //! Subscene overrides of proxy shapes, accessed from main thread only
+    std::unordered_map<const MayaUsdProxyShapeBase*, ProxyRenderDelegate*> _proxyRenderDelegates;
+
+    //! Ratio of the level-of-detail pixel threshold that Rprims drawn with
+    //! low detail have to exceed to switch back, so that Rprims close to the
+    //! threshold don't switch back and forth.
+    constexpr double kLodHysteresis = 1.25;
+
+    //! Projection of bounds corners onto the viewport.
+    struct _ProjectedBounds {
+        unsigned int _outsideAll{ ~0u };    //!< Clipping planes all corners are outside of
+        bool         _crossesEyePlane{ false }; //!< Whether any corner is behind the eye
+        GfVec2d      _ndcMin{ std::numeric_limits<double>::max() };  //!< Min NDC of corners in front of the eye
+        GfVec2d      _ndcMax{ -std::numeric_limits<double>::max() }; //!< Max NDC of corners in front of the eye
+
+        //! Projected size in pixels of corners in front of the eye.
+        double GetPixelSize(const GfVec2d& viewportSize) const
+        {
+            const double width = (_ndcMax[0] - _ndcMin[0]) * 0.5 * viewportSize[0];
+            const double height = (_ndcMax[1] - _ndcMin[1]) * 0.5 * viewportSize[1];
+            return std::max(width, height);
+        }
+    };
+
+    //! Helper utility function to project the corners of local bounds with
+    //! the given world-view-projection matrix.
+    _ProjectedBounds _ProjectBounds(const GfRange3d& range,
+        const GfMatrix4d& worldViewProjMatrix)
+    {
+        _ProjectedBounds result;
+
+        for (size_t i = 0; i < 8; i++) {
+            const GfVec4d clip = GfVec4d(GfVec3d(range.GetCorner(i)), 1.0) *
+                worldViewProjMatrix;
+            const double w = clip[3];
+
+            unsigned int outside = 0;
+            if (clip[0] < -w) outside |= 1 << 0;
+            if (clip[0] >  w) outside |= 1 << 1;
+            if (clip[1] < -w) outside |= 1 << 2;
+            if (clip[1] >  w) outside |= 1 << 3;
+            if (w <= 0.0)     outside |= 1 << 4;
+            result._outsideAll &= outside;
+
+            if (w > 0.0) {
+                const GfVec2d ndc(clip[0] / w, clip[1] / w);
+                result._ndcMin = GfVec2d(std::min(result._ndcMin[0], ndc[0]),
+                    std::min(result._ndcMin[1], ndc[1]));
+                result._ndcMax = GfVec2d(std::max(result._ndcMax[0], ndc[0]),
+                    std::max(result._ndcMax[1], ndc[1]));
+            }
+            else {
+                result._crossesEyePlane = true;
+            }
+        }
+
+        return result;
+    }
+
+    //! Helper utility function to merge the selection state of an Rprim
+    //! populated from a selected root.
+    void _MergePrimSelectionState(HdSelection::PrimSelectionState& state,
+        const HdSelection::PrimSelectionState& rootState)
+    {
+        state.fullySelected |= rootState.fullySelected;
+        state.instanceIndices.insert(state.instanceIndices.end(),
+            rootState.instanceIndices.begin(), rootState.instanceIndices.end());
+    }
+
+    //! Render items are shared by all viewports, so culling against the
+    //! frustum of one viewport is only possible when it is the only one.
+    bool _IsSingleVisibleView()
+    {
+        unsigned int numVisibleViews = 0;
+
+        const unsigned int numViews = M3dView::numberOf3dViews();
+        for (unsigned int i = 0; i < numViews; i++) {
+            M3dView view;
+            if (M3dView::get3dView(i, view) && view.isVisible()) {
+                if (++numVisibleViews > 1) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
     MGlobal::ListAdjustment GetListAdjustment()
     {
         // Keyboard modifiers can be queried from QApplication::keyboardModifiers()
@@ -121,6 +251,10 @@ namespace
         // Edge desc for bbox display.
         HdMesh::ConfigureRepr(HdVP2ReprTokens->bbox, reprDescEdge);
 
+        // Edge desc for bbox drawn in place of hull and wireframe of Rprims
+        // with low level of detail.
+        HdMesh::ConfigureRepr(HdVP2ReprTokens->lowDetail, reprDescEdge);
+
         // Special token for selection update and no need to create repr. Adding
         // the empty desc to remove Hydra warning.
         HdMesh::ConfigureRepr(HdVP2ReprTokens->selection, HdMeshReprDesc());
@@ -184,10 +318,19 @@ ProxyRenderDelegate::ProxyRenderDelegate(const MObject& obj)
 
     const MFnDependencyNode fnDepNode(obj);
     _proxyShape = static_cast<MayaUsdProxyShapeBase*>(fnDepNode.userNode());
+
+    if (_proxyShape) {
+        _proxyRenderDelegates[_proxyShape] = this;
+    }
 }
 
 //! \brief  Destructor
 ProxyRenderDelegate::~ProxyRenderDelegate() {
+    auto it = _proxyRenderDelegates.find(_proxyShape);
+    if (it != _proxyRenderDelegates.end() && it->second == this) {
+        _proxyRenderDelegates.erase(it);
+    }
+
     delete _sceneDelegate;
     delete _taskController;
     delete _renderIndex;
@@ -200,6 +343,17 @@ ProxyRenderDelegate::~ProxyRenderDelegate() {
 #endif
 }
 
+/*! \brief  Find the subscene override drawing a proxy shape.
+
+    \return The subscene override, or null if the proxy shape hasn't been
+            drawn by VP2 render delegate
+*/
+const ProxyRenderDelegate* ProxyRenderDelegate::Find(const MayaUsdProxyShapeBase* proxyShape)
+{
+    auto it = _proxyRenderDelegates.find(proxyShape);
+    return (it != _proxyRenderDelegates.end()) ? it->second : nullptr;
+}
+
 //! \brief  This drawing routine supports all devices (DirectX and OpenGL)
 MHWRender::DrawAPI ProxyRenderDelegate::supportedDrawAPIs() const {
     return MHWRender::kAllDevices;
@@ -269,7 +423,15 @@ void ProxyRenderDelegate::_InitRenderDelegate() {
         _defaultCollection.reset(new HdRprimCollection());
         _defaultCollection->SetName(HdTokens->geometry);
 
-        _selection.reset(new HdSelection);
+        if (TfGetEnvSetting(VP2_RENDER_DELEGATE_PREFETCH_ATTRIBUTES)) {
+            _attributePrefetcher.reset(new HdVP2AttributePrefetcher());
+            _attributePrefetcher->SetStage(_usdStage);
+        }
+
+        if (TfGetEnvSetting(VP2_RENDER_DELEGATE_HELD_VALUE_INDEX)) {
+            _heldValueIndex.reset(new HdVP2HeldValueIndex());
+            _heldValueIndex->SetStage(_usdStage);
+        }
 
 #if defined(WANT_UFE_BUILD)
         if (!_ufeSelectionObserver) {
@@ -304,6 +466,18 @@ bool ProxyRenderDelegate::_Populate() {
     if (!_isInitialized())
         return false;
 
+    // The stage of a proxy shape loaded in background is only available
+    // once loaded.
+    if (!_usdStage) {
+        _usdStage = _proxyShape->getUsdStage();
+        if (_usdStage && _attributePrefetcher) {
+            _attributePrefetcher->SetStage(_usdStage);
+        }
+        if (_usdStage && _heldValueIndex) {
+            _heldValueIndex->SetStage(_usdStage);
+        }
+    }
+
     if (_usdStage && (!_isPopulated || _proxyShape->getExcludePrimPathsVersion() != _excludePrimPathsVersion) ) {
         MProfilingScope subProfilingScope(HdVP2RenderDelegate::sProfilerCategory,
             MProfiler::kColorD_L1, "Populate");
@@ -318,6 +492,14 @@ bool ProxyRenderDelegate::_Populate() {
         }
         
         _sceneDelegate->Populate(_usdStage->GetPseudoRoot(),excludePrimPaths);
+
+        // A stage loaded in background is synchronized over several updates
+        // so the viewport gets refreshed while large stages are uploaded.
+        if (!_isPopulated && _proxyShape->isAsyncLoadEnabled() &&
+            TfGetEnvSetting(VP2_RENDER_DELEGATE_PROGRESSIVE_SYNC_RPRIMS) > 0) {
+            _progressiveRoots = _GetProgressiveRoots();
+            _numProgressiveRoots = 0;
+        }
         
         _isPopulated = true;
         _excludePrimPathsVersion = _proxyShape->getExcludePrimPathsVersion();
@@ -336,12 +518,36 @@ void ProxyRenderDelegate::_UpdateSceneDelegate()
     MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
         MProfiler::kColorC_L1, "UpdateSceneDelegate");
 
+    bool timeChanged = false;
     {
         MProfilingScope subProfilingScope(HdVP2RenderDelegate::sProfilerCategory,
             MProfiler::kColorC_L1, "SetTime");
 
         const UsdTimeCode timeCode = _proxyShape->getTime();
-        _sceneDelegate->SetTime(timeCode);
+        timeChanged = (timeCode != _sceneDelegate->GetTime());
+
+        // Rprims whose attributes hold their value since the previous time
+        // are cleaned right after the time change.
+        if (_heldValueIndex) {
+            _renderStats._numHeldRprims =
+                _heldValueIndex->SetTime(*_renderIndex, *_sceneDelegate, timeCode);
+        }
+        else {
+            _sceneDelegate->SetTime(timeCode);
+        }
+    }
+
+    // Time-varying attributes are dirty after a time change, and read in
+    // batch before sync.
+    if (timeChanged && _attributePrefetcher) {
+        TfStopwatch stopwatch;
+        stopwatch.Start();
+
+        _renderStats._numPrefetchedRprims = _attributePrefetcher->Prefetch(
+            *_renderIndex, *_sceneDelegate, _sceneDelegate->GetTime());
+
+        stopwatch.Stop();
+        _renderStats._prefetchTimeInMs = stopwatch.GetSeconds() * 1000.0;
     }
 
     const MMatrix inclusiveMatrix = _proxyDagPath.inclusiveMatrix();
@@ -359,8 +565,10 @@ void ProxyRenderDelegate::_UpdateSceneDelegate()
             MProfiler::kColorC_L1, "SetRootVisibility");
         _sceneDelegate->SetRootVisibility(isVisible);
 
-        // Trigger selection update when a hidden proxy shape gets shown.
+        // Trigger selection update of all selected Rprims when a hidden
+        // proxy shape gets shown.
         if (isVisible) {
+            _selectionResync = true;
             SelectionChanged();
         }
     }
@@ -397,16 +605,23 @@ void ProxyRenderDelegate::_Execute(const MHWRender::MFrameContext& frameContext)
     }
     else {
         if (_selectionChanged) {
+            TfStopwatch stopwatch;
+            stopwatch.Start();
+
             _UpdateSelectionStates();
             _selectionChanged = false;
+
+            stopwatch.Stop();
+            _renderStats._selectionTimeInMs = stopwatch.GetSeconds() * 1000.0;
         }
 
         const unsigned int displayStyle = frameContext.getDisplayStyle();
 
-        // Query the wireframe color assigned to proxy shape.
-        if (displayStyle & (
+        // Query the wireframe color assigned to proxy shape, also used by
+        // bounding boxes of Rprims drawn with low detail.
+        if ((displayStyle & (
             MHWRender::MFrameContext::kBoundingBox |
-            MHWRender::MFrameContext::kWireFrame))
+            MHWRender::MFrameContext::kWireFrame)) || _lodEnabled)
         {
             _wireframeColor = MHWRender::MGeometryUtilities::wireframeColor(_proxyDagPath);
         }
@@ -434,12 +649,320 @@ void ProxyRenderDelegate::_Execute(const MHWRender::MFrameContext& frameContext)
         }
     }
 
+    bool collectionChanged = false;
+
+    if (!inSelectionPass && !_progressiveRoots.empty()) {
+        _AddProgressiveRoots();
+        collectionChanged = true;
+    }
+
     if (_defaultCollection->GetReprSelector() != reprSelector) {
         _defaultCollection->SetReprSelector(reprSelector);
+        collectionChanged = true;
+    }
+
+    if (collectionChanged) {
         _taskController->SetCollection(*_defaultCollection);
     }
 
+    // Commits deferred by the upload budget have to be executed before any
+    // Rprim gets synchronized again, because they reference its buffers.
+    auto* const renderDelegate = static_cast<HdVP2RenderDelegate*>(_renderDelegate);
+    HdVP2ResourceRegistry& registry = renderDelegate->GetVP2ResourceRegistry();
+    HdChangeTracker& changeTracker = _renderIndex->GetChangeTracker();
+    if (registry.HasPendingCommits() &&
+        changeTracker.GetSceneStateVersion() != _sceneStateVersion) {
+        registry.Flush();
+    }
+
+    // The culling pass is skipped in selection passes, whose frustum only
+    // encloses the selection region.
+    if (!inSelectionPass) {
+        _UpdateCulling(frameContext);
+    }
+
+    // Reprs used by this update keep their buffers resident. Selection
+    // passes don't count as updates, but may use the points repr.
+    HdVP2ResidencyManager& residency = renderDelegate->GetResidencyManager();
+    if (!inSelectionPass) {
+        residency.BeginUpdate();
+    }
+    for (size_t i = 0; i < HdReprSelector::MAX_TOPOLOGY_REPRS; i++) {
+        residency.MarkReprUsed(reprSelector[i]);
+    }
+    if (_lodEnabled) {
+        residency.MarkReprUsed(HdVP2ReprTokens->lowDetail);
+    }
+
+    TfStopwatch stopwatch;
+    stopwatch.Start();
+
     _engine.Execute(_renderIndex, &_dummyTasks);
+
+    stopwatch.Stop();
+
+    // Sync of Rprims is the part of the execution which isn't committed.
+    const double commitTimeInMs = renderDelegate->GetCommitTimeInMs();
+    _renderStats._commitTimeInMs = commitTimeInMs;
+    _renderStats._syncTimeInMs =
+        std::max(stopwatch.GetSeconds() * 1000.0 - commitTimeInMs, 0.0);
+
+    _sceneStateVersion = changeTracker.GetSceneStateVersion();
+
+    // Buffers of unused reprs are released once no deferred commit references
+    // them anymore.
+    if (!inSelectionPass && !registry.HasPendingCommits()) {
+        auto* const param = static_cast<HdVP2RenderParam*>(_renderDelegate->GetRenderParam());
+        if (MSubSceneContainer* container = param->GetContainer()) {
+            residency.Evict(*container);
+        }
+    }
+
+    // Request another refresh to continue with deferred commits, or to run
+    // the culling pass again with bounds updated during sync.
+    if (registry.HasPendingCommits() || _cullingInvalidated.exchange(false)) {
+        M3dView::scheduleRefreshAllViews();
+    }
+}
+
+/*! \brief  Update culling state of Rprims against the current viewport.
+
+    Rprims outside the view frustum or whose projected size is below the pixel
+    threshold of the proxy shape get their render items disabled, and skip
+    synchronization until they come back into view. Rprims whose projected
+    size is below the level-of-detail threshold are drawn with their bounding
+    box and skip synchronization of their hull until they get close. World
+    bounds of Rprims are those of their last synchronization.
+
+    Instanced Rprims are never culled as a whole, but when culling of
+    instances is enabled they only hand their visible instances to VP2.
+*/
+void ProxyRenderDelegate::_UpdateCulling(const MHWRender::MFrameContext& frameContext)
+{
+    const bool singleVisibleView = _IsSingleVisibleView();
+    const bool cullingEnabled = singleVisibleView && _proxyShape->isCullingEnabled();
+    const bool lodEnabled = singleVisibleView && _proxyShape->isLodEnabled();
+    const bool instanceCullingEnabled = singleVisibleView &&
+        _proxyShape->isInstanceCullingEnabled();
+
+    // Nothing to do if no Rprim or instance has been culled or switched to
+    // low detail.
+    if (!cullingEnabled && !_cullingEnabled && !lodEnabled && !_lodEnabled &&
+        !instanceCullingEnabled && !_instanceCullingEnabled) {
+        return;
+    }
+
+    MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
+        MProfiler::kColorC_L1, "UpdateCulling");
+
+    _cullingEnabled = cullingEnabled;
+    _lodEnabled = lodEnabled;
+    _instanceCullingEnabled = instanceCullingEnabled;
+
+    if (_cullingEnabled || _lodEnabled || _instanceCullingEnabled) {
+        MStatus status;
+        const MMatrix viewProjMatrix = frameContext.getMatrix(
+            MHWRender::MFrameContext::kViewProjMtx, &status);
+        _cullingViewProjMatrix = GfMatrix4d(viewProjMatrix.matrix);
+
+        int originX, originY, width, height;
+        frameContext.getViewportDimensions(originX, originY, width, height);
+        _cullingViewportSize = GfVec2d(width, height);
+
+        _cullingPixelThreshold = _proxyShape->getCullingPixelThreshold();
+        _lodPixelThreshold = _proxyShape->getLodPixelThreshold();
+    }
+
+    const SdfPathVector& rprimIds = _renderIndex->GetRprimIds();
+    const size_t numRprims = rprimIds.size();
+
+    // Dirty bits to mark on Rprims whose culling state has changed.
+    std::vector<HdDirtyBits> dirtyBits(numRprims, HdChangeTracker::Clean);
+    std::atomic<size_t> numVisible(0);
+    std::atomic<size_t> numCulled(0);
+    std::atomic<size_t> numLowDetail(0);
+    std::atomic<size_t> numCulledInstances(0);
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, numRprims, kCullingGrainSize),
+        [&](const tbb::blocked_range<size_t>& range) {
+            size_t numVisibleInRange = 0;
+            size_t numCulledInRange = 0;
+            size_t numLowDetailInRange = 0;
+            size_t numCulledInstancesInRange = 0;
+
+            for (size_t i = range.begin(); i < range.end(); i++) {
+                HdVP2Mesh* mesh = dynamic_cast<HdVP2Mesh*>(
+                    _renderIndex->GetRprim(rprimIds[i]));
+                if (mesh) {
+                    dirtyBits[i] = mesh->UpdateCulling(*this);
+
+                    const HdVP2CullingResult result = mesh->GetCullingResult();
+                    if (result == kCulled) {
+                        numCulledInRange++;
+                    }
+                    else if (result == kDrawLowDetail) {
+                        numLowDetailInRange++;
+                    }
+
+                    if (result != kCulled && mesh->IsVisible()) {
+                        numVisibleInRange++;
+                    }
+
+                    numCulledInstancesInRange += mesh->GetNumCulledInstances();
+                }
+            }
+
+            numVisible += numVisibleInRange;
+            numCulled += numCulledInRange;
+            numLowDetail += numLowDetailInRange;
+            numCulledInstances += numCulledInstancesInRange;
+        }
+    );
+
+    HdChangeTracker& changeTracker = _renderIndex->GetChangeTracker();
+    for (size_t i = 0; i < numRprims; i++) {
+        if (dirtyBits[i] != HdChangeTracker::Clean) {
+            changeTracker.MarkRprimDirty(rprimIds[i], dirtyBits[i]);
+        }
+    }
+
+    _cullingStats._numVisible = numVisible;
+    _cullingStats._numCulled = numCulled;
+    _cullingStats._numLowDetail = numLowDetail;
+    _cullingStats._numCulledInstances = numCulledInstances;
+}
+
+//! \brief  Split the stage into subtrees whose Rprims are synchronized progressively.
+//!
+//! Typeless, Xform and Scope prims are expanded breadth-first until there are
+//! enough subtrees, so that the Rprims of a single asset are spread over
+//! several updates.
+//!
+//! \return Root paths in render index, sorted by depth
+SdfPathVector ProxyRenderDelegate::_GetProgressiveRoots() const
+{
+    std::vector<UsdPrim> prims;
+    for (const UsdPrim& child : _usdStage->GetPseudoRoot().GetChildren()) {
+        prims.push_back(child);
+    }
+
+    bool expanded = true;
+    while (expanded && prims.size() < kMinProgressiveRoots) {
+        expanded = false;
+
+        std::vector<UsdPrim> nextPrims;
+        for (const UsdPrim& prim : prims) {
+            const bool isGroup = !prim.IsInstance() &&
+                (prim.GetTypeName().IsEmpty() || prim.IsA<UsdGeomXform>() || prim.IsA<UsdGeomScope>());
+
+            const UsdPrimSiblingRange children = prim.GetChildren();
+            if (isGroup && !children.empty()) {
+                nextPrims.insert(nextPrims.end(), children.begin(), children.end());
+                expanded = true;
+            }
+            else {
+                nextPrims.push_back(prim);
+            }
+        }
+
+        prims.swap(nextPrims);
+    }
+
+    SdfPathVector roots;
+    roots.reserve(prims.size());
+    for (const UsdPrim& prim : prims) {
+        roots.push_back(_sceneDelegate->ConvertCachePathToIndexPath(prim.GetPath()));
+    }
+
+    return roots;
+}
+
+//! \brief  Add progressive roots to the default collection until enough
+//!         Rprims are added for this update.
+//!
+//! Once all roots are added, the collection is reset to the whole render
+//! index so that Rprims outside of them, if any, are synchronized too.
+void ProxyRenderDelegate::_AddProgressiveRoots()
+{
+    MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
+        MProfiler::kColorC_L2, "AddProgressiveRoots");
+
+    const size_t maxNumRprims = static_cast<size_t>(
+        std::max(TfGetEnvSetting(VP2_RENDER_DELEGATE_PROGRESSIVE_SYNC_RPRIMS), 1));
+
+    size_t numRprims = 0;
+    while (_numProgressiveRoots < _progressiveRoots.size() && numRprims < maxNumRprims) {
+        numRprims += _renderIndex->GetRprimSubtree(_progressiveRoots[_numProgressiveRoots]).size();
+        _numProgressiveRoots++;
+    }
+
+    if (_numProgressiveRoots < _progressiveRoots.size()) {
+        _defaultCollection->SetRootPaths(SdfPathVector(_progressiveRoots.begin(),
+            _progressiveRoots.begin() + _numProgressiveRoots));
+
+        // Keep updating until all Rprims are synchronized.
+        M3dView::scheduleRefreshAllViews();
+    }
+    else {
+        _defaultCollection->SetRootPaths(SdfPathVector(1, SdfPath::AbsoluteRootPath()));
+        _progressiveRoots.clear();
+        _numProgressiveRoots = 0;
+    }
+}
+
+//! \brief  Draw the placeholder bounds of a stage loaded in background until
+//!         the render index is populated.
+void ProxyRenderDelegate::_UpdateLoadingBounds(MSubSceneContainer& container)
+{
+    MHWRender::MRenderItem* renderItem = container.find(kLoadingBoundsItemName);
+
+    const MBoundingBox bounds = (!_isPopulated && _proxyShape && _proxyShape->isStageLoading()) ?
+        _proxyShape->boundingBox() : MBoundingBox();
+
+    if (bounds.width() <= 0.0 && bounds.height() <= 0.0 && bounds.depth() <= 0.0) {
+        if (renderItem) {
+            container.remove(kLoadingBoundsItemName);
+        }
+        return;
+    }
+
+    auto* const renderDelegate = static_cast<HdVP2RenderDelegate*>(_renderDelegate);
+
+    if (!renderItem) {
+        renderItem = MHWRender::MRenderItem::Create(
+            kLoadingBoundsItemName,
+            MHWRender::MRenderItem::DecorationItem,
+            MHWRender::MGeometry::kLines);
+
+        renderItem->castsShadows(false);
+        renderItem->receivesShadows(false);
+        renderItem->setShader(renderDelegate->Get3dSolidShader(
+            MHWRender::MGeometryUtilities::wireframeColor(_proxyDagPath)));
+        container.add(renderItem);
+
+        const HdVP2BBoxGeom& sharedBBoxGeom = renderDelegate->GetSharedBBoxGeom();
+
+        MHWRender::MVertexBufferArray vertexBuffers;
+        vertexBuffers.addBuffer("positions", const_cast<MHWRender::MVertexBuffer*>(
+            sharedBBoxGeom.GetPositionBuffer()));
+
+        const GfVec3d& min = sharedBBoxGeom.GetRange().GetMin();
+        const GfVec3d& max = sharedBBoxGeom.GetRange().GetMax();
+        const MBoundingBox geomBounds(MPoint(min[0], min[1], min[2]), MPoint(max[0], max[1], max[2]));
+
+        setGeometryForRenderItem(*renderItem, vertexBuffers,
+            *const_cast<MHWRender::MIndexBuffer*>(sharedBBoxGeom.GetIndexBuffer()), &geomBounds);
+    }
+
+    // The shared unit cube is scaled and offset to the bounds.
+    const double size[3] = { bounds.width(), bounds.height(), bounds.depth() };
+    MTransformationMatrix transformation;
+    transformation.setScale(size, MSpace::kTransform);
+    transformation.setTranslation(MVector(bounds.center()), MSpace::kTransform);
+
+    const MMatrix worldMatrix = transformation.asMatrix() * _proxyDagPath.inclusiveMatrix();
+    renderItem->setMatrix(&worldMatrix);
 }
 
 //! \brief  Main update entry from subscene override.
@@ -447,8 +970,18 @@ void ProxyRenderDelegate::update(MSubSceneContainer& container, const MFrameCont
     MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
         MProfiler::kColorD_L1, "ProxyRenderDelegate::update");
 
+    TfStopwatch stopwatch;
+    stopwatch.Start();
+
     _InitRenderDelegate();
 
+    // Counters are accumulated during the update, from worker threads for
+    // most of them, and collected at the end of the update.
+    _renderStats = HdVP2RenderStats();
+    HdVP2ResourceRegistry& registry =
+        static_cast<HdVP2RenderDelegate*>(_renderDelegate)->GetVP2ResourceRegistry();
+    registry.GetStatsCounters().Reset();
+
     // Give access to current time and subscene container to the rest of render delegate world via render param's.
     auto* param = reinterpret_cast<HdVP2RenderParam*>(_renderDelegate->GetRenderParam());
     param->BeginUpdate(container, _sceneDelegate->GetTime());
@@ -457,7 +990,18 @@ void ProxyRenderDelegate::update(MSubSceneContainer& container, const MFrameCont
         _UpdateSceneDelegate();
         _Execute(frameContext);
     }
+    _UpdateLoadingBounds(container);
     param->EndUpdate();
+
+    stopwatch.Stop();
+
+    registry.GetStatsCounters().GetStats(_renderStats);
+    _renderStats._residency =
+        static_cast<HdVP2RenderDelegate*>(_renderDelegate)->GetResidencyManager().GetStats();
+    const HdVP2CommitStats& commitStats = registry.GetCommitStats();
+    _renderStats._numCommitTasks = commitStats._numTasks;
+    _renderStats._numDeferredCommitTasks = commitStats._numDeferredTasks;
+    _renderStats._updateTimeInMs = stopwatch.GetSeconds() * 1000.0;
 }
 
 //! \brief  Switch to component-level selection for point snapping.
@@ -499,13 +1043,27 @@ bool ProxyRenderDelegate::getInstancedSelectionPath(
     const auto pos = renderItemName.find_last_of(USD_UFE_SEPARATOR);
     SdfPath rprimId(renderItemName.substr(0, pos));
 
+    // Bounding boxes of non-instanced Rprims are drawn as instances of the
+    // batch render item, each instance mapping to one Rprim.
+    const int drawInstID = intersection.instanceID();
+    const HdVP2BBoxBatch& bboxBatch =
+        static_cast<HdVP2RenderDelegate*>(_renderDelegate)->GetBBoxBatch();
+    if (renderItem.name() == bboxBatch.GetRenderItemName()) {
+        rprimId = bboxBatch.GetRprimId(drawInstID - 1);
+        if (rprimId.IsEmpty())
+            return false;
+    }
     // If the selection hit comes from an instanced render item, its instance
     // transform matrices should have been sorted according to USD instance ID,
     // therefore drawInstID is usdInstID plus 1 considering VP2 defines the
-    // instance ID of the first instance as 1.
-    const int drawInstID = intersection.instanceID();
-    if (drawInstID > 0) {
-        const int usdInstID = drawInstID - 1;
+    // instance ID of the first instance as 1. Culled instances are skipped
+    // by the render item, so the Rprim maps drawn instances back to USD ones.
+    else if (drawInstID > 0) {
+        int usdInstID = drawInstID - 1;
+        if (const HdVP2Mesh* mesh = dynamic_cast<const HdVP2Mesh*>(
+                _renderIndex->GetRprim(rprimId))) {
+            usdInstID = mesh->GetInstanceIndex(usdInstID);
+        }
         rprimId = _sceneDelegate->GetPathForInstanceIndex(rprimId, usdInstID, nullptr);
     }
 
@@ -565,19 +1123,37 @@ void ProxyRenderDelegate::SelectionChanged()
     _selectionChanged = true;
 }
 
-//! \brief  Filter selection for Rprims under the proxy shape.
-void ProxyRenderDelegate::_FilterSelection()
+/*! \brief  Update selection of Rprims under the proxy shape.
+
+    The UFE global selection is converted to sorted root paths in render
+    index, and only the difference with the previously selected root paths
+    is populated or removed, so the cost of a selection change is mostly
+    proportional to the number of changed items. Root paths are taken from
+    USD scene items without string conversion when possible.
+
+    \param changedPrimPaths Receives Rprims whose selection state may have changed
+*/
+void ProxyRenderDelegate::_FilterSelection(SdfPathVector& changedPrimPaths)
 {
 #if defined(WANT_UFE_BUILD)
     if (_proxyShape == nullptr) {
         return;
     }
 
-    _selection.reset(new HdSelection);
+    // Rprims populated from the selected roots are only valid as long as no
+    // Rprim is inserted or removed.
+    const unsigned int rprimIndexVersion =
+        _renderIndex->GetChangeTracker().GetRprimIndexVersion();
+    if (_selectionRprimIndexVersion != rprimIndexVersion) {
+        _selectionRprimIndexVersion = rprimIndexVersion;
+        _ClearSelection(changedPrimPaths);
+    }
 
     const auto proxyPath = _proxyShape->ufePath();
     const auto globalSelection = Ufe::GlobalSelection::get();
 
+    SdfPathVector rootPaths;
+
     for (const Ufe::SceneItem::Ptr& item : *globalSelection) {
         if (item->runTimeId() != USD_UFE_RUNTIME_ID) {
             continue;
@@ -588,16 +1164,136 @@ void ProxyRenderDelegate::_FilterSelection()
             continue;
         }
 
-        const SdfPath usdPath(segments[1].string());
-        const SdfPath idxPath(_sceneDelegate->ConvertCachePathToIndexPath(usdPath));
+        auto usdItem = std::dynamic_pointer_cast<MayaUsd::ufe::UsdSceneItem>(item);
+        const SdfPath usdPath = (usdItem && !usdItem->primPath().IsEmpty()) ?
+            usdItem->primPath() : SdfPath(segments[1].string());
+
+        rootPaths.push_back(_sceneDelegate->ConvertCachePathToIndexPath(usdPath));
+    }
+
+    std::sort(rootPaths.begin(), rootPaths.end());
+    rootPaths.erase(std::unique(rootPaths.begin(), rootPaths.end()), rootPaths.end());
+
+    SdfPathVector deselectedPaths;
+    std::set_difference(_selectedRootPaths.begin(), _selectedRootPaths.end(),
+        rootPaths.begin(), rootPaths.end(), std::back_inserter(deselectedPaths));
+
+    SdfPathVector selectedPaths;
+    std::set_difference(rootPaths.begin(), rootPaths.end(),
+        _selectedRootPaths.begin(), _selectedRootPaths.end(), std::back_inserter(selectedPaths));
+
+    for (const SdfPath& path : deselectedPaths) {
+        _RemoveSelectedRoot(path, changedPrimPaths);
+    }
 
-        _sceneDelegate->PopulateSelection(HdSelection::HighlightModeSelect,
-            idxPath, UsdImagingDelegate::ALL_INSTANCES, _selection);
+    for (const SdfPath& path : selectedPaths) {
+        _AddSelectedRoot(path, changedPrimPaths);
     }
+
+    _selectedRootPaths.swap(rootPaths);
 #endif
 }
 
+/*! \brief  Populate selection from a newly selected root path.
+*/
+void ProxyRenderDelegate::_AddSelectedRoot(
+    const SdfPath& rootPath, SdfPathVector& changedPrimPaths)
+{
+    constexpr HdSelection::HighlightMode mode = HdSelection::HighlightModeSelect;
+
+    HdSelectionSharedPtr selection(new HdSelection);
+    _sceneDelegate->PopulateSelection(mode, rootPath,
+        UsdImagingDelegate::ALL_INSTANCES, selection);
+
+    for (const SdfPath& primPath : selection->GetSelectedPrimPaths(mode)) {
+        const HdSelection::PrimSelectionState* rootState =
+            selection->GetPrimSelectionState(mode, primPath);
+        if (!rootState) {
+            continue;
+        }
+
+        PrimSelection& primSelection = _primSelections[primPath];
+        primSelection._rootPaths.push_back(rootPath);
+        _MergePrimSelectionState(primSelection._state, *rootState);
+
+        changedPrimPaths.push_back(primPath);
+    }
+
+    _rootSelections[rootPath] = selection;
+}
+
+/*! \brief  Remove selection populated from a deselected root path.
+
+    Selection state of Rprims also populated from other selected roots is
+    merged again from these roots only.
+*/
+void ProxyRenderDelegate::_RemoveSelectedRoot(
+    const SdfPath& rootPath, SdfPathVector& changedPrimPaths)
+{
+    constexpr HdSelection::HighlightMode mode = HdSelection::HighlightModeSelect;
+
+    auto it = _rootSelections.find(rootPath);
+    if (it == _rootSelections.end()) {
+        return;
+    }
+
+    const HdSelectionSharedPtr selection = it->second;
+    _rootSelections.erase(it);
+
+    for (const SdfPath& primPath : selection->GetSelectedPrimPaths(mode)) {
+        auto primIt = _primSelections.find(primPath);
+        if (primIt == _primSelections.end()) {
+            continue;
+        }
+
+        changedPrimPaths.push_back(primPath);
+
+        SdfPathVector& rootPaths = primIt->second._rootPaths;
+        rootPaths.erase(std::remove(rootPaths.begin(), rootPaths.end(), rootPath),
+            rootPaths.end());
+
+        if (rootPaths.empty()) {
+            _primSelections.erase(primIt);
+            continue;
+        }
+
+        HdSelection::PrimSelectionState& state = primIt->second._state;
+        state = HdSelection::PrimSelectionState();
+
+        for (const SdfPath& otherRootPath : rootPaths) {
+            auto rootIt = _rootSelections.find(otherRootPath);
+            if (rootIt == _rootSelections.end()) {
+                continue;
+            }
+
+            const HdSelection::PrimSelectionState* rootState =
+                rootIt->second->GetPrimSelectionState(mode, primPath);
+            if (rootState) {
+                _MergePrimSelectionState(state, *rootState);
+            }
+        }
+    }
+}
+
+/*! \brief  Remove all selection, which is populated again from the UFE
+            global selection by next call to _FilterSelection().
+*/
+void ProxyRenderDelegate::_ClearSelection(SdfPathVector& changedPrimPaths)
+{
+    for (const auto& entry : _primSelections) {
+        changedPrimPaths.push_back(entry.first);
+    }
+
+    _primSelections.clear();
+    _rootSelections.clear();
+    _selectedRootPaths.clear();
+}
+
 /*! \brief  Notify selection change to rprims.
+
+    Only Rprims whose selection state may have changed are synchronized with
+    the selection repr, unless the proxy shape itself gets selected or
+    deselected.
 */
 void ProxyRenderDelegate::_UpdateSelectionStates()
 {
@@ -609,27 +1305,30 @@ void ProxyRenderDelegate::_UpdateSelectionStates()
     SdfPathVector rootPaths;
 
     if (_isProxySelected) {
-        rootPaths.push_back(SdfPath::AbsoluteRootPath());
+        if (!wasProxySelected || _selectionResync) {
+            rootPaths.push_back(SdfPath::AbsoluteRootPath());
+        }
     }
     else if (wasProxySelected) {
         rootPaths.push_back(SdfPath::AbsoluteRootPath());
-        _FilterSelection();
+        _FilterSelection(rootPaths);
     }
     else {
-        constexpr HdSelection::HighlightMode mode = HdSelection::HighlightModeSelect;
-
-        SdfPathVector oldPaths = _selection->GetSelectedPrimPaths(mode);
-        _FilterSelection();
-        SdfPathVector newPaths = _selection->GetSelectedPrimPaths(mode);
-
-        if (!oldPaths.empty() || !newPaths.empty()) {
-            rootPaths = std::move(oldPaths);
-            rootPaths.reserve(rootPaths.size() + newPaths.size());
-            rootPaths.insert(rootPaths.end(), newPaths.begin(), newPaths.end());
+        if (_selectionResync) {
+            for (const auto& entry : _primSelections) {
+                rootPaths.push_back(entry.first);
+            }
         }
+
+        _FilterSelection(rootPaths);
     }
 
+    _selectionResync = false;
+
     if (!rootPaths.empty()) {
+        std::sort(rootPaths.begin(), rootPaths.end());
+        rootPaths.erase(std::unique(rootPaths.begin(), rootPaths.end()), rootPaths.end());
+
         HdRprimCollection collection(HdTokens->geometry, kSelectionReprSelector);
         collection.SetRootPaths(rootPaths);
         _taskController->SetCollection(collection);
@@ -642,8 +1341,8 @@ void ProxyRenderDelegate::_UpdateSelectionStates()
 const HdSelection::PrimSelectionState*
 ProxyRenderDelegate::GetPrimSelectionState(const SdfPath& path) const
 {
-    return (_selection == nullptr) ? nullptr :
-        _selection->GetPrimSelectionState(HdSelection::HighlightModeSelect, path);
+    auto it = _primSelections.find(path);
+    return (it != _primSelections.end()) ? &it->second._state : nullptr;
 }
 
 //! \brief  Query the selection status of a given prim.
@@ -662,6 +1361,96 @@ ProxyRenderDelegate::GetPrimSelectionStatus(const SdfPath& path) const
     return state ? kPartiallySelected : kUnselected;
 }
 
+/*! \brief  Test world bounds against the frustum of the last culling pass.
+
+    Bounds are culled if all corners are outside of the same clipping plane,
+    or if their projected size is below the culling pixel threshold. They are
+    drawn with low detail if their projected size is below the level-of-detail
+    pixel threshold, which is raised when they were drawn with low detail.
+    Far plane is not tested, and bounds crossing the eye plane are never
+    culled or drawn with low detail by size.
+
+    \param bounds          World bounds of an Rprim
+    \param previousResult  Result of the previous test for the Rprim
+*/
+HdVP2CullingResult ProxyRenderDelegate::TestBounds(
+    const GfBBox3d& bounds, HdVP2CullingResult previousResult) const
+{
+    if (!_cullingEnabled && !_lodEnabled) {
+        return kDrawFullDetail;
+    }
+
+    const GfRange3d& range = bounds.GetRange();
+    if (range.IsEmpty()) {
+        return kDrawFullDetail;
+    }
+
+    const _ProjectedBounds projected = _ProjectBounds(range,
+        bounds.GetMatrix() * _cullingViewProjMatrix);
+
+    if (_cullingEnabled && projected._outsideAll != 0) {
+        return kCulled;
+    }
+
+    if (projected._crossesEyePlane) {
+        return kDrawFullDetail;
+    }
+
+    const double pixelSize = projected.GetPixelSize(_cullingViewportSize);
+
+    if (_cullingEnabled && pixelSize < _cullingPixelThreshold) {
+        return kCulled;
+    }
+
+    if (_lodEnabled) {
+        const double lodPixelThreshold = (previousResult == kDrawLowDetail) ?
+            _lodPixelThreshold * kLodHysteresis : _lodPixelThreshold;
+        if (pixelSize < lodPixelThreshold) {
+            return kDrawLowDetail;
+        }
+    }
+
+    return kDrawFullDetail;
+}
+
+/*! \brief  Test local bounds of an instance against the frustum of the last
+            culling pass.
+
+    Same tests as culling of Rprims: the instance is culled if all corners
+    are outside of the same clipping plane, or if its projected size is below
+    the culling pixel threshold. Thread safe.
+
+    \param range       Local bounds of the instanced Rprim
+    \param worldMatrix World matrix of the instance
+*/
+bool ProxyRenderDelegate::IsInstanceCulled(
+    const GfRange3d& range, const GfMatrix4d& worldMatrix) const
+{
+    if (!_instanceCullingEnabled || range.IsEmpty()) {
+        return false;
+    }
+
+    const _ProjectedBounds projected = _ProjectBounds(range,
+        worldMatrix * _cullingViewProjMatrix);
+
+    if (projected._outsideAll != 0) {
+        return true;
+    }
+
+    return !projected._crossesEyePlane &&
+        projected.GetPixelSize(_cullingViewportSize) < _cullingPixelThreshold;
+}
+
+/*! \brief  Request the culling pass to run again after the current sync.
+
+    Called by culled Rprims whose updated bounds are back in view. Thread
+    safe.
+*/
+void ProxyRenderDelegate::InvalidateCulling()
+{
+    _cullingInvalidated = true;
+}
+
 //! \brief  Query the wireframe color assigned to the proxy shape.
 const MColor& ProxyRenderDelegate::GetWireframeColor() const
 {
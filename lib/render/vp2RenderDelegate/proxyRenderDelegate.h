@@ -19,6 +19,9 @@
 
 #include "pxr/pxr.h"
 
+#include "pxr/base/gf/bbox3d.h"
+#include "pxr/base/gf/matrix4d.h"
+#include "pxr/base/gf/vec2d.h"
 #include "pxr/imaging/hd/engine.h"
 #include "pxr/imaging/hd/selection.h"
 #include "pxr/imaging/hd/task.h"
@@ -26,6 +29,7 @@
 #include "pxr/usd/usd/prim.h"
 
 #include "../../base/api.h"
+#include "renderStats.h"
 
 #include <maya/MDagPath.h>
 #include <maya/MDrawContext.h>
@@ -35,7 +39,9 @@
 #include <maya/MObject.h>
 #include <maya/MPxSubSceneOverride.h>
 
+#include <atomic>
 #include <memory>
+#include <unordered_map>
 
 #if defined(WANT_UFE_BUILD)
 #include "ufe/observer.h"
@@ -54,6 +60,8 @@ class HdRprimCollection;
 class UsdImagingDelegate;
 class MayaUsdProxyShapeBase;
 class HdxTaskController;
+class HdVP2AttributePrefetcher;
+class HdVP2HeldValueIndex;
 
 /*! \brief  Enumerations for selection status
 */
@@ -63,6 +71,23 @@ enum HdVP2SelectionStatus {
     kFullySelected     = 2  //!< The Rprim is selected (meaning fully selected for instanced Rprims)
 };
 
+/*! \brief  Result of the culling pass for an Rprim
+*/
+enum HdVP2CullingResult {
+    kDrawFullDetail = 0,    //!< The Rprim is drawn with its regular reprs
+    kDrawLowDetail  = 1,    //!< The Rprim is drawn with its bounding box instead of hull and wireframe
+    kCulled         = 2     //!< The Rprim is outside the view frustum or below the culling pixel threshold
+};
+
+/*! \brief  Counters of the culling pass.
+*/
+struct HdVP2CullingStats {
+    size_t _numVisible{ 0 };    //!< Visible meshes passing the culling tests
+    size_t _numCulled{ 0 };     //!< Rprims outside the view frustum or below the pixel threshold
+    size_t _numLowDetail{ 0 };  //!< Visible Rprims drawn with low level of detail
+    size_t _numCulledInstances{ 0 };    //!< Instances outside the view frustum or below the pixel threshold
+};
+
 /*! \brief  USD Proxy rendering routine via VP2 MPxSubSceneOverride
 
     This drawing routine leverages HdVP2RenderDelegate for synchronization
@@ -87,6 +112,9 @@ public:
     MAYAUSD_CORE_PUBLIC
     static MHWRender::MPxSubSceneOverride* Creator(const MObject& obj);
 
+    MAYAUSD_CORE_PUBLIC
+    static const ProxyRenderDelegate* Find(const MayaUsdProxyShapeBase* proxyShape);
+
     MAYAUSD_CORE_PUBLIC
     MHWRender::DrawAPI supportedDrawAPIs() const override;
 
@@ -128,6 +156,30 @@ public:
     MAYAUSD_CORE_PUBLIC
     HdVP2SelectionStatus GetPrimSelectionStatus(const SdfPath& path) const;
 
+    MAYAUSD_CORE_PUBLIC
+    HdVP2CullingResult TestBounds(const GfBBox3d& bounds,
+        HdVP2CullingResult previousResult) const;
+
+    MAYAUSD_CORE_PUBLIC
+    bool IsInstanceCulled(const GfRange3d& range, const GfMatrix4d& worldMatrix) const;
+
+    //! \brief  Whether the last culling pass enabled culling of instances
+    bool IsInstanceCullingEnabled() const { return _instanceCullingEnabled; }
+
+    MAYAUSD_CORE_PUBLIC
+    void InvalidateCulling();
+
+    //! \brief  Return counters of the last culling pass
+    MAYAUSD_CORE_PUBLIC
+    const HdVP2CullingStats& GetCullingStats() const { return _cullingStats; }
+
+    //! \brief  Return statistics of the last update
+    MAYAUSD_CORE_PUBLIC
+    const HdVP2RenderStats& GetRenderStats() const { return _renderStats; }
+
+    //! \brief  Return values of attributes prefetched for the current time, or null if disabled
+    const HdVP2AttributePrefetcher* GetAttributePrefetcher() const { return _attributePrefetcher.get(); }
+
 private:
     ProxyRenderDelegate(const ProxyRenderDelegate&) = delete;
     ProxyRenderDelegate& operator=(const ProxyRenderDelegate&) = delete;
@@ -136,10 +188,17 @@ private:
     bool _Populate();
     void _UpdateSceneDelegate();
     void _Execute(const MHWRender::MFrameContext& frameContext);
+    void _UpdateCulling(const MHWRender::MFrameContext& frameContext);
+    void _UpdateLoadingBounds(MSubSceneContainer& container);
+    SdfPathVector _GetProgressiveRoots() const;
+    void _AddProgressiveRoots();
 
     bool _isInitialized();
 
-    void _FilterSelection();
+    void _FilterSelection(SdfPathVector& changedPrimPaths);
+    void _AddSelectedRoot(const SdfPath& rootPath, SdfPathVector& changedPrimPaths);
+    void _RemoveSelectedRoot(const SdfPath& rootPath, SdfPathVector& changedPrimPaths);
+    void _ClearSelection(SdfPathVector& changedPrimPaths);
     void _UpdateSelectionStates();
 
     const MayaUsdProxyShapeBase*  _proxyShape{ nullptr }; //!< DG proxy shape node
@@ -155,17 +214,57 @@ private:
     UsdImagingDelegate* _sceneDelegate{ nullptr };  //!< USD scene delegate
 
     size_t              _excludePrimPathsVersion{ 0 }; //!< Last version of exluded prims used during render index populate
+    unsigned int        _sceneStateVersion{ 0 };    //!< Scene state version of the change tracker after last execution
 
     bool                _isPopulated{ false };      //!< If false, scene delegate wasn't populated yet within render index
     bool                _selectionChanged{ false }; //!< Whether there is any selection change or not
+    bool                _selectionResync{ false };  //!< Whether all selected Rprims need a selection update
+    unsigned int        _selectionRprimIndexVersion{ 0 };   //!< Rprim index version of the change tracker when selected roots were populated
     bool                _isProxySelected{ false };  //!< Whether the proxy shape is selected
     MColor              _wireframeColor;            //!< Wireframe color assigned to the proxy shape
 
+    bool                _cullingEnabled{ false };   //!< Whether the culling pass ran with culling enabled
+    bool                _lodEnabled{ false };       //!< Whether the culling pass ran with level of detail enabled
+    bool                _instanceCullingEnabled{ false };   //!< Whether the culling pass ran with culling of instances enabled
+    std::atomic<bool>   _cullingInvalidated{ false };   //!< Whether a culled Rprim might have moved into view during sync
+    GfMatrix4d          _cullingViewProjMatrix{ 1.0 };  //!< View-projection matrix of the culling pass
+    GfVec2d             _cullingViewportSize{ 0.0 };    //!< Viewport size in pixels of the culling pass
+    double              _cullingPixelThreshold{ 0.0 };  //!< Projected size in pixels below which Rprims are culled
+    double              _lodPixelThreshold{ 0.0 };      //!< Projected size in pixels below which Rprims are drawn with low detail
+    HdVP2CullingStats   _cullingStats;              //!< Counters of the last culling pass
+    HdVP2RenderStats    _renderStats;               //!< Statistics of the last update
+
     //! A collection of Rprims to prepare render data for specified reprs
     std::unique_ptr<HdRprimCollection> _defaultCollection;
 
-    //! A collection of Rprims being selected
-    HdSelectionSharedPtr               _selection;
+    //! Batched reads of time-varying attributes before sync
+    std::unique_ptr<HdVP2AttributePrefetcher> _attributePrefetcher;
+
+    //! Intervals over which time-varying attributes hold their value
+    std::unique_ptr<HdVP2HeldValueIndex> _heldValueIndex;
+
+    //! Root paths in render index whose Rprims are synchronized
+    //! progressively, sorted by depth
+    SdfPathVector       _progressiveRoots;
+
+    //! Number of progressive roots added to the default collection
+    size_t              _numProgressiveRoots{ 0 };
+
+    //! Selection state of a selected Rprim, merged from all selected roots
+    //! the Rprim is populated from.
+    struct PrimSelection {
+        HdSelection::PrimSelectionState _state;
+        SdfPathVector                   _rootPaths;
+    };
+
+    //! Selected root paths in render index, sorted
+    SdfPathVector                      _selectedRootPaths;
+
+    //! Selection populated from each selected root path
+    std::unordered_map<SdfPath, HdSelectionSharedPtr, SdfPath::Hash> _rootSelections;
+
+    //! Selected Rprims
+    std::unordered_map<SdfPath, PrimSelection, SdfPath::Hash> _primSelections;
 
 #if defined(WANT_UFE_BUILD)
     //! Observer for UFE global selection change
@@ -0,0 +1,154 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "renderStats.h"
+
+#include "pxr/imaging/hd/changeTracker.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+    //! Names of buffer kinds, in HdVP2BufferKind order
+    const char* const kBufferKindNames[kBufferKindCount] = {
+        "positions",
+        "normals",
+        "colors",
+        "primvars",
+        "indices",
+        "instances"
+    };
+
+    //! Names of sync categories, in HdVP2SyncCategory order
+    const char* const kSyncCategoryNames[kSyncCategoryCount] = {
+        "points",
+        "topology",
+        "transform",
+        "visibility",
+        "extent",
+        "normals",
+        "primvars",
+        "material",
+        "instancer"
+    };
+
+    //! Dirty bits of each sync category, in HdVP2SyncCategory order
+    const HdDirtyBits kSyncCategoryDirtyBits[kSyncCategoryCount] = {
+        HdChangeTracker::DirtyPoints,
+        HdChangeTracker::DirtyTopology,
+        HdChangeTracker::DirtyTransform,
+        HdChangeTracker::DirtyVisibility,
+        HdChangeTracker::DirtyExtent,
+        HdChangeTracker::DirtyNormals,
+        HdChangeTracker::DirtyPrimvar,
+        HdChangeTracker::DirtyMaterialId,
+        HdChangeTracker::DirtyInstancer | HdChangeTracker::DirtyInstanceIndex
+    };
+
+    //! Helper utility function to convert a counter to a JSON value
+    JsValue _ToJson(size_t value)
+    {
+        return JsValue(static_cast<uint64_t>(value));
+    }
+
+    //! Helper utility function to convert counters to a JSON object keyed by names
+    template <size_t N>
+    JsValue _ToJson(const size_t (&values)[N], const char* const (&names)[N])
+    {
+        JsObject object;
+        for (size_t i = 0; i < N; i++) {
+            object[names[i]] = _ToJson(values[i]);
+        }
+        return JsValue(object);
+    }
+
+} // namespace
+
+/*! \brief  Convert the statistics to a JSON object.
+*/
+JsValue HdVP2RenderStats::ToJson() const
+{
+    JsObject object;
+    object["syncedRprims"] = _ToJson(_numSyncedRprims);
+    object["syncedRprimsByCategory"] = _ToJson(_numSyncedRprimsByCategory, kSyncCategoryNames);
+    object["acquiredBytes"] = _ToJson(_numAcquiredBytes, kBufferKindNames);
+    object["committedBytes"] = _ToJson(_numCommittedBytes, kBufferKindNames);
+    object["commitTasks"] = _ToJson(_numCommitTasks);
+    object["deferredCommitTasks"] = _ToJson(_numDeferredCommitTasks);
+    object["heldRprims"] = _ToJson(_numHeldRprims);
+    object["prefetchedRprims"] = _ToJson(_numPrefetchedRprims);
+    object["prefetchTimeMs"] = JsValue(_prefetchTimeInMs);
+    object["syncTimeMs"] = JsValue(_syncTimeInMs);
+    object["commitTimeMs"] = JsValue(_commitTimeInMs);
+    object["selectionTimeMs"] = JsValue(_selectionTimeInMs);
+    object["updateTimeMs"] = JsValue(_updateTimeInMs);
+
+    JsObject residency;
+    residency["residentDrawItems"] = _ToJson(_residency._numResidentDrawItems);
+    residency["residentBytes"] = _ToJson(_residency._numResidentBytes);
+    residency["totalResidentBytes"] = _ToJson(_residency._numTotalResidentBytes);
+    residency["evictedDrawItems"] = _ToJson(_residency._numEvictedDrawItems);
+    residency["evictedBytes"] = _ToJson(_residency._numEvictedBytes);
+    residency["budgetBytes"] = _ToJson(_residency._budget);
+    object["residency"] = JsValue(residency);
+    return JsValue(object);
+}
+
+/*! \brief  Reset all counters to zero. Call from main thread before any
+            Rprim gets synchronized.
+*/
+void HdVP2RenderStatsCounters::Reset()
+{
+    _numSyncedRprims = 0;
+    for (auto& counter : _numSyncedRprimsByCategory) {
+        counter = 0;
+    }
+    for (auto& counter : _numAcquiredBytes) {
+        counter = 0;
+    }
+    for (auto& counter : _numCommittedBytes) {
+        counter = 0;
+    }
+}
+
+/*! \brief  Account a synchronized Rprim in each category of its dirty bits.
+*/
+void HdVP2RenderStatsCounters::AddSyncedRprim(HdDirtyBits dirtyBits)
+{
+    _numSyncedRprims.fetch_add(1, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < kSyncCategoryCount; i++) {
+        if (dirtyBits & kSyncCategoryDirtyBits[i]) {
+            _numSyncedRprimsByCategory[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+/*! \brief  Copy the counters to the statistics.
+*/
+void HdVP2RenderStatsCounters::GetStats(HdVP2RenderStats& stats) const
+{
+    stats._numSyncedRprims = _numSyncedRprims;
+    for (size_t i = 0; i < kSyncCategoryCount; i++) {
+        stats._numSyncedRprimsByCategory[i] = _numSyncedRprimsByCategory[i];
+    }
+    for (size_t i = 0; i < kBufferKindCount; i++) {
+        stats._numAcquiredBytes[i] = _numAcquiredBytes[i];
+        stats._numCommittedBytes[i] = _numCommittedBytes[i];
+    }
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
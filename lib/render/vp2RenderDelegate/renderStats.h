@@ -0,0 +1,115 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HD_VP2_RENDER_STATS
+#define HD_VP2_RENDER_STATS
+
+#include "pxr/pxr.h"
+#include "pxr/base/js/value.h"
+#include "pxr/imaging/hd/types.h"
+
+#include "residencyManager.h"
+
+#include "../../base/api.h"
+
+#include <atomic>
+#include <cstddef>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/*! \brief  Kinds of GPU buffers accounted in render statistics.
+*/
+enum HdVP2BufferKind {
+    kBufferKindPositions = 0,   //!< Vertex positions
+    kBufferKindNormals,         //!< Vertex normals
+    kBufferKindColors,          //!< Vertex colors
+    kBufferKindPrimvars,        //!< Other vertex primvars
+    kBufferKindIndices,         //!< Index buffers
+    kBufferKindInstances,       //!< Instance transforms and colors
+    kBufferKindCount
+};
+
+/*! \brief  Categories of dirty bits accounted for synchronized Rprims.
+*/
+enum HdVP2SyncCategory {
+    kSyncCategoryPoints = 0,    //!< Points primvar
+    kSyncCategoryTopology,      //!< Topology
+    kSyncCategoryTransform,     //!< Transform
+    kSyncCategoryVisibility,    //!< Visibility
+    kSyncCategoryExtent,        //!< Extent
+    kSyncCategoryNormals,       //!< Normals primvar
+    kSyncCategoryPrimvars,      //!< Other primvars
+    kSyncCategoryMaterial,      //!< Material binding
+    kSyncCategoryInstancer,     //!< Instancer or instance indices
+    kSyncCategoryCount
+};
+
+/*! \brief  Statistics of one update of a proxy shape.
+*/
+struct HdVP2RenderStats {
+    size_t _numSyncedRprims{ 0 };                               //!< Rprims synchronized
+    size_t _numSyncedRprimsByCategory[kSyncCategoryCount]{};    //!< Rprims synchronized, by dirty category
+    size_t _numAcquiredBytes[kBufferKindCount]{};               //!< Bytes of buffers acquired for update, by kind
+    size_t _numCommittedBytes[kBufferKindCount]{};              //!< Bytes of buffers committed to VP2, by kind
+    size_t _numCommitTasks{ 0 };                                //!< Commit tasks executed
+    size_t _numDeferredCommitTasks{ 0 };                        //!< Commit tasks deferred to the next updates
+    size_t _numHeldRprims{ 0 };                                 //!< Rprims cleaned after the time change since their values are held
+    size_t _numPrefetchedRprims{ 0 };                           //!< Rprims with attribute values prefetched before sync
+    double _prefetchTimeInMs{ 0.0 };                            //!< Time spent in attribute prefetch
+    double _syncTimeInMs{ 0.0 };                                //!< Time spent in Rprim synchronization
+    double _commitTimeInMs{ 0.0 };                              //!< Time spent in CommitResources
+    double _selectionTimeInMs{ 0.0 };                           //!< Time spent in selection update
+    double _updateTimeInMs{ 0.0 };                              //!< Time spent in the whole update
+    HdVP2ResidencyStats _residency;                             //!< Residency of draw item buffers after the update
+
+    MAYAUSD_CORE_PUBLIC
+    JsValue ToJson() const;
+};
+
+/*! \brief  Counters accumulated during an update. All methods but Reset()
+            are thread safe.
+*/
+class HdVP2RenderStatsCounters
+{
+public:
+    MAYAUSD_CORE_PUBLIC
+    void Reset();
+
+    MAYAUSD_CORE_PUBLIC
+    void AddSyncedRprim(HdDirtyBits dirtyBits);
+
+    //! Account bytes of a buffer acquired for update
+    void AddAcquiredBytes(HdVP2BufferKind kind, size_t numBytes) {
+        _numAcquiredBytes[kind].fetch_add(numBytes, std::memory_order_relaxed);
+    }
+
+    //! Account bytes of a buffer committed to VP2
+    void AddCommittedBytes(HdVP2BufferKind kind, size_t numBytes) {
+        _numCommittedBytes[kind].fetch_add(numBytes, std::memory_order_relaxed);
+    }
+
+    MAYAUSD_CORE_PUBLIC
+    void GetStats(HdVP2RenderStats& stats) const;
+
+private:
+    std::atomic<size_t> _numSyncedRprims{ 0 };
+    std::atomic<size_t> _numSyncedRprimsByCategory[kSyncCategoryCount]{};
+    std::atomic<size_t> _numAcquiredBytes[kBufferKindCount]{};
+    std::atomic<size_t> _numCommittedBytes[kBufferKindCount]{};
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HD_VP2_RENDER_STATS
@@ -0,0 +1,111 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "renderStatsCommand.h"
+#include "proxyRenderDelegate.h"
+
+#include "pxr/base/js/json.h"
+
+#include "../../nodes/proxyShapeBase.h"
+
+#include <maya/MArgDatabase.h>
+#include <maya/MDagPath.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MSelectionList.h>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+    //! Helper utility function to convert a counter to a JSON value
+    JsValue _ToJson(size_t value)
+    {
+        return JsValue(static_cast<uint64_t>(value));
+    }
+
+} // namespace
+
+//! \brief  Name of the command
+const MString HdVP2RenderStatsCommand::commandName("mayaUsdRenderStats");
+
+//! \brief  Syntax taking a proxy shape, the selected one by default
+MSyntax HdVP2RenderStatsCommand::createSyntax()
+{
+    MSyntax syntax;
+    syntax.setObjectType(MSyntax::kSelectionList, 1, 1);
+    syntax.useSelectionAsDefault(true);
+
+    syntax.enableQuery(false);
+    syntax.enableEdit(false);
+
+    return syntax;
+}
+
+//! \brief  Factory method registered at plugin load
+void* HdVP2RenderStatsCommand::creator()
+{
+    return new HdVP2RenderStatsCommand();
+}
+
+//! \brief  Return statistics of the proxy shape as a JSON string
+MStatus HdVP2RenderStatsCommand::doIt(const MArgList& args)
+{
+    MStatus status;
+    MArgDatabase argData(syntax(), args, &status);
+    if (!status) {
+        return status;
+    }
+
+    MSelectionList objects;
+    argData.getObjects(objects);
+
+    MDagPath dagPath;
+    status = objects.getDagPath(0, dagPath);
+    if (status) {
+        dagPath.extendToShape();
+    }
+
+    const MFnDependencyNode fnDepNode(dagPath.node(), &status);
+    const auto* proxyShape = status ?
+        dynamic_cast<const MayaUsdProxyShapeBase*>(fnDepNode.userNode()) : nullptr;
+    if (!proxyShape) {
+        displayError("A USD proxy shape is expected.");
+        return MS::kInvalidParameter;
+    }
+
+    const ProxyRenderDelegate* drawScene = ProxyRenderDelegate::Find(proxyShape);
+    if (!drawScene) {
+        displayError(MString("The proxy shape ") + dagPath.partialPathName() +
+            " has not been drawn by VP2 render delegate.");
+        return MS::kFailure;
+    }
+
+    JsObject object = drawScene->GetRenderStats().ToJson().GetJsObject();
+
+    const HdVP2CullingStats& cullingStats = drawScene->GetCullingStats();
+    JsObject culling;
+    culling["visibleRprims"] = _ToJson(cullingStats._numVisible);
+    culling["culledRprims"] = _ToJson(cullingStats._numCulled);
+    culling["lowDetailRprims"] = _ToJson(cullingStats._numLowDetail);
+    culling["culledInstances"] = _ToJson(cullingStats._numCulledInstances);
+    object["culling"] = JsValue(culling);
+
+    setResult(MString(JsWriteToString(JsValue(object)).c_str()));
+
+    return MS::kSuccess;
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
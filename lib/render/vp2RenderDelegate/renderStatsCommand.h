@@ -0,0 +1,59 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HD_VP2_RENDER_STATS_COMMAND
+#define HD_VP2_RENDER_STATS_COMMAND
+
+#include "pxr/pxr.h"
+
+#include "../../base/api.h"
+
+#include <maya/MPxCommand.h>
+#include <maya/MString.h>
+#include <maya/MSyntax.h>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/*! \brief  Query statistics of the last VP2 update of a proxy shape.
+    \class  HdVP2RenderStatsCommand
+
+    The command takes a proxy shape, or its transform, and returns a JSON
+    string with the statistics of the last update of the proxy shape by
+    VP2 render delegate, and the counters of its last culling pass:
+
+        import json
+        stats = json.loads(cmds.mayaUsdRenderStats('stageShape1'))
+*/
+class HdVP2RenderStatsCommand : public MPxCommand
+{
+public:
+    MAYAUSD_CORE_PUBLIC
+    static const MString commandName;
+
+    MAYAUSD_CORE_PUBLIC
+    static MSyntax createSyntax();
+
+    MAYAUSD_CORE_PUBLIC
+    static void* creator();
+
+    MAYAUSD_CORE_PUBLIC
+    MStatus doIt(const MArgList& args) override;
+
+    bool isUndoable() const override { return false; }
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HD_VP2_RENDER_STATS_COMMAND
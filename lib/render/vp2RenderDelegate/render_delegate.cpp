@@ -23,6 +23,7 @@
 #include "render_pass.h"
 #include "instancer.h"
 
+#include "pxr/base/tf/stopwatch.h"
 #include "pxr/imaging/hd/bprim.h"
 #include "pxr/imaging/hd/camera.h"
 #include "pxr/imaging/hd/instancer.h"
@@ -30,14 +31,15 @@
 #include "pxr/imaging/hd/rprim.h"
 #include "pxr/imaging/hd/tokens.h"
 
+#include <maya/M3dView.h>
 #include <maya/MProfiler.h>
 
-#include <unordered_map>
-
-#include "tbb/spin_rw_mutex.h"
-#include <tbb/reader_writer_lock.h>
+#include <tbb/concurrent_unordered_map.h>
 #include <boost/functional/hash.hpp>
 
+#include <cstdint>
+#include <cstring>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
 namespace
@@ -70,30 +72,56 @@ namespace
     const MString _fallbackShaderName        = "FallbackShader";  //!< Name of the fallback shader
     const MString _structOutputName          = "outSurfaceFinal"; //!< Output struct name of the fallback shader
 
-    /*! \brief  Color hash helper class, used by shader registry
+    /*! \brief  Key of a color, used by shader registry.
+
+        Channels are compared by their float bits, so that every distinct
+        color gets its own shader.
     */
-    struct MColorHash
+    struct _ColorKey
     {
-        std::size_t operator()(const MColor& color) const
+        uint32_t _bits[4];  //!< Bits of the r, g, b and a channels
+
+        explicit _ColorKey(const MColor& color)
+        {
+            memcpy(&_bits[0], &color.r, sizeof(float));
+            memcpy(&_bits[1], &color.g, sizeof(float));
+            memcpy(&_bits[2], &color.b, sizeof(float));
+            memcpy(&_bits[3], &color.a, sizeof(float));
+        }
+
+        bool operator==(const _ColorKey& other) const
+        {
+            return memcmp(_bits, other._bits, sizeof(_bits)) == 0;
+        }
+    };
+
+    /*! \brief  Color key hash helper class, used by shader registry
+    */
+    struct _ColorKeyHash
+    {
+        std::size_t operator()(const _ColorKey& key) const
         {
             std::size_t seed = 0;
-            boost::hash_combine(seed, color.r);
-            boost::hash_combine(seed, color.g);
-            boost::hash_combine(seed, color.b);
-            boost::hash_combine(seed, color.a);
+            for (const uint32_t bits : key._bits) {
+                boost::hash_combine(seed, bits);
+            }
             return seed;
         }
     };
 
     /*! \brief  Color-indexed shader map.
+
+        Lookups are lock-free so Sync threads never wait for the creation of
+        a shader for another color. Creations are serialized because shader
+        manager is not thread safe.
     */
     struct MShaderMap
     {
-        //! Shader registry
-        std::unordered_map<MColor, MHWRender::MShaderInstance*, MColorHash> _map;
+        //! Shader registry, indexed by color key
+        tbb::concurrent_unordered_map<_ColorKey, MHWRender::MShaderInstance*, _ColorKeyHash> _map;
 
-        //! Synchronization used to protect concurrent read from serial writes
-        tbb::spin_rw_mutex _mutex;
+        //! Synchronization used to serialize creation of shaders
+        std::mutex _mutex;
     };
 
     /*! \brief  Shader cache.
@@ -149,41 +177,18 @@ namespace
         */
         MHWRender::MShaderInstance* Get3dSolidShader(const MColor& color)
         {
-            // Look for it first with reader lock
-            tbb::spin_rw_mutex::scoped_lock lock(_3dSolidShaders._mutex, false/*write*/);
-            auto it = _3dSolidShaders._map.find(color);
-            if (it != _3dSolidShaders._map.end()) {
-                return it->second;
-            }
-
-            // Upgrade to writer lock.
-            lock.upgrade_to_writer();
-
-            // Double check that it wasn't inserted by another thread
-            it = _3dSolidShaders._map.find(color);
-            if (it != _3dSolidShaders._map.end()) {
-                return it->second;
-            }
-
-            MHWRender::MShaderInstance* shader = nullptr;
-
-            MHWRender::MRenderer* renderer = MHWRender::MRenderer::theRenderer();
-            const MHWRender::MShaderManager* shaderMgr =
-                renderer ? renderer->getShaderManager() : nullptr;
-            if (TF_VERIFY(shaderMgr)) {
-                shader = shaderMgr->getStockShader(
-                    MHWRender::MShaderManager::k3dSolidShader);
-
-                if (TF_VERIFY(shader)) {
-                    const float solidColor[] = { color.r, color.g, color.b, color.a };
-                    shader->setParameter(_solidColorParameterName, solidColor);
-
-                    // Insert instance we just created
-                    _3dSolidShaders._map[color] = shader;
-                }
-            }
-
-            return shader;
+            return _FindOrCreate(_3dSolidShaders, color,
+                [&color](const MHWRender::MShaderManager* shaderMgr) {
+                    MHWRender::MShaderInstance* shader = shaderMgr->getStockShader(
+                        MHWRender::MShaderManager::k3dSolidShader);
+
+                    if (TF_VERIFY(shader)) {
+                        const float solidColor[] = { color.r, color.g, color.b, color.a };
+                        shader->setParameter(_solidColorParameterName, solidColor);
+                    }
+
+                    return shader;
+                });
         }
 
         /*! \brief  Returns a fallback shader instance when no material is bound.
@@ -198,19 +203,45 @@ namespace
         */
         MHWRender::MShaderInstance* GetFallbackShader(const MColor& color)
         {
-            // Look for it first with reader lock
-            tbb::spin_rw_mutex::scoped_lock lock(_fallbackShaders._mutex, false/*write*/);
-            auto it = _fallbackShaders._map.find(color);
-            if (it != _fallbackShaders._map.end()) {
+            return _FindOrCreate(_fallbackShaders, color,
+                [&color](const MHWRender::MShaderManager* shaderMgr) {
+                    MHWRender::MShaderInstance* shader = shaderMgr->getFragmentShader(
+                        _fallbackShaderName, _structOutputName, true);
+
+                    if (TF_VERIFY(shader)) {
+                        float diffuseColor[] = { color.r, color.g, color.b, color.a };
+                        shader->setParameter(_diffuseColorParameterName, diffuseColor);
+                    }
+
+                    return shader;
+                });
+        }
+
+    private:
+        /*! \brief  Returns the shader of the color from the map, created on
+                    first request.
+
+            \param shaders  Shader map to look into
+            \param color    Color of the shader
+            \param create   Function creating the shader with a shader manager
+        */
+        template <class CREATE>
+        MHWRender::MShaderInstance* _FindOrCreate(
+            MShaderMap& shaders, const MColor& color, const CREATE& create)
+        {
+            const _ColorKey key(color);
+
+            // Lock-free lookup
+            auto it = shaders._map.find(key);
+            if (it != shaders._map.end()) {
                 return it->second;
             }
 
-            // Upgrade to writer lock.
-            lock.upgrade_to_writer();
+            std::lock_guard<std::mutex> lock(shaders._mutex);
 
             // Double check that it wasn't inserted by another thread
-            it = _fallbackShaders._map.find(color);
-            if (it != _fallbackShaders._map.end()) {
+            it = shaders._map.find(key);
+            if (it != shaders._map.end()) {
                 return it->second;
             }
 
@@ -220,22 +251,17 @@ namespace
             const MHWRender::MShaderManager* shaderMgr =
                 renderer ? renderer->getShaderManager() : nullptr;
             if (TF_VERIFY(shaderMgr)) {
-                shader = shaderMgr->getFragmentShader(_fallbackShaderName,
-                    _structOutputName, true);
-
-                if (TF_VERIFY(shader)) {
-                    float diffuseColor[] = { color.r, color.g, color.b, color.a };
-                    shader->setParameter(_diffuseColorParameterName, diffuseColor);
+                shader = create(shaderMgr);
 
-                    // Insert instance we just created
-                    _fallbackShaders._map[color] = shader;
+                // Insert instance we just created
+                if (shader) {
+                    shaders._map.emplace(key, shader);
                 }
             }
 
             return shader;
         }
 
-    private:
         bool                    _isInitialized { false };  //!< Whether the shader cache is initialized
 
         MShaderMap              _fallbackShaders;          //!< Shader registry used by fallback shaders
@@ -301,7 +327,8 @@ namespace
         }
     };
 
-    using MSamplerStateCache = std::unordered_map<
+    //! Sampler state cache, with lock-free lookups
+    using MSamplerStateCache = tbb::concurrent_unordered_map<
         MHWRender::MSamplerStateDesc,
         const MHWRender::MSamplerState*,
         MSamplerStateDescHash,
@@ -309,7 +336,7 @@ namespace
     >;
 
     MSamplerStateCache sSamplerStates;  //!< Sampler state cache
-    tbb::spin_rw_mutex sSamplerRWMutex; //!< Synchronization used to protect concurrent read from serial writes
+    std::mutex sSamplerMutex;           //!< Synchronization used to serialize creation of sampler states
 
     const HdVP2BBoxGeom* sSharedBBoxGeom = nullptr; //!< Shared geometry for all Rprims to display bounding box
 
@@ -346,6 +373,7 @@ HdVP2RenderDelegate::HdVP2RenderDelegate(ProxyRenderDelegate& drawScene) {
     }
 
     _renderParam.reset(new HdVP2RenderParam(drawScene));
+    _meshTopologyCache = std::make_shared<HdVP2MeshTopologyCache>();
 
     // The shader cache should be initialized after mayaUsd loads shader fragments.
     sShaderCache.Initialize();
@@ -354,6 +382,10 @@ HdVP2RenderDelegate::HdVP2RenderDelegate(ProxyRenderDelegate& drawScene) {
 /*! \brief  Destructor.
 */
 HdVP2RenderDelegate::~HdVP2RenderDelegate() {
+    if (_renderParam && _renderParam->GetContainer()) {
+        _bboxBatch.RemoveRenderItem(*_renderParam->GetContainer());
+    }
+
     std::lock_guard<std::mutex> guard(_renderDelegateMutex);
     if (_renderDelegateCounter.fetch_sub(1) == 1) {
         _resourceRegistry.reset();
@@ -386,6 +418,9 @@ void HdVP2RenderDelegate::CommitResources(HdChangeTracker* tracker) {
 
     MProfilingScope profilingScope(sProfilerCategory, MProfiler::kColorC_L2, "Commit resources");
 
+    TfStopwatch stopwatch;
+    stopwatch.Start();
+
     // --------------------------------------------------------------------- //
     // RESOLVE, COMPUTE & COMMIT PHASE
     // --------------------------------------------------------------------- //
@@ -396,6 +431,60 @@ void HdVP2RenderDelegate::CommitResources(HdChangeTracker* tracker) {
     //     3) Update any scene-level acceleration structures.
 
     _resourceRegistryVP2.Commit();
+
+    // Bounding boxes of Rprims are drawn by a single instanced render item,
+    // updated once all Rprims have set their slot.
+    if (MSubSceneContainer* container = _renderParam->GetContainer()) {
+        _bboxBatch.Commit(*container, _renderParam->GetDrawScene(), *this);
+    }
+
+    _UpdatePendingTextures();
+
+    stopwatch.Stop();
+    _commitTimeInMs = stopwatch.GetSeconds() * 1000.0;
+}
+
+/*! \brief  Replace placeholder textures of materials whose images finished decoding.
+
+    Viewport refresh is requested until all textures are decoded.
+*/
+void HdVP2RenderDelegate::_UpdatePendingTextures() {
+    std::lock_guard<std::mutex> lock(_pendingTexturesMutex);
+
+    if (_materialsWithPendingTextures.empty()) {
+        return;
+    }
+
+    MProfilingScope profilingScope(sProfilerCategory,
+        MProfiler::kColorC_L2, "Update pending textures");
+
+    auto it = _materialsWithPendingTextures.begin();
+    while (it != _materialsWithPendingTextures.end()) {
+        if ((*it)->UpdatePendingTextures()) {
+            ++it;
+        }
+        else {
+            it = _materialsWithPendingTextures.erase(it);
+        }
+    }
+
+    if (!_materialsWithPendingTextures.empty()) {
+        M3dView::scheduleRefreshAllViews();
+    }
+}
+
+/*! \brief  Register a material drawing with placeholder textures. Call is thread safe.
+*/
+void HdVP2RenderDelegate::AddMaterialWithPendingTextures(HdVP2Material* material) {
+    std::lock_guard<std::mutex> lock(_pendingTexturesMutex);
+    _materialsWithPendingTextures.insert(material);
+}
+
+/*! \brief  Unregister a material, e.g. when it gets destroyed. Call is thread safe.
+*/
+void HdVP2RenderDelegate::RemoveMaterialWithPendingTextures(HdVP2Material* material) {
+    std::lock_guard<std::mutex> lock(_pendingTexturesMutex);
+    _materialsWithPendingTextures.erase(material);
 }
 
 /*! \brief  Return a list of which Rprim types can be created by this class's.
@@ -428,6 +517,12 @@ HdVP2ResourceRegistry& HdVP2RenderDelegate::GetVP2ResourceRegistry() {
     return _resourceRegistryVP2;
 }
 
+/*! \brief  Return mesh topology cache, holding topology-dependent data shared among Rprims.
+*/
+HdVP2MeshTopologyCache& HdVP2RenderDelegate::GetMeshTopologyCache() {
+    return *_meshTopologyCache;
+}
+
 /*! \brief  Create a renderpass for rendering a given collection.
 */
 HdRenderPassSharedPtr HdVP2RenderDelegate::CreateRenderPass(HdRenderIndex* index, const HdRprimCollection& collection) {
@@ -475,9 +570,27 @@ HdRprim* HdVP2RenderDelegate::CreateRprim(
     return nullptr;
 }
 
+/*! \brief  Execute or discard commit tasks deferred by the upload budget.
+
+    Deferred tasks might reference a prim about to be deleted. They are
+    executed if the render item container is available, otherwise the
+    render index is being torn down and they are discarded.
+*/
+void HdVP2RenderDelegate::_FlushPendingCommits() {
+    if (_resourceRegistryVP2.HasPendingCommits()) {
+        if (_renderParam && _renderParam->GetContainer()) {
+            _resourceRegistryVP2.Flush();
+        }
+        else {
+            _resourceRegistryVP2.Discard();
+        }
+    }
+}
+
 /*! \brief  Destroy & deallocate Rprim instance
 */
 void HdVP2RenderDelegate::DestroyRprim(HdRprim* rPrim) {
+    _FlushPendingCommits();
     delete rPrim;
 }
 
@@ -563,6 +676,7 @@ HdSprim* HdVP2RenderDelegate::CreateFallbackSprim(const TfToken& typeId) {
 /*! \brief  Destroy & deallocate Sprim instance
 */
 void HdVP2RenderDelegate::DestroySprim(HdSprim* sPrim) {
+    _FlushPendingCommits();
     delete sPrim;
 }
 
@@ -679,16 +793,13 @@ MHWRender::MShaderInstance* HdVP2RenderDelegate::Get3dFatPointShader() const
 const MHWRender::MSamplerState* HdVP2RenderDelegate::GetSamplerState(
     const MHWRender::MSamplerStateDesc& desc) const
 {
-    // Look for it first with reader lock
-    tbb::spin_rw_mutex::scoped_lock lock(sSamplerRWMutex, false/*write*/);
-
+    // Lock-free lookup
     auto it = sSamplerStates.find(desc);
     if (it != sSamplerStates.end()) {
         return it->second;
     }
 
-    // Upgrade to writer lock.
-    lock.upgrade_to_writer();
+    std::lock_guard<std::mutex> lock(sSamplerMutex);
 
     // Double check that it wasn't inserted by another thread
     it = sSamplerStates.find(desc);
@@ -699,7 +810,7 @@ const MHWRender::MSamplerState* HdVP2RenderDelegate::GetSamplerState(
     // Create and cache.
     const MHWRender::MSamplerState* samplerState =
         MHWRender::MStateManager::acquireSamplerState(desc);
-    sSamplerStates[desc] = samplerState;
+    sSamplerStates.emplace(desc, samplerState);
     return samplerState;
 }
 
@@ -21,7 +21,10 @@
 #include "pxr/imaging/hd/renderDelegate.h"
 #include "pxr/imaging/hd/resourceRegistry.h"
 
+#include "bboxBatch.h"
+#include "meshTopologyCache.h"
 #include "render_param.h"
+#include "residencyManager.h"
 #include "resource_registry.h"
 
 #include <maya/MString.h>
@@ -29,10 +32,12 @@
 
 #include <mutex>
 #include <atomic>
+#include <unordered_set>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
 class HdVP2BBoxGeom;
+class HdVP2Material;
 class ProxyRenderDelegate;
 
 /*! \brief    VP2 render delegate
@@ -84,6 +89,8 @@ public:
 
     HdVP2ResourceRegistry& GetVP2ResourceRegistry();
 
+    HdVP2MeshTopologyCache& GetMeshTopologyCache();
+
     HdRenderPassSharedPtr CreateRenderPass(HdRenderIndex* index, HdRprimCollection const& collection) override;
 
     HdInstancer* CreateInstancer(HdSceneDelegate* delegate, SdfPath const& id, SdfPath const& instancerId) override;    
@@ -116,19 +123,41 @@ public:
 
     const HdVP2BBoxGeom& GetSharedBBoxGeom() const;
 
+    //! \brief  Return the batch drawing bounding boxes of Rprims
+    HdVP2BBoxBatch& GetBBoxBatch() { return _bboxBatch; }
+
+    //! \brief  Return the residency manager of buffers owned by draw items
+    HdVP2ResidencyManager& GetResidencyManager() { return _residencyManager; }
+
+    //! \brief  Return time spent in the last CommitResources, in milliseconds
+    double GetCommitTimeInMs() const { return _commitTimeInMs; }
+
+    void AddMaterialWithPendingTextures(HdVP2Material* material);
+    void RemoveMaterialWithPendingTextures(HdVP2Material* material);
+
     static const int sProfilerCategory;                             //!< Profiler category
 
 private:
     HdVP2RenderDelegate(const HdVP2RenderDelegate&) = delete;
     HdVP2RenderDelegate& operator=(const HdVP2RenderDelegate&) = delete;
 
+    void _FlushPendingCommits();
+    void _UpdatePendingTextures();
+
     static std::atomic_int                _renderDelegateCounter;   //!< Number of render delegates. First one creates shared resources and last one deletes them.
     static std::mutex                     _renderDelegateMutex;     //!< Mutex protecting construction/destruction of render delegate
     static HdResourceRegistrySharedPtr    _resourceRegistry;        //!< Shared and unused by VP2 resource registry
 
     std::unique_ptr<HdVP2RenderParam>     _renderParam;             //!< Render param used to provided access to VP2 during prim synchronization
     SdfPath                               _id;                      //!< Render delegate IDs
+    std::shared_ptr<HdVP2MeshTopologyCache> _meshTopologyCache;     //!< Topology-dependent data shared among Rprims. Data handles may outlive it.
     HdVP2ResourceRegistry                 _resourceRegistryVP2;     //!< VP2 resource registry used for enqueue and execution of commits
+    HdVP2BBoxBatch                        _bboxBatch;               //!< Single instanced render item drawing bounding boxes of Rprims
+    HdVP2ResidencyManager                 _residencyManager;        //!< Residency of buffers owned by draw items
+    double                                _commitTimeInMs{ 0.0 };   //!< Time spent in the last CommitResources, in milliseconds
+
+    std::unordered_set<HdVP2Material*>    _materialsWithPendingTextures;    //!< Materials drawing with placeholder textures
+    std::mutex                            _pendingTexturesMutex;            //!< Mutex protecting the set of materials above
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,261 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "residencyManager.h"
+#include "draw_item.h"
+#include "render_delegate.h"
+
+#include "pxr/base/tf/envSetting.h"
+
+#include <maya/MProfiler.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+TF_DEFINE_ENV_SETTING(VP2_RENDER_DELEGATE_GEOMETRY_BUDGET_MB, 0,
+    "Maximum number of megabytes of vertex and index buffers held by draw items "
+    "of all proxy shapes. Buffers of the least recently used draw items of unused "
+    "reprs are released first. 0 means no budget.");
+
+TF_DEFINE_ENV_SETTING(VP2_RENDER_DELEGATE_UNUSED_REPR_FRAMES, 300,
+    "Number of viewport updates after which buffers of draw items whose repr "
+    "is no longer used get released. 0 means never.");
+
+std::atomic<size_t> HdVP2ResidencyManager::_totalResidentBytes{ 0 };
+std::atomic<size_t> HdVP2ResidencyManager::_budget{ 0 };
+
+/*! \brief  Initialize the budget from the environment, once per process.
+*/
+void HdVP2ResidencyManager::_InitBudget()
+{
+    static std::once_flag budgetOnce;
+    std::call_once(budgetOnce, []() {
+        const int budgetInMB = TfGetEnvSetting(VP2_RENDER_DELEGATE_GEOMETRY_BUDGET_MB);
+        _budget = static_cast<size_t>(std::max(budgetInMB, 0)) * 1024 * 1024;
+    });
+}
+
+/*! \brief  Set the budget of buffers held by draw items of all render
+            delegates, in bytes. 0 means no budget.
+*/
+void HdVP2ResidencyManager::SetBudget(size_t numBytes)
+{
+    _InitBudget();
+    _budget = numBytes;
+}
+
+/*! \brief  Returns the budget of buffers held by draw items of all render
+            delegates, in bytes.
+*/
+size_t HdVP2ResidencyManager::GetBudget()
+{
+    _InitBudget();
+    return _budget;
+}
+
+/*! \brief  Constructor
+*/
+HdVP2ResidencyManager::HdVP2ResidencyManager()
+: _unusedReprFrames(static_cast<uint64_t>(
+    std::max(TfGetEnvSetting(VP2_RENDER_DELEGATE_UNUSED_REPR_FRAMES), 0)))
+{
+    _InitBudget();
+}
+
+/*! \brief  Destructor. Buffers of remaining draw items are no longer accounted.
+*/
+HdVP2ResidencyManager::~HdVP2ResidencyManager()
+{
+    _totalResidentBytes -= _numResidentBytes;
+}
+
+/*! \brief  Start a new viewport update. Reprs it uses have to be marked
+            after this call.
+*/
+void HdVP2ResidencyManager::BeginUpdate()
+{
+    _frame++;
+}
+
+/*! \brief  Mark the repr as used by the current update.
+*/
+void HdVP2ResidencyManager::MarkReprUsed(const TfToken& reprToken)
+{
+    if (!reprToken.IsEmpty()) {
+        _reprLastUsed[reprToken] = _frame;
+    }
+}
+
+/*! \brief  Account the buffers owned by the draw item after its commit, and
+            move it to the front of the LRU list.
+*/
+void HdVP2ResidencyManager::Update(HdVP2DrawItem* drawItem, size_t numBytes)
+{
+    auto result = _entries.emplace(drawItem, Entry());
+    Entry& entry = result.first->second;
+
+    if (result.second) {
+        _lru.push_front(drawItem);
+        _reprNumDrawItems[drawItem->GetReprToken()]++;
+    }
+    else {
+        _lru.splice(_lru.begin(), _lru, entry._lru);
+    }
+    entry._lru = _lru.begin();
+
+    _numResidentBytes = _numResidentBytes - entry._numBytes + numBytes;
+    _totalResidentBytes += numBytes;
+    _totalResidentBytes -= entry._numBytes;
+    entry._numBytes = numBytes;
+}
+
+/*! \brief  Stop accounting a draw item being deleted.
+*/
+void HdVP2ResidencyManager::Remove(HdVP2DrawItem* drawItem)
+{
+    auto it = _entries.find(drawItem);
+    if (it == _entries.end()) {
+        return;
+    }
+
+    _numResidentBytes -= it->second._numBytes;
+    _totalResidentBytes -= it->second._numBytes;
+    _lru.erase(it->second._lru);
+    _reprNumDrawItems[drawItem->GetReprToken()]--;
+    _entries.erase(it);
+}
+
+/*! \brief  Returns the last update using the repr, 0 if none.
+*/
+uint64_t HdVP2ResidencyManager::_GetLastUsed(const TfToken& reprToken) const
+{
+    const auto it = _reprLastUsed.find(reprToken);
+    return it != _reprLastUsed.end() ? it->second : 0;
+}
+
+/*! \brief  Whether draw items of the repr can be evicted, i.e. the repr
+            hasn't been used by the current or the previous update.
+*/
+bool HdVP2ResidencyManager::_IsEvictable(const TfToken& reprToken) const
+{
+    return _GetLastUsed(reprToken) + 1 < _frame;
+}
+
+/*! \brief  Whether any resident draw item belongs to a repr unused for the
+            configured number of updates.
+*/
+bool HdVP2ResidencyManager::_HasUnusedRepr() const
+{
+    if (_unusedReprFrames == 0) {
+        return false;
+    }
+
+    for (const auto& entry : _reprNumDrawItems) {
+        if (entry.second > 0 && _GetLastUsed(entry.first) + _unusedReprFrames <= _frame) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*! \brief  Evict draw items of unused reprs, then the least recently used
+            ones while the budget is exceeded.
+
+    Must not be called while commit tasks are pending, since they reference
+    buffers of draw items.
+*/
+void HdVP2ResidencyManager::Evict(MSubSceneContainer& container)
+{
+    const size_t budget = _budget;
+    const bool overBudget = budget > 0 && _totalResidentBytes > budget;
+
+    // Draw items are only visited when there is something to evict.
+    if (!overBudget && !_HasUnusedRepr()) {
+        return;
+    }
+
+    // Candidates from least to most recently updated, among draw items of
+    // reprs unused by the last updates.
+    std::vector<HdVP2DrawItem*> candidates;
+    for (auto it = _lru.rbegin(); it != _lru.rend(); ++it) {
+        if (_IsEvictable((*it)->GetReprToken())) {
+            candidates.push_back(*it);
+        }
+    }
+
+    if (candidates.empty()) {
+        return;
+    }
+
+    MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
+        MProfiler::kColorC_L2, "EvictDrawItems");
+
+    // Draw items of the reprs used longest ago are evicted first, from least
+    // to most recently updated for the same repr.
+    const auto lastUsed = [this](const HdVP2DrawItem* drawItem) {
+        return _GetLastUsed(drawItem->GetReprToken());
+    };
+    std::stable_sort(candidates.begin(), candidates.end(),
+        [&lastUsed](const HdVP2DrawItem* a, const HdVP2DrawItem* b) {
+            return lastUsed(a) < lastUsed(b);
+        });
+
+    for (HdVP2DrawItem* drawItem : candidates) {
+        const bool unused = _unusedReprFrames > 0 &&
+            lastUsed(drawItem) + _unusedReprFrames <= _frame;
+        const bool evictForBudget = budget > 0 && _totalResidentBytes > budget;
+        if (!unused && !evictForBudget) {
+            break;
+        }
+
+        _Evict(drawItem, container);
+    }
+}
+
+/*! \brief  Release the render item and buffers of the draw item.
+*/
+void HdVP2ResidencyManager::_Evict(HdVP2DrawItem* drawItem, MSubSceneContainer& container)
+{
+    auto it = _entries.find(drawItem);
+    if (it == _entries.end()) {
+        return;
+    }
+
+    _numEvictedDrawItems++;
+    _numEvictedBytes += it->second._numBytes;
+
+    Remove(drawItem);
+    drawItem->Evict(container);
+}
+
+/*! \brief  Returns statistics of the residency manager.
+*/
+HdVP2ResidencyStats HdVP2ResidencyManager::GetStats() const
+{
+    HdVP2ResidencyStats stats;
+    stats._numResidentDrawItems = _entries.size();
+    stats._numResidentBytes = _numResidentBytes;
+    stats._numTotalResidentBytes = _totalResidentBytes;
+    stats._numEvictedDrawItems = _numEvictedDrawItems;
+    stats._numEvictedBytes = _numEvictedBytes;
+    stats._budget = _budget;
+    return stats;
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,120 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef HD_VP2_RESIDENCY_MANAGER
+#define HD_VP2_RESIDENCY_MANAGER
+
+#include "pxr/pxr.h"
+#include "pxr/base/tf/token.h"
+
+#include <maya/MPxSubSceneOverride.h>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+class HdVP2DrawItem;
+
+/*! \brief  Statistics of the residency manager of a render delegate.
+*/
+struct HdVP2ResidencyStats {
+    size_t _numResidentDrawItems{ 0 };  //!< Number of draw items holding buffers
+    size_t _numResidentBytes{ 0 };      //!< Bytes of buffers held by draw items of the render delegate
+    size_t _numTotalResidentBytes{ 0 }; //!< Bytes of buffers held by draw items of all render delegates
+    size_t _numEvictedDrawItems{ 0 };   //!< Number of draw items evicted since creation
+    size_t _numEvictedBytes{ 0 };       //!< Bytes of buffers released by evictions since creation
+    size_t _budget{ 0 };                //!< Budget of all render delegates in bytes, 0 if none
+};
+
+/*! \brief  Residency of the geometry buffers owned by draw items.
+    \class  HdVP2ResidencyManager
+
+    Draw items own their vertex and index buffers for as long as the Rprim
+    exists, including draw items of reprs no longer requested by the viewport
+    display style. The manager accounts the bytes of the buffers owned by each
+    draw item with the repr it was created for, and evicts draw items:
+
+        - of reprs unused for a number of updates,
+        - from least to most recently used, while the buffers of all render
+          delegates exceed the budget.
+
+    Draw items of reprs used by the last two updates are never evicted, so
+    an update and its following selection pass don't rebuild each other's
+    buffers. Evicted draw items release their render item and buffers, and
+    are rebuilt on demand from the data cached by their Rprim when their repr
+    gets used again.
+
+    Main thread only.
+*/
+class HdVP2ResidencyManager final
+{
+public:
+    HdVP2ResidencyManager();
+    ~HdVP2ResidencyManager();
+
+    void BeginUpdate();
+    void MarkReprUsed(const TfToken& reprToken);
+
+    void Update(HdVP2DrawItem* drawItem, size_t numBytes);
+    void Remove(HdVP2DrawItem* drawItem);
+
+    void Evict(MSubSceneContainer& container);
+
+    HdVP2ResidencyStats GetStats() const;
+
+    static void SetBudget(size_t numBytes);
+    static size_t GetBudget();
+
+private:
+    HdVP2ResidencyManager(const HdVP2ResidencyManager&) = delete;
+    HdVP2ResidencyManager& operator=(const HdVP2ResidencyManager&) = delete;
+
+    static void _InitBudget();
+
+    uint64_t _GetLastUsed(const TfToken& reprToken) const;
+    bool _IsEvictable(const TfToken& reprToken) const;
+    bool _HasUnusedRepr() const;
+    void _Evict(HdVP2DrawItem* drawItem, MSubSceneContainer& container);
+
+    //! Buffers held by a draw item.
+    struct Entry {
+        size_t                              _numBytes{ 0 };     //!< Bytes of buffers owned by the draw item
+        std::list<HdVP2DrawItem*>::iterator _lru;               //!< Position in the LRU list
+    };
+
+    using ReprFrameMap = std::unordered_map<TfToken, uint64_t, TfToken::HashFunctor>;
+    using ReprCountMap = std::unordered_map<TfToken, size_t, TfToken::HashFunctor>;
+
+    std::unordered_map<HdVP2DrawItem*, Entry>   _entries;       //!< Resident draw items
+    std::list<HdVP2DrawItem*>                   _lru;           //!< Draw items from most to least recently updated
+    ReprFrameMap                                _reprLastUsed;  //!< Last update using each repr
+    ReprCountMap                                _reprNumDrawItems;  //!< Number of resident draw items of each repr
+
+    uint64_t        _frame{ 0 };                                //!< Number of updates so far
+    const uint64_t  _unusedReprFrames;                          //!< Updates after which draw items of unused reprs are evicted, 0 if never
+    size_t          _numResidentBytes{ 0 };                     //!< Bytes held by draw items of the render delegate
+    size_t          _numEvictedDrawItems{ 0 };                  //!< Number of draw items evicted since creation
+    size_t          _numEvictedBytes{ 0 };                      //!< Bytes released by evictions since creation
+
+    static std::atomic<size_t>  _totalResidentBytes;            //!< Bytes held by draw items of all render delegates
+    static std::atomic<size_t>  _budget;                        //!< Budget of all render delegates in bytes, 0 if none
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HD_VP2_RESIDENCY_MANAGER
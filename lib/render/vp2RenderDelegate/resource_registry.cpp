@@ -0,0 +1,159 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "resource_registry.h"
+#include "render_delegate.h"
+
+#include "pxr/base/tf/envSetting.h"
+#include "pxr/base/tf/stopwatch.h"
+
+#include <maya/MProfiler.h>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+TF_DEFINE_ENV_SETTING(VP2_RENDER_DELEGATE_COMMIT_BUDGET_MB, 0,
+    "Maximum number of megabytes uploaded to VP2 per frame, remaining commits "
+    "are deferred to the next frames. 0 means no budget.");
+
+namespace {
+
+    //! Small tasks are executed in batches of up to this number of bytes,
+    //! with budget checked once per batch.
+    constexpr size_t kBatchSize = 1024 * 1024;
+
+} // namespace
+
+//! \brief  Constructor
+HdVP2ResourceRegistry::HdVP2ResourceRegistry()
+{
+    const int budgetInMB = TfGetEnvSetting(VP2_RENDER_DELEGATE_COMMIT_BUDGET_MB);
+    if (budgetInMB > 0) {
+        _budget = static_cast<size_t>(budgetInMB) * 1024 * 1024;
+    }
+}
+
+//! \brief  Destructor. Pending tasks are released without execution.
+HdVP2ResourceRegistry::~HdVP2ResourceRegistry()
+{
+    Discard();
+}
+
+/*! \brief  Execute commit tasks within the per-frame budget (called by render delegate)
+*/
+void HdVP2ResourceRegistry::Commit()
+{
+    _stats = HdVP2CommitStats();
+    _Execute(_budget);
+}
+
+/*! \brief  Execute all pending commit tasks regardless of the budget.
+
+    Must be called before deleting objects referenced by deferred tasks.
+*/
+void HdVP2ResourceRegistry::Flush()
+{
+    _Execute(0);
+}
+
+/*! \brief  Release all pending commit tasks without execution.
+*/
+void HdVP2ResourceRegistry::Discard()
+{
+    HdVP2TaskCommit* commitTask;
+    for (auto& queue : _commitTasks) {
+        while (queue.try_pop(commitTask)) {
+            commitTask->destroy();
+        }
+    }
+
+    for (HdVP2TaskCommit* task : _deferredTasks) {
+        task->destroy();
+    }
+    _deferredTasks.clear();
+
+    _arena.Reset();
+}
+
+/*! \brief  Execute commit tasks in batches until the budget is exhausted.
+
+    Tasks of the current frame are appended to the deferred ones in priority
+    order. At least one batch is executed per call so progress is guaranteed
+    whatever the budget.
+
+    \param budget   Maximum number of bytes to upload, 0 meaning no budget
+*/
+void HdVP2ResourceRegistry::_Execute(size_t budget)
+{
+    TfStopwatch stopwatch;
+    stopwatch.Start();
+
+    HdVP2TaskCommit* commitTask;
+    for (auto& queue : _commitTasks) {
+        while (queue.try_pop(commitTask)) {
+            _deferredTasks.push_back(commitTask);
+        }
+    }
+
+    size_t numBytes = 0;
+
+    while (!_deferredTasks.empty()) {
+        // Gather consecutive small tasks into a batch, a large task makes a
+        // batch on its own.
+        size_t batchBytes = 0;
+        size_t batchEnd = 0;
+        while (batchEnd < _deferredTasks.size()) {
+            const size_t byteSize = _deferredTasks[batchEnd]->GetByteSize();
+            if (batchEnd > 0 && batchBytes + byteSize > kBatchSize) {
+                break;
+            }
+            batchBytes += byteSize;
+            batchEnd++;
+        }
+
+        if (budget > 0 && numBytes > 0 && numBytes + batchBytes > budget) {
+            break;
+        }
+
+        {
+            MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
+                MProfiler::kColorC_L2, "CommitBatch");
+
+            for (size_t i = 0; i < batchEnd; i++) {
+                HdVP2TaskCommit* task = _deferredTasks.front();
+                _deferredTasks.pop_front();
+                (*task)();
+                task->destroy();
+            }
+        }
+
+        numBytes += batchBytes;
+        _stats._numTasks += batchEnd;
+        _stats._numBatches++;
+    }
+
+    // Memory of all tasks can be reused once none of them is pending.
+    if (_deferredTasks.empty()) {
+        _arena.Reset();
+    }
+
+    stopwatch.Stop();
+
+    _stats._numBytes += numBytes;
+    _stats._numDeferredTasks = _deferredTasks.size();
+    _stats._timeInMs += stopwatch.GetSeconds() * 1000.0;
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -17,43 +17,104 @@
 #ifndef HD_VP2_RESOURCE_REGISTRY
 #define HD_VP2_RESOURCE_REGISTRY
 
+#include "renderStats.h"
 #include "task_commit.h"
 
 #include <tbb/concurrent_queue.h>
 #include <tbb/tbb_allocator.h>
 
+#include <deque>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
+/*! \brief  Priority of commit tasks. Tasks enqueued during the same frame are
+            executed in priority order, FIFO within the same priority.
+*/
+enum HdVP2CommitPriority {
+    kCommitPriorityHigh   = 0,  //!< E.g. selection highlight and shared resources
+    kCommitPriorityNormal = 1,  //!< Default priority
+    kCommitPriorityCount
+};
+
+/*! \brief  Statistics of commit tasks executed during the last frame.
+*/
+struct HdVP2CommitStats {
+    size_t _numTasks{ 0 };          //!< Number of executed tasks
+    size_t _numBatches{ 0 };        //!< Number of batches the tasks were executed in
+    size_t _numBytes{ 0 };          //!< Number of uploaded bytes
+    size_t _numDeferredTasks{ 0 };  //!< Number of tasks deferred to the next frames
+    double _timeInMs{ 0.0 };        //!< Time spent executing tasks, in milliseconds
+};
+
 /*! \brief  Central place to manage GPU resources commits and any resources not managed by VP2 directly
     \class  HdVP2ResourceRegistry
+
+    Commit tasks carry the number of bytes they upload. Small tasks are
+    executed in batches, and when a per-frame upload budget is set, tasks
+    exceeding it are deferred to the next frames in FIFO order so a large
+    stage load is spread across frames. Deferred tasks always run before any
+    task enqueued later, which preserves ordering of tasks enqueued by the
+    same prim.
 */
 class HdVP2ResourceRegistry
 {
 public:
-    //! \brief  Default constructor
-    HdVP2ResourceRegistry() = default;
-    //! \brief  Default destructor
-    ~HdVP2ResourceRegistry() = default;
-
-    //! \brief  Execute commit tasks (called by render delegate)
-    void Commit() {
-        HdVP2TaskCommit* commitTask;
-        while (_commitTasks.try_pop(commitTask)) {
-            (*commitTask)();
-            commitTask->destroy();
-        }
-    }
-    
-    //! \brief  Enqueue commit task. Call is thread safe.
+    HdVP2ResourceRegistry();
+    ~HdVP2ResourceRegistry();
+
+    void Commit();
+    void Flush();
+    void Discard();
+
+    /*! \brief  Enqueue commit task. Call is thread safe.
+
+        \param taskBody Function object to execute on main thread
+        \param byteSize Number of bytes uploaded by the task
+        \param priority Priority of the task within the frame
+    */
     template<typename Body>
-    void EnqueueCommit(Body taskBody) {
-        _commitTasks.push(HdVP2TaskCommitBody<Body>::construct(taskBody));
+    void EnqueueCommit(Body taskBody, size_t byteSize = 0,
+        HdVP2CommitPriority priority = kCommitPriorityNormal) {
+        _commitTasks[priority].push(
+            HdVP2TaskCommitBody<Body>::construct(_arena, taskBody, byteSize));
     }
+
+    //! Returns true if tasks were deferred to the next frames.
+    bool HasPendingCommits() const { return !_deferredTasks.empty(); }
+
+    //! Returns statistics of the last frame.
+    const HdVP2CommitStats& GetCommitStats() const { return _stats; }
+
+    //! Set the per-frame upload budget in bytes, 0 meaning no budget.
+    void SetCommitBudget(size_t numBytes) { _budget = numBytes; }
+
+    //! Returns the per-frame upload budget in bytes, 0 meaning no budget.
+    size_t GetCommitBudget() const { return _budget; }
+
+    //! Returns the counters of the current update, thread safe.
+    HdVP2RenderStatsCounters& GetStatsCounters() { return _statsCounters; }
+
 private:
-    //! Concurrent queue for commit tasks
-    tbb::concurrent_queue<HdVP2TaskCommit*, tbb::tbb_allocator<HdVP2TaskCommit*>> _commitTasks;
+    HdVP2ResourceRegistry(const HdVP2ResourceRegistry&) = delete;
+    HdVP2ResourceRegistry& operator=(const HdVP2ResourceRegistry&) = delete;
+
+    void _Execute(size_t budget);
+
+    //! Arena allocator for tasks, reset when all tasks have been executed
+    HdVP2TaskCommitArena _arena;
+
+    //! Concurrent queues for commit tasks, one per priority
+    tbb::concurrent_queue<HdVP2TaskCommit*, tbb::tbb_allocator<HdVP2TaskCommit*>> _commitTasks[kCommitPriorityCount];
+
+    //! Tasks deferred to the next frames because of the upload budget
+    std::deque<HdVP2TaskCommit*> _deferredTasks;
+
+    size_t           _budget{ 0 };  //!< Per-frame upload budget in bytes, 0 meaning no budget
+    HdVP2CommitStats _stats;        //!< Statistics of the last frame
+
+    HdVP2RenderStatsCounters _statsCounters;    //!< Counters of the current update
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
 
-#endif
\ No newline at end of file
+#endif
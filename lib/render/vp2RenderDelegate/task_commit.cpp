@@ -0,0 +1,132 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "task_commit.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+    //! Default size of arena chunks. Tasks larger than a quarter of it get a
+    //! dedicated chunk so they don't waste the current one.
+    constexpr size_t kChunkSize = 256 * 1024;
+
+} // namespace
+
+//! \brief  Allocate a chunk of the given capacity
+HdVP2TaskCommitArena::Chunk::Chunk(size_t capacity)
+: _capacity(capacity)
+, _data(new unsigned char[capacity])
+{
+}
+
+//! \brief  Release memory of the chunk
+HdVP2TaskCommitArena::Chunk::~Chunk()
+{
+    delete[] _data;
+}
+
+//! \brief  Constructor
+HdVP2TaskCommitArena::HdVP2TaskCommitArena()
+{
+    _chunks = new Chunk(kChunkSize);
+    _reservedBytes = kChunkSize;
+    _current.store(_chunks, std::memory_order_release);
+}
+
+//! \brief  Destructor. All tasks must have been destroyed.
+HdVP2TaskCommitArena::~HdVP2TaskCommitArena()
+{
+    while (_chunks) {
+        Chunk* next = _chunks->_next;
+        delete _chunks;
+        _chunks = next;
+    }
+}
+
+/*! \brief  Allocate memory when the current chunk is exhausted.
+
+    A new chunk is added under lock. Other threads racing for the same
+    exhausted chunk find the new chunk installed when they get the lock.
+*/
+void* HdVP2TaskCommitArena::_AllocateSlow(Chunk* current, size_t size)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (size > kChunkSize / 4) {
+        Chunk* dedicated = new Chunk(size);
+        dedicated->_offset = size;
+        dedicated->_next = _chunks;
+        _chunks = dedicated;
+        _reservedBytes += size;
+        return dedicated->_data;
+    }
+
+    for (;;) {
+        Chunk* latest = _current.load(std::memory_order_acquire);
+        if (latest != current) {
+            const size_t offset = latest->_offset.fetch_add(size, std::memory_order_relaxed);
+            if (offset + size <= latest->_capacity) {
+                return latest->_data + offset;
+            }
+            current = latest;
+            continue;
+        }
+
+        Chunk* chunk = new Chunk(kChunkSize);
+        chunk->_offset = size;
+        chunk->_next = _chunks;
+        _chunks = chunk;
+        _reservedBytes += kChunkSize;
+        _current.store(chunk, std::memory_order_release);
+        return chunk->_data;
+    }
+}
+
+/*! \brief  Release all chunks but one for reuse by the next frame.
+
+    Must be called only when no task allocated from the arena is alive and
+    no allocation is in progress.
+*/
+void HdVP2TaskCommitArena::Reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Keep a default-sized chunk, release the others.
+    Chunk* keep = nullptr;
+    while (_chunks) {
+        Chunk* next = _chunks->_next;
+        if (!keep && _chunks->_capacity == kChunkSize) {
+            keep = _chunks;
+        }
+        else {
+            delete _chunks;
+        }
+        _chunks = next;
+    }
+
+    if (!keep) {
+        keep = new Chunk(kChunkSize);
+    }
+
+    keep->_next = nullptr;
+    keep->_offset = 0;
+    _chunks = keep;
+    _reservedBytes = kChunkSize;
+    _current.store(keep, std::memory_order_release);
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
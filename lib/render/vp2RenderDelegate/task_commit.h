@@ -17,23 +17,96 @@
 #ifndef HD_VP2_TASK_COMMIT
 #define HD_VP2_TASK_COMMIT
 
-#include <tbb/tbb_allocator.h>
+#include "pxr/pxr.h"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+/*! \brief  Arena allocator for commit tasks of a frame.
+    \class  HdVP2TaskCommitArena
+
+    Tasks are allocated by bumping an atomic offset in the current chunk, so
+    concurrent allocation from sync threads is lock-free except when a new
+    chunk is needed. Memory of individual tasks is never released, the whole
+    arena is reset once all tasks allocated from it have been executed.
+*/
+class HdVP2TaskCommitArena
+{
+public:
+    HdVP2TaskCommitArena();
+    ~HdVP2TaskCommitArena();
+
+    void* Allocate(size_t size);
+    void  Reset();
+
+    //! Returns the number of bytes reserved by the arena.
+    size_t GetReservedBytes() const { return _reservedBytes; }
+
+private:
+    HdVP2TaskCommitArena(const HdVP2TaskCommitArena&) = delete;
+    HdVP2TaskCommitArena& operator=(const HdVP2TaskCommitArena&) = delete;
+
+    //! A block of memory tasks are allocated from.
+    struct Chunk {
+        Chunk(size_t capacity);
+        ~Chunk();
+
+        Chunk*              _next{ nullptr };   //!< Next chunk in the list of all chunks
+        const size_t        _capacity;          //!< Size of the chunk in bytes
+        std::atomic<size_t> _offset{ 0 };       //!< Offset of the next allocation
+        unsigned char*      _data;              //!< Memory of the chunk
+    };
+
+    void* _AllocateSlow(Chunk* current, size_t size);
+
+    std::atomic<Chunk*> _current;               //!< Chunk allocations are made from
+    Chunk*              _chunks{ nullptr };     //!< List of all chunks, protected by _mutex
+    size_t              _reservedBytes{ 0 };    //!< Total size of all chunks, protected by _mutex
+    std::mutex          _mutex;                 //!< Synchronization used to add chunks
+};
+
+/*! \brief  Allocate memory for a task. Call is thread safe.
+*/
+inline void* HdVP2TaskCommitArena::Allocate(size_t size)
+{
+    constexpr size_t alignment = alignof(std::max_align_t);
+    size = (size + alignment - 1) & ~(alignment - 1);
+
+    Chunk* current = _current.load(std::memory_order_acquire);
+    const size_t offset = current->_offset.fetch_add(size, std::memory_order_relaxed);
+    if (offset + size <= current->_capacity) {
+        return current->_data + offset;
+    }
+
+    return _AllocateSlow(current, size);
+}
+
 /*! \brief  Base commit task class
     \class  HdVP2TaskCommit
 */
 class HdVP2TaskCommit
 {
 public:
+    //! Construct a task uploading the given number of bytes
+    HdVP2TaskCommit(size_t byteSize) : _byteSize(byteSize) {}
+
     virtual ~HdVP2TaskCommit() = default;
 
     //! Execute the task
     virtual void operator()() = 0;
 
-    //! Destroy & deallocated this task
+    //! Destroy this task, its memory is reclaimed with the arena
     virtual void destroy() = 0;
+
+    //! Number of bytes uploaded by the task
+    size_t GetByteSize() const { return _byteSize; }
+
+private:
+    const size_t _byteSize; //!< Number of bytes uploaded by the task
 };
 
 /*! \brief  Wrapper of a task body into commit task.
@@ -41,12 +114,10 @@ public:
 */
 template <typename Body>
 class HdVP2TaskCommitBody final : public HdVP2TaskCommit {
-    //! Use scalable allocator to prevent heap contention
-    using my_allocator_type = tbb::tbb_allocator<HdVP2TaskCommitBody<Body>>;
-
-    //! Private constructor to force usage of construct method & allocation with 
-    //! scalable allocator.
-    HdVP2TaskCommitBody(const Body& body) : fBody(body) {}
+    //! Private constructor to force usage of construct method & allocation
+    //! from the arena.
+    HdVP2TaskCommitBody(const Body& body, size_t byteSize)
+        : HdVP2TaskCommit(byteSize), fBody(body) {}
 
 public:
     ~HdVP2TaskCommitBody() override = default;
@@ -56,19 +127,19 @@ public:
         fBody();
     }
 
-    //! Objects of this type are allocated with tbb_allocator.
-    //! Release the memory using same allocator by calling destroy method.
+    //! Objects of this type are allocated from an arena. Call destroy method
+    //! to release resources captured by the body.
     void destroy() override {
-        my_allocator_type().destroy(this);
-        my_allocator_type().deallocate(this, 1);
+        this->~HdVP2TaskCommitBody();
     }
 
-    /*! Allocate a new object of type Body using scalable allocator.
-        Always free this object by calling destroy method!
+    /*! Allocate a new object of type Body from the arena.
+        Always destroy this object by calling destroy method!
     */
-    static HdVP2TaskCommitBody<Body>* construct(const Body& body) {
-        void* mem = my_allocator_type().allocate(1);
-        return new (mem) HdVP2TaskCommitBody<Body>(body);
+    static HdVP2TaskCommitBody<Body>* construct(
+        HdVP2TaskCommitArena& arena, const Body& body, size_t byteSize) {
+        void* mem = arena.Allocate(sizeof(HdVP2TaskCommitBody<Body>));
+        return new (mem) HdVP2TaskCommitBody<Body>(body, byteSize);
     }
 
 private:
@@ -77,4 +148,4 @@ private:
 
 PXR_NAMESPACE_CLOSE_SCOPE
 
-#endif
\ No newline at end of file
+#endif
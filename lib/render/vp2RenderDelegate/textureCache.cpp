@@ -0,0 +1,407 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "textureCache.h"
+#include "material.h"
+#include "render_delegate.h"
+
+#include "pxr/base/tf/diagnostic.h"
+#include "pxr/base/tf/envSetting.h"
+#include "pxr/base/tf/stopwatch.h"
+#include "pxr/imaging/glf/image.h"
+#include "pxr/usd/ar/packageUtils.h"
+
+#include <maya/MGlobal.h>
+#include <maya/MProfiler.h>
+#include <maya/MViewport2Renderer.h>
+
+#include <boost/filesystem.hpp>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+TF_DEFINE_ENV_SETTING(VP2_RENDER_DELEGATE_ASYNC_TEXTURE_LOADING, true,
+    "Decode texture images on worker threads in interactive sessions, "
+    "drawing with placeholder textures until decoding finishes.");
+
+TF_DEFINE_ENV_SETTING(VP2_RENDER_DELEGATE_TEXTURE_CACHE_MB, 1024,
+    "Maximum number of megabytes of decoded texture images kept in CPU memory.");
+
+namespace {
+
+    //! Helper utility function to get the texture manager.
+    MHWRender::MTextureManager* _GetTextureManager()
+    {
+        MHWRender::MRenderer* const renderer = MHWRender::MRenderer::theRenderer();
+        return renderer ? renderer->getTextureManager() : nullptr;
+    }
+
+    //! Helper utility function to get the modification time of the file, or
+    //! of the package containing the file. Returns 0 if it can't be queried.
+    int64_t _GetModificationTime(const std::string& path)
+    {
+        const std::string filePath = ArIsPackageRelativePath(path) ?
+            ArSplitPackageRelativePathOuter(path).first : path;
+
+        boost::system::error_code ec;
+        const std::time_t mtime = boost::filesystem::last_write_time(filePath, ec);
+        return ec ? 0 : static_cast<int64_t>(mtime);
+    }
+
+} // namespace
+
+/*! \brief  Returns the process-wide texture cache.
+*/
+HdVP2TextureCache& HdVP2TextureCache::GetInstance()
+{
+    static HdVP2TextureCache instance;
+    return instance;
+}
+
+/*! \brief  Constructor
+*/
+HdVP2TextureCache::HdVP2TextureCache()
+: _async(TfGetEnvSetting(VP2_RENDER_DELEGATE_ASYNC_TEXTURE_LOADING) &&
+    MGlobal::mayaState() == MGlobal::kInteractive)
+{
+    const int budgetInMB = TfGetEnvSetting(VP2_RENDER_DELEGATE_TEXTURE_CACHE_MB);
+    _budget = static_cast<size_t>(std::max(budgetInMB, 0)) * 1024 * 1024;
+}
+
+/*! \brief  Destructor, waits for decoding tasks to finish.
+*/
+HdVP2TextureCache::~HdVP2TextureCache()
+{
+    _taskGroup.cancel();
+    _taskGroup.wait();
+}
+
+/*! \brief  Acquire the texture for the given image path. Main thread only.
+
+    \param path             Resolved path of the image
+    \param isColorSpaceSRGB Returns whether sRGB linearization is needed
+    \param isPending        Returns true if the image is being decoded, in
+                            which case a placeholder texture is returned
+
+    \return The texture, or null if the image couldn't be loaded
+*/
+HdVP2TextureSharedPtr HdVP2TextureCache::Acquire(
+    const std::string& path,
+    bool& isColorSpaceSRGB,
+    bool& isPending)
+{
+    isColorSpaceSRGB = false;
+    isPending = false;
+
+    const int64_t mtime = _GetModificationTime(path);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto result = _entries.emplace(path, Entry());
+    Entry& entry = result.first->second;
+
+    if (result.second) {
+        _lru.push_front(path);
+        entry._lru = _lru.begin();
+        entry._mtime = mtime;
+    }
+    else {
+        _lru.splice(_lru.begin(), _lru, entry._lru);
+
+        // The file changed since it was decoded, decode it again.
+        if (entry._mtime != mtime) {
+            _stats._numCachedBytes -= entry._image._texels.size();
+            entry._image = Image();
+            entry._texture.reset();
+            entry._state = kNotLoaded;
+            entry._mtime = mtime;
+            entry._generation++;
+        }
+    }
+
+    if (HdVP2TextureSharedPtr texture = entry._texture.lock()) {
+        isColorSpaceSRGB = entry._image._isColorSpaceSRGB;
+        return texture;
+    }
+
+    if (entry._state == kNotLoaded) {
+        if (_async) {
+            entry._state = kPending;
+            _stats._numPending++;
+            _DecodeAsync(path, entry._generation);
+        }
+        else {
+            TfStopwatch stopwatch;
+            stopwatch.Start();
+            _Decode(path, entry._image);
+            stopwatch.Stop();
+
+            entry._state = entry._image._valid ? kLoaded : kFailed;
+            _stats._numCachedBytes += entry._image._texels.size();
+            _stats._numLoadedBytes += entry._image._texels.size();
+            _stats._loadTimeInMs += stopwatch.GetSeconds() * 1000.0;
+        }
+    }
+
+    switch (entry._state) {
+    case kPending:
+        isPending = true;
+        return _GetPlaceholder();
+    case kLoaded: {
+        HdVP2TextureSharedPtr texture = _CreateTexture(path, entry);
+        _Evict();
+        return texture;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+/*! \brief  Returns statistics of the cache.
+*/
+HdVP2TextureCacheStats HdVP2TextureCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    HdVP2TextureCacheStats stats = _stats;
+    stats._numTextures = _entries.size();
+    return stats;
+}
+
+/*! \brief  Set the budget of decoded texels held in CPU memory, in bytes.
+*/
+void HdVP2TextureCache::SetBudget(size_t numBytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _budget = numBytes;
+    _Evict();
+}
+
+/*! \brief  Decode the image from the specified path. Thread safe.
+
+    GlfImage is used for loading pixel data from usdz only and should not
+    trigger any OpenGL call. The texels are converted to a format supported
+    by VP2, which transfers them to GPU memory with 3D API agnostic calls.
+*/
+void HdVP2TextureCache::_Decode(const std::string& path, Image& image)
+{
+    image._valid = false;
+
+    GlfImageSharedPtr glfImage = GlfImage::OpenForReading(path);
+    if (!glfImage) {
+        TF_WARN("Failed to open texture image %s", path.c_str());
+        return;
+    }
+
+    GlfImage::StorageSpec spec;
+    spec.width = glfImage->GetWidth();
+    spec.height = glfImage->GetHeight();
+    spec.depth = 1;
+    spec.format = glfImage->GetFormat();
+    spec.type = glfImage->GetType();
+    spec.flipped = false;
+
+    const int bpp = glfImage->GetBytesPerPixel();
+    const int bytesPerRow = spec.width * bpp;
+    const int bytesPerSlice = bytesPerRow * spec.height;
+
+    image._texels.resize(bytesPerSlice);
+    spec.data = image._texels.data();
+
+    if (!glfImage->Read(spec)) {
+        image._texels.clear();
+        return;
+    }
+
+    MHWRender::MTextureDescription& desc = image._desc;
+    desc.setToDefault2DTexture();
+    desc.fWidth = spec.width;
+    desc.fHeight = spec.height;
+    desc.fBytesPerRow = bytesPerRow;
+    desc.fBytesPerSlice = bytesPerSlice;
+
+    switch (spec.format)
+    {
+    case GL_RED:
+        desc.fFormat = (spec.type == GL_FLOAT ?
+            MHWRender::kR32_FLOAT : MHWRender::kR8_UNORM);
+        image._valid = true;
+        break;
+    case GL_RGB:
+        if (spec.type == GL_FLOAT) {
+            desc.fFormat = MHWRender::kR32G32B32_FLOAT;
+        }
+        else {
+            // R8G8B8 is not supported by VP2. Converted to R8G8B8A8.
+            constexpr int bpp_4 = 4;
+
+            desc.fFormat = MHWRender::kR8G8B8A8_UNORM;
+            desc.fBytesPerRow = spec.width * bpp_4;
+            desc.fBytesPerSlice = desc.fBytesPerRow * spec.height;
+
+            std::vector<unsigned char> texels(desc.fBytesPerSlice);
+
+            const size_t numTexels = static_cast<size_t>(spec.width) * spec.height;
+            const unsigned char* src = image._texels.data();
+            unsigned char* dst = texels.data();
+            for (size_t t = 0; t < numTexels; t++) {
+                dst[t*bpp_4]     = src[t*bpp];
+                dst[t*bpp_4 + 1] = src[t*bpp + 1];
+                dst[t*bpp_4 + 2] = src[t*bpp + 2];
+                dst[t*bpp_4 + 3] = 255;
+            }
+
+            image._texels.swap(texels);
+            image._isColorSpaceSRGB = glfImage->IsColorSpaceSRGB();
+        }
+        image._valid = true;
+        break;
+    case GL_RGBA:
+        if (spec.type == GL_FLOAT) {
+            desc.fFormat = MHWRender::kR32G32B32A32_FLOAT;
+        }
+        else {
+            desc.fFormat = MHWRender::kR8G8B8A8_UNORM;
+            image._isColorSpaceSRGB = glfImage->IsColorSpaceSRGB();
+        }
+        image._valid = true;
+        break;
+    default:
+        break;
+    }
+
+    if (!image._valid) {
+        image._texels.clear();
+    }
+}
+
+/*! \brief  Create the VP2 texture of a loaded entry. Main thread only.
+*/
+HdVP2TextureSharedPtr HdVP2TextureCache::_CreateTexture(
+    const std::string& path, Entry& entry)
+{
+    MHWRender::MTextureManager* const textureMgr = _GetTextureManager();
+    if (!TF_VERIFY(textureMgr)) {
+        return nullptr;
+    }
+
+    MProfilingScope profilingScope(HdVP2RenderDelegate::sProfilerCategory,
+        MProfiler::kColorC_L2, path.c_str(), "CreateTexture");
+
+    // The texture manager returns the existing texture of the same name with
+    // its old texels, which materials not synced yet may still be using, so
+    // each version of a reloaded file gets its own texture name.
+    const std::string textureName = (entry._generation == 0) ? path :
+        path + "#" + std::to_string(entry._generation);
+
+    MHWRender::MTexture* texture = textureMgr->acquireTexture(
+        textureName.c_str(), entry._image._desc, entry._image._texels.data());
+    if (!texture) {
+        return nullptr;
+    }
+
+    HdVP2TextureSharedPtr sharedTexture(texture, HdVP2TextureDeleter());
+    entry._texture = sharedTexture;
+    return sharedTexture;
+}
+
+/*! \brief  Returns the 1x1 placeholder texture. Main thread only.
+*/
+HdVP2TextureSharedPtr HdVP2TextureCache::_GetPlaceholder()
+{
+    if (HdVP2TextureSharedPtr placeholder = _placeholder.lock()) {
+        return placeholder;
+    }
+
+    MHWRender::MTextureManager* const textureMgr = _GetTextureManager();
+    if (!TF_VERIFY(textureMgr)) {
+        return nullptr;
+    }
+
+    const unsigned char texel[4] = { 128, 128, 128, 255 };
+
+    MHWRender::MTextureDescription desc;
+    desc.setToDefault2DTexture();
+    desc.fWidth = 1;
+    desc.fHeight = 1;
+    desc.fFormat = MHWRender::kR8G8B8A8_UNORM;
+    desc.fBytesPerRow = sizeof(texel);
+    desc.fBytesPerSlice = sizeof(texel);
+
+    MHWRender::MTexture* texture = textureMgr->acquireTexture(
+        "HdVP2PlaceholderTexture", desc, texel);
+    if (!texture) {
+        return nullptr;
+    }
+
+    HdVP2TextureSharedPtr placeholder(texture, HdVP2TextureDeleter());
+    _placeholder = placeholder;
+    return placeholder;
+}
+
+/*! \brief  Decode the image on a worker thread.
+
+    The result is discarded if the file changed in the meantime.
+*/
+void HdVP2TextureCache::_DecodeAsync(const std::string& path, size_t generation)
+{
+    _taskGroup.run([this, path, generation]() {
+        TfStopwatch stopwatch;
+        stopwatch.Start();
+        Image image;
+        _Decode(path, image);
+        stopwatch.Stop();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _stats._numPending--;
+        _stats._loadTimeInMs += stopwatch.GetSeconds() * 1000.0;
+
+        auto it = _entries.find(path);
+        if (it == _entries.end() || it->second._generation != generation) {
+            return;
+        }
+
+        Entry& entry = it->second;
+        entry._image = std::move(image);
+        entry._state = entry._image._valid ? kLoaded : kFailed;
+
+        _stats._numCachedBytes += entry._image._texels.size();
+        _stats._numLoadedBytes += entry._image._texels.size();
+
+        _Evict();
+    });
+}
+
+/*! \brief  Release texels of least recently used images exceeding the budget.
+
+    Images being decoded are skipped. VP2 textures stay alive as long as
+    materials use them.
+*/
+void HdVP2TextureCache::_Evict()
+{
+    for (auto it = _lru.rbegin();
+         it != _lru.rend() && _stats._numCachedBytes > _budget; ++it) {
+        Entry& entry = _entries[*it];
+        if (entry._state == kLoaded && !entry._image._texels.empty()) {
+            _stats._numCachedBytes -= entry._image._texels.size();
+            std::vector<unsigned char>().swap(entry._image._texels);
+            entry._state = kNotLoaded;
+        }
+    }
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
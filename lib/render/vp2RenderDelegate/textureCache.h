@@ -0,0 +1,133 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef HD_VP2_TEXTURE_CACHE
+#define HD_VP2_TEXTURE_CACHE
+
+#include "pxr/pxr.h"
+
+#include <maya/MTextureManager.h>
+
+#include <tbb/task_group.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/*! \brief  A MTexture shared by all materials using the same image.
+*/
+using HdVP2TextureSharedPtr = std::shared_ptr<MHWRender::MTexture>;
+
+/*! \brief  Statistics of the texture cache.
+*/
+struct HdVP2TextureCacheStats {
+    size_t _numTextures{ 0 };       //!< Number of cached images
+    size_t _numPending{ 0 };        //!< Number of images being decoded
+    size_t _numCachedBytes{ 0 };    //!< Number of bytes of decoded texels held in CPU memory
+    size_t _numLoadedBytes{ 0 };    //!< Total number of bytes of decoded texels
+    double _loadTimeInMs{ 0.0 };    //!< Total decoding time, summed over worker threads
+};
+
+/*! \brief  Process-wide cache of decoded texture images.
+    \class  HdVP2TextureCache
+
+    Images are keyed by path and file modification time and shared across
+    materials and proxy shapes. In interactive sessions images are decoded on
+    TBB worker threads and a 1x1 placeholder texture is returned until
+    decoding finishes. Decoded texels are kept in CPU memory under an LRU
+    budget so that GPU textures can be recreated without decoding again.
+
+    VP2 textures are created on main thread only, the cache holds no
+    ownership of them.
+*/
+class HdVP2TextureCache final
+{
+public:
+    static HdVP2TextureCache& GetInstance();
+
+    HdVP2TextureSharedPtr Acquire(const std::string& path,
+        bool& isColorSpaceSRGB, bool& isPending);
+
+    HdVP2TextureCacheStats GetStats() const;
+
+    //! Set the budget of decoded texels held in CPU memory, in bytes.
+    void SetBudget(size_t numBytes);
+
+    //! Returns the budget of decoded texels held in CPU memory, in bytes.
+    size_t GetBudget() const { return _budget; }
+
+private:
+    HdVP2TextureCache();
+    ~HdVP2TextureCache();
+
+    HdVP2TextureCache(const HdVP2TextureCache&) = delete;
+    HdVP2TextureCache& operator=(const HdVP2TextureCache&) = delete;
+
+    //! Loading state of a cached image.
+    enum State {
+        kNotLoaded, //!< Texels are not in memory
+        kPending,   //!< Texels are being decoded
+        kLoaded,    //!< Texels are in memory
+        kFailed     //!< Image couldn't be decoded
+    };
+
+    //! Decoded image data.
+    struct Image {
+        MHWRender::MTextureDescription  _desc;                      //!< Description of the texture to create
+        std::vector<unsigned char>      _texels;                    //!< Texels ready for upload
+        bool                            _isColorSpaceSRGB{ false }; //!< Whether sRGB linearization is needed
+        bool                            _valid{ false };            //!< Whether decoding succeeded
+    };
+
+    //! A cache entry.
+    struct Entry {
+        State                                   _state{ kNotLoaded };
+        int64_t                                 _mtime{ 0 };                //!< Modification time of the file
+        size_t                                  _generation{ 0 };           //!< Incremented when the file changes
+        Image                                   _image;                     //!< Decoded image data
+        std::weak_ptr<MHWRender::MTexture>      _texture;                   //!< VP2 texture, if alive
+        std::list<std::string>::iterator        _lru;                       //!< Position in the LRU list
+    };
+
+    static void _Decode(const std::string& path, Image& image);
+
+    HdVP2TextureSharedPtr _CreateTexture(const std::string& path, Entry& entry);
+    HdVP2TextureSharedPtr _GetPlaceholder();
+
+    void _DecodeAsync(const std::string& path, size_t generation);
+    void _Evict();
+
+    std::unordered_map<std::string, Entry>  _entries;           //!< Cached images indexed by path
+    std::list<std::string>                  _lru;               //!< Paths from most to least recently used
+    std::weak_ptr<MHWRender::MTexture>      _placeholder;       //!< Placeholder texture, if alive
+
+    size_t                  _budget;                            //!< Budget of decoded texels in bytes
+    HdVP2TextureCacheStats  _stats;                             //!< Statistics, protected by _mutex
+    mutable std::mutex      _mutex;                             //!< Synchronization used to protect all data above
+
+    tbb::task_group         _taskGroup;                         //!< Decoding tasks
+    const bool              _async;                             //!< Whether images are decoded asynchronously
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HD_VP2_TEXTURE_CACHE
@@ -24,6 +24,7 @@ PXR_NAMESPACE_OPEN_SCOPE
 
 #define HDVP2_REPR_TOKENS                          \
     (bbox)                                         \
+    (lowDetail)                                    \
     (selection)
 
 TF_DECLARE_PUBLIC_TOKENS(HdVP2ReprTokens, , HDVP2_REPR_TOKENS);
@@ -0,0 +1,113 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef HD_VP2_VERTEX_BUFFER_RING
+#define HD_VP2_VERTEX_BUFFER_RING
+
+#include "pxr/pxr.h"
+
+#include <maya/MHWGeometry.h>
+
+#include <algorithm>
+#include <memory>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/*! \brief  Ring of vertex buffers for data refilled every frame.
+    \class  HdVP2VertexBufferRing
+
+    A single buffer is used until data is refilled with a ring size greater
+    than 1. From then on, each fill goes to the next buffer of the ring while
+    render items keep drawing from the previous one, and render items are
+    switched to the newly filled buffer at commit time. Static data thus
+    keeps the single-buffer path.
+
+    The ring is not thread safe, it is owned and filled by a single Rprim.
+*/
+class HdVP2VertexBufferRing final
+{
+public:
+    //! Maximum number of buffers in the ring.
+    static constexpr unsigned int kMaxSize = 3;
+
+    //! \brief  Constructor, creates the first buffer with the descriptor.
+    HdVP2VertexBufferRing(const MHWRender::MVertexBufferDescriptor& desc)
+    : _desc(desc)
+    {
+        _buffers[0].reset(new MHWRender::MVertexBuffer(_desc));
+    }
+
+    //! \brief  Returns the buffer filled last, to be set on render items.
+    MHWRender::MVertexBuffer* GetCurrent() const { return _buffers[_current].get(); }
+
+    //! \brief  Returns the number of buffers in the ring.
+    unsigned int GetSize() const { return _size; }
+
+    //! \brief  Returns the number of bytes of all buffers of the ring.
+    size_t GetNumBytes() const
+    {
+        size_t numBytes = 0;
+        for (const auto& buffer : _buffers) {
+            if (buffer) {
+                numBytes += buffer->vertexCount() * _desc.dimension() * sizeof(float);
+            }
+        }
+        return numBytes;
+    }
+
+    /*! \brief  Acquire a buffer of the ring for writing.
+
+        If the current buffer has been filled before and ring size is greater
+        than 1, the next buffer of the ring is acquired, otherwise the current
+        one. The acquired buffer becomes current on success.
+
+        \param numVertices  Number of vertices to acquire
+        \param ringSize     Requested number of buffers in the ring, clamped to kMaxSize
+
+        \return Pointer to the buffer data to commit, or null on failure
+    */
+    void* Acquire(unsigned int numVertices, unsigned int ringSize)
+    {
+        unsigned int next = _current;
+
+        if (ringSize > 1 && _buffers[_current]->vertexCount() > 0) {
+            _size = std::max(_size, std::min(ringSize, kMaxSize));
+            next = (_current + 1) % _size;
+            if (!_buffers[next]) {
+                _buffers[next].reset(new MHWRender::MVertexBuffer(_desc));
+            }
+        }
+
+        void* bufferData = _buffers[next]->acquire(numVertices, true);
+        if (bufferData) {
+            _current = next;
+        }
+        return bufferData;
+    }
+
+private:
+    HdVP2VertexBufferRing(const HdVP2VertexBufferRing&) = delete;
+    HdVP2VertexBufferRing& operator=(const HdVP2VertexBufferRing&) = delete;
+
+    const MHWRender::MVertexBufferDescriptor  _desc;                //!< Descriptor of all buffers of the ring
+    std::unique_ptr<MHWRender::MVertexBuffer> _buffers[kMaxSize];   //!< Buffers of the ring, created on demand
+    unsigned int                              _size{ 1 };           //!< Number of buffers in use
+    unsigned int                              _current{ 0 };        //!< Index of the buffer filled last
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HD_VP2_VERTEX_BUFFER_RING
@@ -166,6 +166,10 @@ void StagesSubject::afterOpen()
 
 void StagesSubject::stageChanged(UsdNotice::ObjectsChanged const& notice, UsdStageWeakPtr const& sender)
 {
+	// Resynced prims may have been removed or replaced, so drop them from the
+	// prim cache before any UFE path is resolved again.
+	g_StageMap.invalidatePrims(sender, notice.GetResyncedPaths());
+
 	// If the stage path has not been initialized yet, do nothing 
 	if (stagePath(sender).empty())
 		return;
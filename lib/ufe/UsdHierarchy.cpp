@@ -111,9 +111,9 @@ Ufe::AppendedChild UsdHierarchy::appendChild(const Ufe::SceneItem::Ptr& child)
 	auto prim = usdChild->prim();
 	auto stage = prim.GetStage();
 	auto ufeSrcPath = usdChild->path();
-	auto usdSrcPath = prim.GetPath();
+	auto usdSrcPath = usdChild->primPath();
 	auto ufeDstPath = fItem->path() + childName;
-	auto usdDstPath = fPrim.GetPath().AppendChild(TfToken(childName));
+	auto usdDstPath = fItem->primPath().AppendChild(TfToken(childName));
 	SdfLayerHandle layer = defPrimSpecLayer(prim);
 	if (!layer) {
 		std::string err = TfStringPrintf("No prim found at %s", usdSrcPath.GetString().c_str());
@@ -133,7 +133,7 @@ Ufe::AppendedChild UsdHierarchy::appendChild(const Ufe::SceneItem::Ptr& child)
 	}
 
 	stage->RemovePrim(usdSrcPath);
-	auto ufeDstItem = UsdSceneItem::create(ufeDstPath, ufePathToPrim(ufeDstPath));
+	auto ufeDstItem = UsdSceneItem::create(ufeDstPath, stage->GetPrimAtPath(usdDstPath));
 	auto notification = Ufe::ObjectReparent(ufeDstItem, ufeSrcPath);
 	Ufe::Scene::notifyObjectPathChange(notification);
 
@@ -156,14 +156,11 @@ Ufe::SceneItem::Ptr UsdHierarchy::createGroup(const Ufe::PathComponent& name) co
 	Ufe::Path newPath = fItem->path() + name;
 	auto childName = uniqueChildName(sceneItem(), newPath);
 
-	// Next, get the stage corresponding to the new path.
-	auto segments = newPath.getSegments();
-	TEST_USD_PATH(segments, newPath);
-	auto dagSegment = segments[0];
-	auto stage = getStage(Ufe::Path(dagSegment));
+	// Next, get the stage of the parent prim.
+	auto stage = fItem->prim().GetStage();
 
 	// Build the corresponding USD path and create the USD group prim.
-	auto usdPath = fItem->prim().GetPath().AppendChild(TfToken(childName));
+	auto usdPath = fItem->primPath().AppendChild(TfToken(childName));
 	auto prim = UsdGeomXform::Define(stage, usdPath).GetPrim();
 
 	// Create a UFE scene item from the prim.
@@ -22,6 +22,7 @@ namespace ufe {
 UsdSceneItem::UsdSceneItem(const Ufe::Path& path, const UsdPrim& prim)
 	: Ufe::SceneItem(path)
 	, fPrim(prim)
+	, fPrimPath(prim.GetPath())
 {
 }
 
@@ -40,6 +41,11 @@ const UsdPrim& UsdSceneItem::prim() const
 	return fPrim;
 }
 
+const SdfPath& UsdSceneItem::primPath() const
+{
+	return fPrimPath;
+}
+
 //------------------------------------------------------------------------------
 // Ufe::SceneItem overrides
 //------------------------------------------------------------------------------
@@ -20,6 +20,7 @@
 #include "ufe/sceneItem.h"
 
 #include "pxr/usd/usd/prim.h"
+#include "pxr/usd/sdf/path.h"
 
 PXR_NAMESPACE_USING_DIRECTIVE
 
@@ -46,11 +47,17 @@ public:
 
 	const UsdPrim& prim() const;
 
+	//! Return the USD path of the prim the item was created with, which
+	//! remains once the prim is removed, so callers needn't convert the UFE
+	//! path.  Empty if the item was created with an invalid prim.
+	const SdfPath& primPath() const;
+
 	// Ufe::SceneItem overrides
 	std::string nodeType() const override;
 
 private:
 	UsdPrim fPrim;
+	SdfPath fPrimPath;
 }; // UsdSceneItem
 
 } // namespace ufe
@@ -16,6 +16,10 @@
 
 #include "UsdStageMap.h"
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
 MAYAUSD_NS_DEF {
 namespace ufe {
 
@@ -25,6 +29,10 @@ namespace ufe {
 
 UsdStageMap g_StageMap;
 
+// Maximum number of prims cached per stage, enough for the Outliner to
+// browse large stages.
+static constexpr size_t kMaxCachedPrims = 65536;
+
 //------------------------------------------------------------------------------
 // UsdStageMap
 //------------------------------------------------------------------------------
@@ -53,10 +61,153 @@ Ufe::Path UsdStageMap::path(UsdStageWeakPtr stage) const
 	return Ufe::Path();
 }
 
+UsdPrim UsdStageMap::cachedPrim(const Ufe::Path& path)
+{
+	// There are few stages, so look the path up in the cache of each of them
+	// rather than building the proxy shape path to find its stage.
+	const size_t hash = std::hash<Ufe::Path>()(path);
+
+	std::lock_guard<std::mutex> lock(fPrimCachesMutex);
+	for (auto& stageCache : fPrimCaches)
+	{
+		PrimCache& cache = stageCache.second;
+		auto iter = cache.index.find(hash);
+		if (iter == std::end(cache.index))
+			continue;
+
+		auto entry = iter->second;
+		if (entry->path != path)
+			continue;
+
+		if (!entry->prim.IsValid())
+		{
+			cache.erase(entry);
+			return UsdPrim();
+		}
+
+		cache.entries.splice(std::begin(cache.entries), cache.entries, entry);
+		return entry->prim;
+	}
+	return UsdPrim();
+}
+
+void UsdStageMap::cachePrim(const Ufe::Path& path, const UsdPrim& prim)
+{
+	if (!prim.IsValid())
+		return;
+
+	const size_t hash = std::hash<Ufe::Path>()(path);
+
+	std::lock_guard<std::mutex> lock(fPrimCachesMutex);
+	PrimCache& cache = fPrimCaches[prim.GetStage()];
+
+	// Paths colliding on their hash replace each other.
+	auto iter = cache.index.find(hash);
+	if (iter != std::end(cache.index))
+		cache.erase(iter->second);
+
+	if (cache.entries.size() >= kMaxCachedPrims)
+		cache.erase(std::prev(std::end(cache.entries)));
+
+	cache.insert(path, hash, prim);
+}
+
+void UsdStageMap::invalidatePrims(UsdStageWeakPtr stage, const SdfPathVector& resyncedPaths)
+{
+	std::lock_guard<std::mutex> lock(fPrimCachesMutex);
+	auto cacheIter = fPrimCaches.find(stage);
+	if (cacheIter == std::end(fPrimCaches))
+		return;
+
+	PrimCache& cache = cacheIter->second;
+	for (const auto& resyncedPath : resyncedPaths)
+	{
+		if (resyncedPath.IsAbsoluteRootPath())
+		{
+			fPrimCaches.erase(cacheIter);
+			return;
+		}
+
+		// Property resyncs leave the prims untouched.
+		if (resyncedPath.IsPrimPath())
+			cache.eraseSubtree(resyncedPath);
+	}
+}
+
 void UsdStageMap::clear()
 {
 	fPathToStage.clear();
 	fStageToPath.clear();
+
+	std::lock_guard<std::mutex> lock(fPrimCachesMutex);
+	fPrimCaches.clear();
+}
+
+//------------------------------------------------------------------------------
+// UsdStageMap::PrimCache
+//------------------------------------------------------------------------------
+
+void UsdStageMap::PrimCache::insert(const Ufe::Path& path, size_t hash, const UsdPrim& prim)
+{
+	entries.push_front(Entry{path, hash, prim.GetPath(), prim});
+	index[hash] = std::begin(entries);
+	pathIndex[prim.GetPath()].push_back(std::begin(entries));
+}
+
+void UsdStageMap::PrimCache::erase(Entries::iterator entry)
+{
+	const SdfPath primPath = entry->primPath;
+
+	auto pathIter = pathIndex.find(primPath);
+	if (pathIter != std::end(pathIndex))
+	{
+		auto& pathEntries = pathIter->second;
+		pathEntries.erase(std::find(std::begin(pathEntries), std::end(pathEntries), entry));
+	}
+
+	index.erase(entry->hash);
+	entries.erase(entry);
+
+	prune(primPath);
+}
+
+void UsdStageMap::PrimCache::eraseSubtree(const SdfPath& primPath)
+{
+	// Cached prims have their ancestors in the table, so a path missing from
+	// the table has no cached descendants.
+	auto range = pathIndex.FindSubtreeRange(primPath);
+	if (range.first == range.second)
+		return;
+
+	for (auto pathIter = range.first; pathIter != range.second; ++pathIter)
+	{
+		for (auto entry : pathIter->second)
+		{
+			index.erase(entry->hash);
+			entries.erase(entry);
+		}
+	}
+
+	// Erasing a path from the table also erases its descendants.
+	pathIndex.erase(range.first);
+
+	prune(primPath.GetParentPath());
+}
+
+void UsdStageMap::PrimCache::prune(SdfPath primPath)
+{
+	// Drop the paths left with neither entries nor descendants.
+	while (!primPath.IsEmpty())
+	{
+		auto range = pathIndex.FindSubtreeRange(primPath);
+		if (range.first == range.second ||
+			!range.first->second.empty() ||
+			std::next(range.first) != range.second)
+			break;
+
+		pathIndex.erase(range.first);
+		primPath = primPath.GetParentPath();
+	}
 }
 
 } // namespace ufe
@@ -19,10 +19,16 @@
 
 #include "ufe/path.h"
 
+#include "pxr/usd/usd/prim.h"
 #include "pxr/usd/usd/stage.h"
+#include "pxr/usd/sdf/path.h"
+#include "pxr/usd/sdf/pathTable.h"
 #include "pxr/base/tf/hash.h"
 
+#include <list>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 PXR_NAMESPACE_USING_DIRECTIVE
 
@@ -38,6 +44,12 @@ namespace ufe {
 	node, but we assume here it will not be reparented.  We will also assume that
 	a USD stage will not be instanced (even though nothing in the data model
 	prevents it).
+
+	The map also keeps, for each stage, a least recently used cache of the
+	prims resolved from UFE paths, to avoid building a USD path from the path
+	segment string on every query.  Cached prims under resynced paths must be
+	invalidated by the stage observer.  Prim caches are guarded by a mutex
+	since prims may be resolved from any thread.
 */
 class MAYAUSD_CORE_PUBLIC UsdStageMap
 {
@@ -60,13 +72,53 @@ public:
 	//! Return the ProxyShape node UFE path for the argument stage.
 	Ufe::Path path(UsdStageWeakPtr stage) const;
 
+	//! Return the cached USD prim for the argument UFE path, or an invalid
+	//! prim if it is not cached.
+	UsdPrim cachedPrim(const Ufe::Path& path);
+
+	//! Cache the USD prim resolved from the argument UFE path.
+	void cachePrim(const Ufe::Path& path, const UsdPrim& prim);
+
+	//! Drop the cached prims of the argument stage at or under the resynced
+	//! paths.
+	void invalidatePrims(UsdStageWeakPtr stage, const SdfPathVector& resyncedPaths);
+
 	void clear();
 
 private:
+	// Prims resolved from UFE paths on a stage, most recently used first,
+	// indexed by UFE path hash and by prim path.
+	struct PrimCache
+	{
+		struct Entry
+		{
+			Ufe::Path path;
+			size_t    hash;
+			SdfPath   primPath;
+			UsdPrim   prim;
+		};
+		typedef std::list<Entry> Entries;
+
+		Entries entries;
+		std::unordered_map<size_t, Entries::iterator> index;
+
+		// Ancestors of the cached prims are implicitly in the table, without
+		// entries.
+		SdfPathTable<std::vector<Entries::iterator>> pathIndex;
+
+		void insert(const Ufe::Path& path, size_t hash, const UsdPrim& prim);
+		void erase(Entries::iterator entry);
+		void eraseSubtree(const SdfPath& primPath);
+		void prune(SdfPath primPath);
+	};
+
 	// We keep two maps for fast lookup when there are many proxy shapes.
 	std::unordered_map<Ufe::Path, UsdStageWeakPtr> fPathToStage;
 	TfHashMap<UsdStageWeakPtr, Ufe::Path, TfHash> fStageToPath;
 
+	TfHashMap<UsdStageWeakPtr, PrimCache, TfHash> fPrimCaches;
+	std::mutex fPrimCachesMutex;
+
 }; // UsdStageMap
 
 } // namespace ufe
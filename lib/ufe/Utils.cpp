@@ -76,16 +76,20 @@ Ufe::Path stagePath(UsdStageWeakPtr stage)
 
 UsdPrim ufePathToPrim(const Ufe::Path& path)
 {
+	UsdPrim prim = g_StageMap.cachedPrim(path);
+	if (prim)
+		return prim;
+
 	// Assume that there are only two segments in the path, the first a Maya
 	// Dag path segment to the proxy shape, which identifies the stage, and
 	// the second the USD segment.
 	const Ufe::Path::Segments& segments = path.getSegments();
 	TEST_USD_PATH(segments, path);
 
-	UsdPrim prim;
 	if (auto stage = getStage(Ufe::Path(segments[0])))
 	{
 		prim = stage->GetPrimAtPath(SdfPath(segments[1].string()));
+		g_StageMap.cachePrim(path, prim);
 	}
 	return prim;
 }
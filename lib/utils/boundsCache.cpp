@@ -0,0 +1,410 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "boundsCache.h"
+
+#include "pxr/base/gf/bbox3d.h"
+#include "pxr/base/gf/matrix4d.h"
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/vt/array.h"
+#include "pxr/usd/usd/primFlags.h"
+#include "pxr/usd/usdGeom/boundable.h"
+#include "pxr/usd/usdGeom/imageable.h"
+#include "pxr/usd/usdGeom/tokens.h"
+#include "pxr/usd/usdGeom/xformable.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+
+// Number of children from which the bounds of the children of a prim are
+// computed in parallel.
+constexpr size_t _MinParallelChildren = 4;
+
+// Bound reduced over children.
+struct _ReducedBound {
+    GfRange3d bound;
+    bool varying { false };
+};
+
+// Return the extent of a boundable prim, computed from its points when not
+// authored, and whether it may vary in time.
+GfRange3d
+_ComputeExtent(
+        const UsdGeomBoundable& boundable,
+        UsdTimeCode time,
+        bool* varying)
+{
+    VtVec3fArray extent;
+
+    const UsdAttribute extentAttr = boundable.GetExtentAttr();
+    if (extentAttr.HasAuthoredValue()) {
+        if (extentAttr.ValueMightBeTimeVarying()) {
+            *varying = true;
+        }
+        extentAttr.Get(&extent, time);
+    }
+    else {
+        // Attributes the extent is computed from are unknown.
+        *varying = true;
+        UsdGeomBoundable::ComputeExtentFromPlugins(boundable, time, &extent);
+    }
+
+    if (extent.size() != 2) {
+        return GfRange3d();
+    }
+
+    return GfRange3d(GfVec3d(extent[0]), GfVec3d(extent[1]));
+}
+
+// Return whether the prim and all its ancestors are visible at the time, as
+// UsdGeomImageable::ComputeVisibility, and whether it may vary in time.
+bool
+_ComputeInheritedVisibility(
+        const UsdPrim& prim,
+        UsdTimeCode time,
+        bool* varying)
+{
+    for (UsdPrim ancestor = prim; ancestor && !ancestor.IsPseudoRoot();
+            ancestor = ancestor.GetParent()) {
+        const UsdGeomImageable imageable = UsdGeomImageable(ancestor);
+        if (!imageable) {
+            continue;
+        }
+
+        const UsdAttribute visibilityAttr = imageable.GetVisibilityAttr();
+        if (visibilityAttr.ValueMightBeTimeVarying()) {
+            *varying = true;
+        }
+
+        TfToken visibility;
+        visibilityAttr.Get(&visibility, time);
+        if (visibility == UsdGeomTokens->invisible) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
+
+UsdMayaBoundsCache::UsdMayaBoundsCache(size_t maxNumTimes)
+    : _maxNumTimes(std::max(maxNumTimes, size_t(1)))
+{
+    _stageListener.SetStageObjectsChangedCallback(
+        [this](const UsdNotice::ObjectsChanged& notice) {
+            _OnObjectsChanged(notice);
+        });
+}
+
+UsdMayaBoundsCache::~UsdMayaBoundsCache() = default;
+
+void
+UsdMayaBoundsCache::SetStage(const UsdStageRefPtr& stage)
+{
+    if (_stage == stage) {
+        return;
+    }
+
+    _stage = stage;
+    _stageListener.SetStage(stage);
+    Clear();
+}
+
+void
+UsdMayaBoundsCache::SetIncludedPurposes(const TfTokenVector& purposes)
+{
+    if (_purposes == purposes) {
+        return;
+    }
+
+    _purposes = purposes;
+    Clear();
+}
+
+GfRange3d
+UsdMayaBoundsCache::ComputeUntransformedBound(
+        const UsdPrim& prim,
+        UsdTimeCode time)
+{
+    if (!prim) {
+        return GfRange3d();
+    }
+
+    if (prim.GetPath() != _requestedPath) {
+        ClearRequestedBounds();
+        _requestedPath = prim.GetPath();
+    }
+
+    if (_requestedStatic) {
+        return _requestedStaticBound;
+    }
+
+    for (auto it = _requestedBounds.begin(); it != _requestedBounds.end(); ++it) {
+        if (it->first == time) {
+            _requestedBounds.splice(_requestedBounds.begin(), _requestedBounds, it);
+            return it->second;
+        }
+    }
+
+    TfToken purpose = UsdGeomTokens->default_;
+    if (const UsdGeomImageable imageable = UsdGeomImageable(prim)) {
+        purpose = imageable.ComputePurpose();
+    }
+
+    // An invisible prim has an empty bound, like in UsdGeomBBoxCache, be it
+    // hidden itself or by an ancestor.
+    bool varying = false;
+    GfRange3d bound;
+    if (_ComputeInheritedVisibility(prim, time, &varying)) {
+        _NewEntries newEntries;
+        bound = _ComputeLocalBound(prim, purpose, time, newEntries, &varying);
+
+        for (auto& entries : newEntries) {
+            for (auto& entry : entries) {
+                _entries[entry.first] = std::move(entry.second);
+            }
+        }
+    }
+
+    if (!varying) {
+        _requestedStatic = true;
+        _requestedStaticBound = bound;
+        _requestedBounds.clear();
+    }
+    else {
+        _requestedBounds.emplace_front(time, bound);
+        if (_requestedBounds.size() > _maxNumTimes) {
+            _requestedBounds.pop_back();
+        }
+    }
+
+    return bound;
+}
+
+void
+UsdMayaBoundsCache::Clear()
+{
+    _entries.clear();
+    ClearRequestedBounds();
+}
+
+void
+UsdMayaBoundsCache::ClearRequestedBounds()
+{
+    _requestedStatic = false;
+    _requestedBounds.clear();
+}
+
+bool
+UsdMayaBoundsCache::_IsIncluded(const TfToken& purpose) const
+{
+    return purpose == UsdGeomTokens->default_ ||
+        std::find(_purposes.begin(), _purposes.end(), purpose) != _purposes.end();
+}
+
+// Return the bound of the prim and its descendants in the space of the prim.
+// The purpose of the prim is inherited by its descendants unless default.
+GfRange3d
+UsdMayaBoundsCache::_ComputeLocalBound(
+        const UsdPrim& prim,
+        const TfToken& purpose,
+        UsdTimeCode time,
+        _NewEntries& newEntries,
+        bool* varying) const
+{
+    GfRange3d bound;
+
+    if (!_IsIncluded(purpose)) {
+        return bound;
+    }
+
+    if (const UsdGeomBoundable boundable = UsdGeomBoundable(prim)) {
+        bound.UnionWith(_ComputeExtent(boundable, time, varying));
+    }
+
+    const auto childRange =
+        prim.GetFilteredChildren(UsdTraverseInstanceProxies());
+    const std::vector<UsdPrim> children(childRange.begin(), childRange.end());
+
+    if (children.size() < _MinParallelChildren) {
+        for (const UsdPrim& child : children) {
+            bound.UnionWith(
+                _ComputeBound(child, purpose, time, newEntries, varying));
+        }
+        return bound;
+    }
+
+    // Subtrees of the children are reduced by nested parallel tasks, so
+    // idle threads steal work from large subtrees.
+    const _ReducedBound childBound = tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, children.size()),
+        _ReducedBound(),
+        [&](const tbb::blocked_range<size_t>& range, _ReducedBound reduced) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                reduced.bound.UnionWith(_ComputeBound(
+                    children[i], purpose, time, newEntries, &reduced.varying));
+            }
+            return reduced;
+        },
+        [](_ReducedBound lhs, const _ReducedBound& rhs) {
+            lhs.bound.UnionWith(rhs.bound);
+            lhs.varying |= rhs.varying;
+            return lhs;
+        });
+
+    bound.UnionWith(childBound.bound);
+    *varying |= childBound.varying;
+
+    return bound;
+}
+
+// Return the cached bound of the prim and its descendants in the space of its
+// parent, computing it if invalid. Cached bounds are only read during the
+// traversal, computed ones are added to the cache afterwards.
+GfRange3d
+UsdMayaBoundsCache::_ComputeBound(
+        const UsdPrim& prim,
+        const TfToken& inheritedPurpose,
+        UsdTimeCode time,
+        _NewEntries& newEntries,
+        bool* varying) const
+{
+    const SdfPath& path = prim.GetPath();
+
+    const auto it = _entries.find(path);
+    if (it != _entries.end()) {
+        const _Entry& entry = it->second;
+        if (entry._valid &&
+                entry._inheritedPurpose == inheritedPurpose &&
+                (!entry._varying || entry._time == time)) {
+            *varying |= entry._varying;
+            return entry._bound;
+        }
+    }
+
+    GfRange3d bound;
+    bool primVarying = false;
+
+    TfToken purpose = inheritedPurpose;
+    bool visible = true;
+    if (const UsdGeomImageable imageable = UsdGeomImageable(prim)) {
+        const UsdAttribute visibilityAttr = imageable.GetVisibilityAttr();
+        if (visibilityAttr.ValueMightBeTimeVarying()) {
+            primVarying = true;
+        }
+
+        TfToken visibility;
+        visibilityAttr.Get(&visibility, time);
+        visible = (visibility != UsdGeomTokens->invisible);
+
+        if (purpose == UsdGeomTokens->default_) {
+            imageable.GetPurposeAttr().Get(&purpose);
+        }
+    }
+
+    if (visible) {
+        bound = _ComputeLocalBound(
+            prim, purpose, time, newEntries, &primVarying);
+
+        if (const UsdGeomXformable xformable = UsdGeomXformable(prim)) {
+            if (xformable.TransformMightBeTimeVarying()) {
+                primVarying = true;
+            }
+
+            GfMatrix4d transform;
+            bool resetsXformStack = false;
+            if (!bound.IsEmpty() &&
+                    xformable.GetLocalTransformation(
+                        &transform, &resetsXformStack, time)) {
+                bound = GfBBox3d(bound, transform).ComputeAlignedRange();
+            }
+        }
+    }
+
+    _Entry entry;
+    entry._bound = bound;
+    entry._time = time;
+    entry._inheritedPurpose = inheritedPurpose;
+    entry._varying = primVarying;
+    entry._valid = true;
+    newEntries.local().emplace_back(path, std::move(entry));
+
+    *varying |= primVarying;
+    return bound;
+}
+
+void
+UsdMayaBoundsCache::_InvalidateAncestors(const SdfPath& path)
+{
+    for (SdfPath ancestor = path; !ancestor.IsEmpty();
+            ancestor = ancestor.GetParentPath()) {
+        const auto it = _entries.find(ancestor);
+        if (it != _entries.end()) {
+            it->second._valid = false;
+        }
+    }
+}
+
+void
+UsdMayaBoundsCache::_OnObjectsChanged(const UsdNotice::ObjectsChanged& notice)
+{
+    ClearRequestedBounds();
+
+    for (const SdfPath& path : notice.GetResyncedPaths()) {
+        if (UsdPrim::IsPathInMaster(path)) {
+            Clear();
+            return;
+        }
+
+        if (path == SdfPath::AbsoluteRootPath()) {
+            Clear();
+            return;
+        }
+
+        // Descendants are unaffected by resynced properties.
+        if (path.IsPropertyPath()) {
+            _InvalidateAncestors(path.GetPrimPath());
+            continue;
+        }
+
+        const auto it = _entries.find(path);
+        if (it != _entries.end()) {
+            _entries.erase(it);
+        }
+        _InvalidateAncestors(path.GetParentPath());
+    }
+
+    for (const SdfPath& path : notice.GetChangedInfoOnlyPaths()) {
+        if (UsdPrim::IsPathInMaster(path)) {
+            Clear();
+            return;
+        }
+
+        _InvalidateAncestors(path.GetPrimPath());
+    }
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,153 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef PXRUSDMAYA_BOUNDSCACHE_H
+#define PXRUSDMAYA_BOUNDSCACHE_H
+
+/// \file usdMaya/boundsCache.h
+
+#include "../base/api.h"
+#include "../listeners/stageNoticeListener.h"
+
+#include "pxr/pxr.h"
+
+#include "pxr/base/gf/range3d.h"
+#include "pxr/base/tf/token.h"
+#include "pxr/usd/sdf/path.h"
+#include "pxr/usd/sdf/pathTable.h"
+#include "pxr/usd/usd/notice.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usd/timeCode.h"
+
+#include <tbb/enumerable_thread_specific.h>
+
+#include <list>
+#include <utility>
+#include <vector>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Caches the untransformed bounds of the prims of a stage, as computed by
+/// UsdGeomImageable::ComputeUntransformedBound, for the included purposes.
+///
+/// The bound of each prim, in the space of its parent, is cached along with
+/// whether it may vary in time. Bounds of static subtrees are shared by all
+/// times, while bounds of time-varying subtrees are only kept for the last
+/// time they were computed at. Bounds of the requested prims are kept for up
+/// to a given number of times, least recently used first to be released.
+///
+/// Bounds are computed by a parallel traversal, reducing the bounds of the
+/// children of each prim, and added to the cache once the traversal is done.
+///
+/// Stage changes invalidate the bounds of the changed prims and of their
+/// ancestors only, so the bounds of an ancestor are recomputed from the
+/// cached bounds of its unchanged children. Changes in instance masters
+/// invalidate all bounds since instance proxies are cached by path.
+///
+/// Main thread only.
+class UsdMayaBoundsCache
+{
+public:
+    /// Create a cache keeping bounds of requested prims for up to
+    /// \p maxNumTimes times.
+    MAYAUSD_CORE_PUBLIC
+    explicit UsdMayaBoundsCache(size_t maxNumTimes);
+
+    MAYAUSD_CORE_PUBLIC
+    ~UsdMayaBoundsCache();
+
+    /// Set the stage of the cached prims, releasing all bounds if it differs.
+    MAYAUSD_CORE_PUBLIC
+    void SetStage(const UsdStageRefPtr& stage);
+
+    /// Set the purposes of the prims included in bounds, releasing all
+    /// bounds if they differ. The default purpose is always included.
+    MAYAUSD_CORE_PUBLIC
+    void SetIncludedPurposes(const TfTokenVector& purposes);
+
+    /// Return the bound of \p prim and its descendants at \p time, in the
+    /// space of \p prim. The bound is empty if \p prim or any of its
+    /// ancestors is invisible.
+    MAYAUSD_CORE_PUBLIC
+    GfRange3d ComputeUntransformedBound(const UsdPrim& prim, UsdTimeCode time);
+
+    /// Release all bounds.
+    MAYAUSD_CORE_PUBLIC
+    void Clear();
+
+    /// Release bounds of the requested prims only, keeping bounds of all
+    /// descendants.
+    MAYAUSD_CORE_PUBLIC
+    void ClearRequestedBounds();
+
+private:
+    UsdMayaBoundsCache(const UsdMayaBoundsCache&) = delete;
+    UsdMayaBoundsCache& operator=(const UsdMayaBoundsCache&) = delete;
+
+    /// Cached bound of a prim and its descendants, in the space of its
+    /// parent.
+    struct _Entry {
+        GfRange3d   _bound;
+        UsdTimeCode _time;                  ///< Time of a time-varying bound
+        TfToken     _inheritedPurpose;      ///< Purpose inherited from the parent
+        bool        _varying { false };     ///< Whether the bound may vary in time
+        bool        _valid { false };       ///< Whether the bound was computed
+    };
+
+    /// Bounds computed by each thread during a traversal.
+    using _NewEntries = tbb::enumerable_thread_specific<
+        std::vector<std::pair<SdfPath, _Entry>>>;
+
+    bool _IsIncluded(const TfToken& purpose) const;
+
+    GfRange3d _ComputeLocalBound(
+            const UsdPrim& prim,
+            const TfToken& purpose,
+            UsdTimeCode time,
+            _NewEntries& newEntries,
+            bool* varying) const;
+
+    GfRange3d _ComputeBound(
+            const UsdPrim& prim,
+            const TfToken& inheritedPurpose,
+            UsdTimeCode time,
+            _NewEntries& newEntries,
+            bool* varying) const;
+
+    void _InvalidateAncestors(const SdfPath& path);
+
+    void _OnObjectsChanged(const UsdNotice::ObjectsChanged& notice);
+
+    UsdStageRefPtr _stage;
+    UsdMayaStageNoticeListener _stageListener;
+    TfTokenVector _purposes;
+    SdfPathTable<_Entry> _entries;
+
+    // Bounds of the last requested prim.
+    SdfPath _requestedPath;
+    GfRange3d _requestedStaticBound;
+    bool _requestedStatic { false };
+    std::list<std::pair<UsdTimeCode, GfRange3d>> _requestedBounds;
+    const size_t _maxNumTimes;
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+
+#endif
@@ -17,31 +17,193 @@
 
 #include "../listeners/notice.h"
 
+#include "pxr/base/tf/envSetting.h"
 #include "pxr/usd/sdf/attributeSpec.h"
 #include "pxr/usd/sdf/layer.h"
 #include "pxr/usd/sdf/primSpec.h"
 #include "pxr/usd/sdf/relationshipSpec.h"
+#include "pxr/usd/usd/primRange.h"
 #include "pxr/usd/usd/stageCache.h"
 #include "pxr/usd/usdGeom/tokens.h"
 
+#include <boost/functional/hash.hpp>
+
 #include <maya/MFileIO.h>
+#include <maya/MGlobal.h>
 #include <maya/MSceneMessage.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 
 PXR_NAMESPACE_OPEN_SCOPE
 
 
+TF_DEFINE_ENV_SETTING(MAYAUSD_STAGE_CACHE_MAX_UNREFERENCED_STAGES, 4,
+    "Number of stages no proxy shape references any more that are kept in "
+    "the stage cache for quick reuse.");
+
+
 namespace {
 
-static std::map<std::string, SdfLayerRefPtr> _sharedSessionLayers;
+// Key of a shared session layer, with interned names and a hash computed
+// once.
+struct _SessionLayerKey {
+    SdfPath rootPath;
+    std::vector<std::pair<TfToken, TfToken>> variantSelections;
+    TfToken drawMode;
+    size_t hash = 0u;
+
+    _SessionLayerKey(
+            const SdfPath& rootPath_,
+            const std::map<std::string, std::string>& variantSelections_,
+            const TfToken& drawMode_)
+        : rootPath(rootPath_)
+        , drawMode(drawMode_)
+    {
+        hash = SdfPath::Hash()(rootPath);
+
+        // Selections are sorted by variant set since they come from a map.
+        variantSelections.reserve(variantSelections_.size());
+        for (const auto& pair : variantSelections_) {
+            variantSelections.emplace_back(
+                TfToken(pair.first), TfToken(pair.second));
+            boost::hash_combine(hash, variantSelections.back().first.Hash());
+            boost::hash_combine(hash, variantSelections.back().second.Hash());
+        }
+
+        boost::hash_combine(hash, drawMode.Hash());
+    }
+
+    bool operator==(const _SessionLayerKey& other) const
+    {
+        return hash == other.hash &&
+            rootPath == other.rootPath &&
+            drawMode == other.drawMode &&
+            variantSelections == other.variantSelections;
+    }
+
+    struct Hash {
+        size_t operator()(const _SessionLayerKey& key) const
+        {
+            return key.hash;
+        }
+    };
+};
+
+using _SessionLayerMap = std::unordered_map<
+    _SessionLayerKey, SdfLayerRefPtr, _SessionLayerKey::Hash>;
+
+static _SessionLayerMap _sharedSessionLayers;
+static std::unordered_map<const SdfLayer*, _SessionLayerKey>
+    _sharedSessionLayerIndex;
+static UsdMayaStageCache::SessionLayerStats _sharedSessionLayerStats;
 static std::mutex _sharedSessionLayersMutex;
 
+// Release the shared session layer if only the shared map references it.
+// Called with the mutex locked.
+void
+_ReleaseUnusedSessionLayer(_SessionLayerMap::iterator it)
+{
+    if (it->second->GetCurrentCount() > 1) {
+        return;
+    }
+
+    _sharedSessionLayerIndex.erase(get_pointer(it->second));
+    _sharedSessionLayers.erase(it);
+    _sharedSessionLayerStats.numCollected++;
+}
+
+// Rough memory costs of a composed prim and of a used layer.
+constexpr size_t _BytesPerPrim = 1024u;
+constexpr size_t _BytesPerLayer = 64u * 1024u;
+
+// A stage referenced by owners, or released by all of them.
+struct _TrackedStage {
+    UsdStagePtr stage;
+    std::string rootLayerPath;
+    size_t numReferences = 0u;
+    uint64_t releaseSequence = 0u;  // Order in which stages were released
+};
+
+// Tracked stages, indexed by stage, by owner and by root layer path.
+struct _StageRegistry {
+    std::mutex mutex;
+    std::unordered_map<const UsdStage*, _TrackedStage> stages;
+    std::unordered_map<const void*, const UsdStage*> owners;
+    std::unordered_map<std::string, std::unordered_set<const UsdStage*>>
+        rootLayerIndex;
+    uint64_t releaseSequence = 0u;
+
+    void RemoveFromIndex(const UsdStage* key, const std::string& rootLayerPath)
+    {
+        auto it = rootLayerIndex.find(rootLayerPath);
+        if (it != rootLayerIndex.end()) {
+            it->second.erase(key);
+            if (it->second.empty()) {
+                rootLayerIndex.erase(it);
+            }
+        }
+    }
+
+    void Clear()
+    {
+        stages.clear();
+        owners.clear();
+        rootLayerIndex.clear();
+    }
+};
+
+_StageRegistry&
+_GetStageRegistry()
+{
+    static _StageRegistry registry;
+    return registry;
+}
+
+// Whether an eviction of unreferenced stages is pending on idle.
+std::atomic<bool> _evictionScheduled{ false };
+
+void
+_EvictUnreferencedStagesOnIdle(void*)
+{
+    _evictionScheduled = false;
+
+    const int maxNumUnreferenced =
+        TfGetEnvSetting(MAYAUSD_STAGE_CACHE_MAX_UNREFERENCED_STAGES);
+    UsdMayaStageCache::EvictUnreferencedStages(
+        static_cast<size_t>(std::max(maxNumUnreferenced, 0)));
+}
+
+// Evict the unreferenced stages on the main thread once idle, since stages
+// are released from DG computes, possibly during parallel evaluation, where
+// other stages must not be destroyed.
+void
+_ScheduleEviction()
+{
+    if (!_evictionScheduled.exchange(true)) {
+        MGlobal::executeTaskOnIdle(_EvictUnreferencedStagesOnIdle);
+    }
+}
+
+// Return the identifier of the layer at the path if opened, else the path.
+std::string
+_GetRootLayerKey(const std::string& layerPath)
+{
+    const SdfLayerHandle layer = SdfLayer::Find(layerPath);
+    return layer ? layer->GetIdentifier() : layerPath;
+}
+
 struct _OnSceneResetListener : public TfWeakBase {
     _OnSceneResetListener()
     {
@@ -55,6 +217,7 @@ struct _OnSceneResetListener : public TfWeakBase {
         UsdMayaStageCache::Clear();
 
         std::lock_guard<std::mutex> lock(_sharedSessionLayersMutex);
+        _sharedSessionLayerIndex.clear();
         _sharedSessionLayers.clear();
     }
 };
@@ -76,6 +239,12 @@ UsdMayaStageCache::Get(const bool forcePopulate)
 void
 UsdMayaStageCache::Clear()
 {
+    {
+        _StageRegistry& registry = _GetStageRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.Clear();
+    }
+
     Get(true).Clear();
     Get(false).Clear();
 }
@@ -97,26 +266,224 @@ UsdMayaStageCache::EraseAllStagesWithRootLayerPath(const std::string& layerPath)
     return erasedStages;
 }
 
+/* static */
+void
+UsdMayaStageCache::SetStageReference(
+        const void* owner,
+        const UsdStageRefPtr& stage)
+{
+    bool released = false;
+
+    {
+        _StageRegistry& registry = _GetStageRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        const auto ownerIt = registry.owners.find(owner);
+        const UsdStage* previous =
+            ownerIt != registry.owners.end() ? ownerIt->second : nullptr;
+        if (previous == get_pointer(stage)) {
+            return;
+        }
+
+        if (previous) {
+            registry.owners.erase(ownerIt);
+
+            const auto it = registry.stages.find(previous);
+            if (it != registry.stages.end() &&
+                    it->second.numReferences > 0u &&
+                    --it->second.numReferences == 0u) {
+                it->second.releaseSequence = ++registry.releaseSequence;
+                released = true;
+            }
+        }
+
+        if (stage) {
+            _TrackedStage& tracked = registry.stages[get_pointer(stage)];
+
+            // A new stage may be allocated where an expired one was.
+            if (!tracked.stage) {
+                registry.RemoveFromIndex(
+                    get_pointer(stage), tracked.rootLayerPath);
+
+                tracked = _TrackedStage();
+                tracked.stage = stage;
+                tracked.rootLayerPath = stage->GetRootLayer()->GetIdentifier();
+                registry.rootLayerIndex[tracked.rootLayerPath].insert(
+                    get_pointer(stage));
+            }
+
+            tracked.numReferences++;
+            registry.owners[owner] = get_pointer(stage);
+        }
+    }
+
+    if (released) {
+        _ScheduleEviction();
+    }
+}
+
+/* static */
+std::vector<UsdStageRefPtr>
+UsdMayaStageCache::FindTrackedStagesWithRootLayerPath(
+        const std::string& layerPath)
+{
+    std::vector<UsdStageRefPtr> stages;
+
+    const std::string key = _GetRootLayerKey(layerPath);
+
+    _StageRegistry& registry = _GetStageRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    const auto indexIt = registry.rootLayerIndex.find(key);
+    if (indexIt == registry.rootLayerIndex.end()) {
+        return stages;
+    }
+
+    for (const UsdStage* stageKey : indexIt->second) {
+        const auto it = registry.stages.find(stageKey);
+        if (it != registry.stages.end() && it->second.stage) {
+            stages.push_back(UsdStageRefPtr(it->second.stage));
+        }
+    }
+
+    return stages;
+}
+
+/* static */
+size_t
+UsdMayaStageCache::EvictUnreferencedStages(size_t maxNumUnreferenced)
+{
+    // Stages are erased from the caches once the registry is unlocked, since
+    // erasing the last reference to a stage destroys it.
+    std::vector<UsdStageRefPtr> evictedStages;
+
+    {
+        _StageRegistry& registry = _GetStageRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        std::vector<std::pair<uint64_t, const UsdStage*>> unreferenced;
+        for (auto it = registry.stages.begin(); it != registry.stages.end(); ) {
+            if (!it->second.stage) {
+                registry.RemoveFromIndex(it->first, it->second.rootLayerPath);
+                it = registry.stages.erase(it);
+                continue;
+            }
+
+            if (it->second.numReferences == 0u) {
+                unreferenced.emplace_back(it->second.releaseSequence, it->first);
+            }
+            ++it;
+        }
+
+        if (unreferenced.size() <= maxNumUnreferenced) {
+            return 0u;
+        }
+
+        // Keep the most recently released stages.
+        std::sort(unreferenced.begin(), unreferenced.end(),
+            [](const std::pair<uint64_t, const UsdStage*>& lhs,
+               const std::pair<uint64_t, const UsdStage*>& rhs) {
+                return lhs.first > rhs.first;
+            });
+
+        for (size_t i = maxNumUnreferenced; i < unreferenced.size(); ++i) {
+            const auto it = registry.stages.find(unreferenced[i].second);
+            evictedStages.push_back(UsdStageRefPtr(it->second.stage));
+            registry.RemoveFromIndex(it->first, it->second.rootLayerPath);
+            registry.stages.erase(it);
+        }
+    }
+
+    size_t numEvicted = 0u;
+    std::vector<SdfLayerHandle> sessionLayers;
+    for (const UsdStageRefPtr& stage : evictedStages) {
+        if (Get(true).Erase(stage) || Get(false).Erase(stage)) {
+            ++numEvicted;
+        }
+        sessionLayers.push_back(stage->GetSessionLayer());
+    }
+
+    // Shared session layers only used by the evicted stages are released
+    // along with them.
+    evictedStages.clear();
+
+    std::lock_guard<std::mutex> lock(_sharedSessionLayersMutex);
+    for (const SdfLayerHandle& sessionLayer : sessionLayers) {
+        const auto it = _sharedSessionLayerIndex.find(get_pointer(sessionLayer));
+        if (it != _sharedSessionLayerIndex.end()) {
+            _ReleaseUnusedSessionLayer(_sharedSessionLayers.find(it->second));
+        }
+    }
+
+    return numEvicted;
+}
+
+/* static */
+std::vector<UsdMayaStageCache::StageInfo>
+UsdMayaStageCache::GetStageInfos(const std::string& layerPath)
+{
+    std::vector<StageInfo> infos;
+
+    // Stages are filtered by root layer before their prims are counted.
+    SdfLayerHandle rootLayer;
+    if (!layerPath.empty()) {
+        rootLayer = SdfLayer::Find(layerPath);
+        if (!rootLayer) {
+            return infos;
+        }
+    }
+
+    for (const bool forcePopulate : { true, false }) {
+        const std::vector<UsdStageRefPtr> stages = rootLayer ?
+            Get(forcePopulate).FindAllMatching(rootLayer) :
+            Get(forcePopulate).GetAllStages();
+
+        for (const UsdStageRefPtr& stage : stages) {
+            StageInfo info;
+            info.stage = stage;
+            info.rootLayerPath = stage->GetRootLayer()->GetIdentifier();
+            info.forcePopulate = forcePopulate;
+            info.numReferences = 0u;
+            info.tracked = false;
+
+            {
+                _StageRegistry& registry = _GetStageRegistry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+
+                const auto it = registry.stages.find(get_pointer(stage));
+                if (it != registry.stages.end() && it->second.stage) {
+                    info.numReferences = it->second.numReferences;
+                    info.tracked = true;
+                }
+            }
+
+            info.numLayers = stage->GetUsedLayers().size();
+            const UsdPrimRange prims = stage->TraverseAll();
+            info.numPrims = std::distance(prims.begin(), prims.end());
+            info.memoryEstimate =
+                info.numLayers * _BytesPerLayer + info.numPrims * _BytesPerPrim;
+
+            infos.push_back(std::move(info));
+        }
+    }
+
+    return infos;
+}
+
+/* static */
 SdfLayerRefPtr
 UsdMayaStageCache::GetSharedSessionLayer(
     const SdfPath& rootPath,
     const std::map<std::string, std::string>& variantSelections,
     const TfToken& drawMode)
 {
-    // Example key: "/Root/Path:modelingVariant=round|shadingVariant=red|:cards"
-    std::ostringstream key;
-    key << rootPath;
-    key << ":";
-    for (const auto& pair : variantSelections) {
-        key << pair.first << "=" << pair.second << "|";
-    }
-    key << ":";
-    key << drawMode;
+    _SessionLayerKey key(rootPath, variantSelections, drawMode);
 
-    std::string keyString = key.str();
     std::lock_guard<std::mutex> lock(_sharedSessionLayersMutex);
-    auto iter = _sharedSessionLayers.find(keyString);
+    auto iter = _sharedSessionLayers.find(key);
     if (iter == _sharedSessionLayers.end()) {
+        _sharedSessionLayerStats.numMisses++;
+
         SdfLayerRefPtr newLayer = SdfLayer::CreateAnonymous();
 
         SdfPrimSpecHandle over = SdfCreatePrimInLayer(newLayer, rootPath);
@@ -141,12 +508,40 @@ UsdMayaStageCache::GetSharedSessionLayer(
             applyDrawModeAttr->SetDefaultValue(VtValue(true));
         }
 
-        _sharedSessionLayers[keyString] = newLayer;
+        _sharedSessionLayerIndex.emplace(get_pointer(newLayer), key);
+        _sharedSessionLayers.emplace(std::move(key), newLayer);
         return newLayer;
     }
     else {
+        _sharedSessionLayerStats.numHits++;
         return iter->second;
     }
 }
 
+/* static */
+size_t
+UsdMayaStageCache::CollectUnusedSessionLayers()
+{
+    std::lock_guard<std::mutex> lock(_sharedSessionLayersMutex);
+
+    const size_t numLayers = _sharedSessionLayers.size();
+    for (auto it = _sharedSessionLayers.begin();
+            it != _sharedSessionLayers.end(); ) {
+        _ReleaseUnusedSessionLayer(it++);
+    }
+
+    return numLayers - _sharedSessionLayers.size();
+}
+
+/* static */
+UsdMayaStageCache::SessionLayerStats
+UsdMayaStageCache::GetSessionLayerStats()
+{
+    std::lock_guard<std::mutex> lock(_sharedSessionLayersMutex);
+
+    SessionLayerStats stats = _sharedSessionLayerStats;
+    stats.numLive = _sharedSessionLayers.size();
+    return stats;
+}
+
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -23,17 +23,47 @@
 #include "pxr/pxr.h"
 
 #include "pxr/usd/sdf/path.h"
+#include "pxr/usd/usd/stage.h"
 #include "pxr/usd/usd/stageCache.h"
 
+#include <map>
 #include <string>
+#include <vector>
 
 
 PXR_NAMESPACE_OPEN_SCOPE
 
 
+/// Stage caches shared by all USD clients within Maya.
+///
+/// Stages may be tracked as referenced by owners such as proxy shapes. Once
+/// a tracked stage isn't referenced any more, it stays cached for quick
+/// reuse until too many unreferenced stages are cached, the least recently
+/// released first to be evicted. Stages that were never tracked are never
+/// evicted. Tracking is safe to call from any thread, eviction is deferred
+/// to the main thread once idle.
 class UsdMayaStageCache
 {
 public:
+    /// Description of a cached stage.
+    struct StageInfo {
+        UsdStageRefPtr stage;
+        std::string rootLayerPath;
+        bool forcePopulate;
+        size_t numReferences;   ///< Number of owners referencing the stage
+        bool tracked;           ///< Whether the stage was ever referenced
+        size_t numLayers;       ///< Number of layers used by the stage
+        size_t numPrims;        ///< Number of prims of the stage
+        size_t memoryEstimate;  ///< Rough estimate in bytes, from the counts
+    };
+
+    /// Counters of the shared session layers.
+    struct SessionLayerStats {
+        size_t numHits = 0u;        ///< Requests of an existing layer
+        size_t numMisses = 0u;      ///< Requests creating a layer
+        size_t numCollected = 0u;   ///< Layers released once unused
+        size_t numLive = 0u;        ///< Layers currently shared
+    };
 
     /// Return the singleton stage cache for use by all USD clients within Maya.
     /// 2 stage caches are maintained; 1 for stages that have been
@@ -53,14 +83,56 @@ public:
     static size_t EraseAllStagesWithRootLayerPath(
             const std::string& layerPath);
 
+    /// Track \p stage as referenced by \p owner, releasing the stage
+    /// \p owner referenced before, if any. A null stage only releases it.
+    /// Releasing a stage schedules the eviction of unreferenced stages on
+    /// idle.
+    MAYAUSD_CORE_PUBLIC
+    static void SetStageReference(
+            const void* owner,
+            const UsdStageRefPtr& stage);
+
+    /// Return the cached stages whose root layer path is \p layerPath
+    /// among the tracked ones.
+    MAYAUSD_CORE_PUBLIC
+    static std::vector<UsdStageRefPtr> FindTrackedStagesWithRootLayerPath(
+            const std::string& layerPath);
+
+    /// Evict tracked stages nobody references, keeping at most
+    /// \p maxNumUnreferenced of them, most recently released first.
+    ///
+    /// The number of stages evicted from the caches is returned.
+    MAYAUSD_CORE_PUBLIC
+    static size_t EvictUnreferencedStages(size_t maxNumUnreferenced);
+
+    /// Return a description of the stages of both caches, only of those
+    /// whose root layer path is \p layerPath unless empty. Counts of layers
+    /// and prims are computed by this call, for the returned stages only.
+    MAYAUSD_CORE_PUBLIC
+    static std::vector<StageInfo> GetStageInfos(
+            const std::string& layerPath = std::string());
+
     /// Gets (or creates) a shared session layer tied with the given variant
     /// selections and draw mode on the given root path.
-    /// The stage is cached for the lifetime of the current Maya scene.
+    /// The layer is cached until no stage uses it any more, at most for the
+    /// lifetime of the current Maya scene. Layers used by evicted stages are
+    /// released along with them.
     MAYAUSD_CORE_PUBLIC
     static SdfLayerRefPtr GetSharedSessionLayer(
             const SdfPath& rootPath,
             const std::map<std::string, std::string>& variantSelections,
             const TfToken& drawMode);
+
+    /// Release the shared session layers nothing else than the cache
+    /// references.
+    ///
+    /// The number of released layers is returned.
+    MAYAUSD_CORE_PUBLIC
+    static size_t CollectUnusedSessionLayers();
+
+    /// Return the counters of the shared session layers.
+    MAYAUSD_CORE_PUBLIC
+    static SessionLayerStats GetSessionLayerStats();
 };
 
 
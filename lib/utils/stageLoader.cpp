@@ -0,0 +1,257 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "stageLoader.h"
+
+#include "stageCache.h"
+#include "../base/debugCodes.h"
+
+#include "pxr/base/gf/vec3f.h"
+#include "pxr/base/tf/debug.h"
+#include "pxr/base/vt/array.h"
+#include "pxr/usd/sdf/attributeSpec.h"
+#include "pxr/usd/sdf/primSpec.h"
+#include "pxr/usd/usd/stageCache.h"
+#include "pxr/usd/usdGeom/tokens.h"
+
+#include <limits>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+namespace {
+
+// Progress once the root layer is open, then once the stage is open.
+constexpr float _RootLayerProgress = 0.1f;
+constexpr float _StageProgress = 0.3f;
+
+// Add the extents hint, or else the extent, authored on the prim spec to
+// the bounds.
+void
+_AddAuthoredBounds(
+        const SdfLayerHandle& layer,
+        const SdfPath& primPath,
+        GfRange3d* bounds)
+{
+    for (const TfToken& name : { UsdGeomTokens->extentsHint,
+                                 UsdGeomTokens->extent }) {
+        const SdfAttributeSpecHandle attr =
+            layer->GetAttributeAtPath(primPath.AppendProperty(name));
+        if (!attr) {
+            continue;
+        }
+
+        // The first pair of an extents hint is the extent of the default
+        // purpose.
+        const VtValue value = attr->GetDefaultValue();
+        if (value.IsHolding<VtVec3fArray>()) {
+            const VtVec3fArray& extent = value.UncheckedGet<VtVec3fArray>();
+            if (extent.size() >= 2) {
+                bounds->UnionWith(GfRange3d(GfVec3d(extent[0]), GfVec3d(extent[1])));
+                return;
+            }
+        }
+    }
+}
+
+// Return the bounds authored on the default prim of the layer, or on all
+// its root prims if there is no default prim.
+GfRange3d
+_ReadPlaceholderBounds(const SdfLayerHandle& layer)
+{
+    GfRange3d bounds;
+
+    const TfToken defaultPrim = layer->GetDefaultPrim();
+    if (!defaultPrim.IsEmpty()) {
+        _AddAuthoredBounds(layer,
+            SdfPath::AbsoluteRootPath().AppendChild(defaultPrim), &bounds);
+    }
+    else {
+        for (const SdfPrimSpecHandle& prim : layer->GetRootPrims()) {
+            _AddAuthoredBounds(layer, prim->GetPath(), &bounds);
+        }
+    }
+
+    return bounds;
+}
+
+} // anonymous namespace
+
+
+UsdMayaStageLoader::UsdMayaStageLoader(
+        const std::string& filePath,
+        const SdfLayerRefPtr& sessionLayer,
+        const ArResolverContext& resolverContext,
+        bool loadPayloadsProgressively)
+    : _filePath(filePath)
+    , _sessionLayer(sessionLayer)
+    , _resolverContext(resolverContext)
+    , _loadPayloadsProgressively(loadPayloadsProgressively)
+{
+    _thread = std::thread([this]() { _Load(); });
+}
+
+UsdMayaStageLoader::~UsdMayaStageLoader()
+{
+    Cancel();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+UsdStageRefPtr
+UsdMayaStageLoader::GetStage() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stage;
+}
+
+GfRange3d
+UsdMayaStageLoader::GetPlaceholderBounds() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _placeholderBounds;
+}
+
+void
+UsdMayaStageLoader::Cancel()
+{
+    _cancelled = true;
+}
+
+/* static */
+const char*
+UsdMayaStageLoader::GetStateName(State state)
+{
+    switch (state) {
+        case State::Loading:   return "loading";
+        case State::Ready:     return "ready";
+        case State::Cancelled: return "cancelled";
+        case State::Failed:    return "failed";
+    }
+    return "";
+}
+
+void
+UsdMayaStageLoader::_Load()
+{
+    TF_DEBUG(USDMAYA_PROXYSHAPEBASE).Msg(
+        "UsdMayaStageLoader: loading %s\n", _filePath.c_str());
+
+    const SdfLayerRefPtr rootLayer = SdfLayer::FindOrOpen(_filePath);
+    if (!rootLayer) {
+        _state = State::Failed;
+        return;
+    }
+
+    {
+        const GfRange3d bounds = _ReadPlaceholderBounds(rootLayer);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _placeholderBounds = bounds;
+    }
+    _progress = _RootLayerProgress;
+
+    if (_cancelled) {
+        _state = State::Cancelled;
+        return;
+    }
+
+    // A stage already in the cache is shared as is. Otherwise the stage is
+    // opened outside of the cache, so it can be released if cancelled.
+    UsdStageCache& stageCache = UsdMayaStageCache::Get();
+    UsdStageRefPtr stage = _sessionLayer ?
+        stageCache.FindOneMatching(rootLayer, _sessionLayer, _resolverContext) :
+        stageCache.FindOneMatching(rootLayer, _resolverContext);
+
+    if (!stage) {
+        const UsdStage::InitialLoadSet loadSet = _loadPayloadsProgressively ?
+            UsdStage::LoadNone : UsdStage::LoadAll;
+
+        stage = _sessionLayer ?
+            UsdStage::Open(rootLayer, _sessionLayer, _resolverContext, loadSet) :
+            UsdStage::Open(rootLayer, _resolverContext, loadSet);
+
+        _progress = _StageProgress;
+
+        if (!stage || _cancelled ||
+            (_loadPayloadsProgressively && !_LoadPayloads(stage))) {
+            _state = _cancelled ? State::Cancelled : State::Failed;
+            return;
+        }
+
+        stageCache.Insert(stage);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stage = stage;
+    }
+    _progress = 1.0f;
+    _state = State::Ready;
+
+    TF_DEBUG(USDMAYA_PROXYSHAPEBASE).Msg(
+        "UsdMayaStageLoader: loaded %s\n", _filePath.c_str());
+}
+
+bool
+UsdMayaStageLoader::_LoadPayloads(const UsdStageRefPtr& stage)
+{
+    size_t numLoaded = 0;
+
+    while (!_cancelled) {
+        // Payloads nested in unloaded ones are only found once their parent
+        // payload is loaded.
+        const SdfPathSet loadable = stage->FindLoadable();
+        const SdfPathSet loaded = stage->GetLoadSet();
+
+        SdfPathSet shallowest;
+        size_t numUnloaded = 0;
+        size_t minDepth = std::numeric_limits<size_t>::max();
+        for (const SdfPath& path : loadable) {
+            if (loaded.count(path)) {
+                continue;
+            }
+
+            numUnloaded++;
+
+            const size_t depth = path.GetPathElementCount();
+            if (depth < minDepth) {
+                minDepth = depth;
+                shallowest.clear();
+            }
+            if (depth == minDepth) {
+                shallowest.insert(path);
+            }
+        }
+
+        if (shallowest.empty()) {
+            return true;
+        }
+
+        stage->LoadAndUnload(shallowest, SdfPathSet(), UsdLoadWithoutDescendants);
+
+        const size_t numKnown = numLoaded + numUnloaded;
+        numLoaded += shallowest.size();
+
+        _progress = _StageProgress + (1.0f - _StageProgress) *
+            static_cast<float>(numLoaded) / static_cast<float>(numKnown);
+    }
+
+    return false;
+}
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,137 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef PXRUSDMAYA_STAGELOADER_H
+#define PXRUSDMAYA_STAGELOADER_H
+
+/// \file usdMaya/stageLoader.h
+
+#include "../base/api.h"
+
+#include "pxr/pxr.h"
+
+#include "pxr/base/gf/range3d.h"
+#include "pxr/usd/ar/resolverContext.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/usd/stage.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+
+/// Opens a USD stage on a dedicated thread.
+///
+/// Opening a stage blocks for the whole load, so it runs on its own thread
+/// rather than on a TBB worker, which would be taken from the pool used by
+/// the parallel work of composition and drawing.
+///
+/// The stage is opened without payloads when they are loaded progressively,
+/// then the shallowest unloaded payloads are loaded, level by level, until
+/// all of them are loaded. The stage is only published once fully loaded, so
+/// it is never read by the main thread while composed, and inserted in the
+/// stage cache of Maya. Bounds authored on the root prims of the root layer
+/// are available as a placeholder while loading.
+///
+/// Loading can be cancelled between steps, and the stage is released unless
+/// it was already in the cache.
+class UsdMayaStageLoader
+{
+public:
+    /// State of the loader.
+    enum class State {
+        Loading,    ///< The stage is being opened
+        Ready,      ///< The stage is fully loaded
+        Cancelled,  ///< Loading was cancelled
+        Failed      ///< The root layer couldn't be opened
+    };
+
+    /// Start loading the stage of \p filePath with the given session layer,
+    /// which may be null, and path resolver context.
+    MAYAUSD_CORE_PUBLIC
+    UsdMayaStageLoader(
+            const std::string& filePath,
+            const SdfLayerRefPtr& sessionLayer,
+            const ArResolverContext& resolverContext,
+            bool loadPayloadsProgressively);
+
+    /// Cancel loading and wait for the loading thread.
+    MAYAUSD_CORE_PUBLIC
+    ~UsdMayaStageLoader();
+
+    /// Return the path of the root layer being loaded.
+    const std::string& GetFilePath() const { return _filePath; }
+
+    /// Return the session layer the stage is opened with.
+    const SdfLayerRefPtr& GetSessionLayer() const { return _sessionLayer; }
+
+    /// Return the state of the loader.
+    State GetState() const { return _state; }
+
+    /// Return the loading progress, from 0 to 1.
+    float GetProgress() const { return _progress; }
+
+    /// Return the loaded stage, or null unless the state is Ready.
+    MAYAUSD_CORE_PUBLIC
+    UsdStageRefPtr GetStage() const;
+
+    /// Return the bounds authored on the root prims of the root layer,
+    /// empty if none or not read yet.
+    MAYAUSD_CORE_PUBLIC
+    GfRange3d GetPlaceholderBounds() const;
+
+    /// Request cancellation of the loading. The state becomes Cancelled
+    /// once the loading thread has stopped.
+    MAYAUSD_CORE_PUBLIC
+    void Cancel();
+
+    /// Return the name of \p state.
+    MAYAUSD_CORE_PUBLIC
+    static const char* GetStateName(State state);
+
+private:
+    UsdMayaStageLoader(const UsdMayaStageLoader&) = delete;
+    UsdMayaStageLoader& operator=(const UsdMayaStageLoader&) = delete;
+
+    void _Load();
+    bool _LoadPayloads(const UsdStageRefPtr& stage);
+
+    const std::string _filePath;
+    const SdfLayerRefPtr _sessionLayer;
+    const ArResolverContext _resolverContext;
+    const bool _loadPayloadsProgressively;
+
+    std::atomic<State> _state{ State::Loading };
+    std::atomic<float> _progress{ 0.0f };
+    std::atomic<bool> _cancelled{ false };
+
+    // Results of the loading thread, protected by _mutex.
+    UsdStageRefPtr _stage;
+    GfRange3d _placeholderBounds;
+    mutable std::mutex _mutex;
+
+    // Started last, once the other members are initialized.
+    std::thread _thread;
+};
+
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+
+#endif
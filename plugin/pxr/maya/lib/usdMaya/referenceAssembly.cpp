@@ -300,6 +300,7 @@ UsdMayaReferenceAssembly::UsdMayaReferenceAssembly() :
 
 UsdMayaReferenceAssembly::~UsdMayaReferenceAssembly()
 {
+    UsdMayaStageCache::SetStageReference(this, nullptr);
 }
 
 
@@ -915,6 +916,9 @@ UsdMayaReferenceAssembly::computeOutStageData(MDataBlock& dataBlock)
         reinterpret_cast<MayaUsdStageData*>(pluginDataFn.data(&retValue));
     CHECK_MSTATUS_AND_RETURN_IT(retValue);
 
+    // Stages no assembly references any more may be evicted from the cache.
+    UsdMayaStageCache::SetStageReference(this, usdStage);
+
     // Set the outUsdStageData
     stageData->stage = usdStage;
     // If usdPrim is still invalid, then the stage has no default prim.
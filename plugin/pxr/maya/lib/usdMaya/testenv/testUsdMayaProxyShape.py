@@ -15,7 +15,7 @@
 # limitations under the License.
 #
 
-from pxr import Usd, Tf
+from pxr import Gf, Tf, Usd, UsdGeom, Vt
 
 from maya import cmds
 from maya import standalone
@@ -79,6 +79,71 @@ class testUsdMayaProxyShape(unittest.TestCase):
         cmds.reorder("testNode1", back=True)
         cmds.reorder("testNode2", front=True)
 
+    def _assertBoundingBox(self, shape, bboxMin, bboxMax):
+        # Recompute the stage data without changing the stage, so that the
+        # bounds cache is kept.
+        cmds.dgdirty(shape)
+        self.assertEqual(cmds.getAttr(shape + '.boundingBoxMin')[0], bboxMin)
+        self.assertEqual(cmds.getAttr(shape + '.boundingBoxMax')[0], bboxMax)
+
+    def testProxyShapeBoundsInvalidation(self):
+        cmds.file(new=True, force=True)
+        cmds.loadPlugin('pxrUsd', quiet=True)
+
+        unitExtent = Vt.Vec3fArray([(-1.0, -1.0, -1.0), (1.0, 1.0, 1.0)])
+
+        usdFilePath = os.path.abspath('ProxyShapeBoundsInvalidation.usda')
+        usdStage = Usd.Stage.CreateNew(usdFilePath)
+        UsdGeom.Xform.Define(usdStage, '/Root')
+        cubeA = UsdGeom.Cube.Define(usdStage, '/Root/A')
+        cubeA.CreateExtentAttr(unitExtent)
+        cubeB = UsdGeom.Cube.Define(usdStage, '/Root/B')
+        cubeB.CreateExtentAttr(unitExtent)
+        translateB = cubeB.AddTranslateOp()
+        translateB.Set(Gf.Vec3d(5.0, 0.0, 0.0), 1.0)
+        translateB.Set(Gf.Vec3d(10.0, 0.0, 0.0), 2.0)
+        usdStage.GetRootLayer().Save()
+
+        shape = cmds.createNode('pxrUsdProxyShape')
+        cmds.setAttr(shape + '.filePath', usdFilePath, type='string')
+        cmds.setAttr(shape + '.primPath', '/Root', type='string')
+        cmds.connectAttr('time1.outTime', shape + '.time')
+
+        # Time-varying transform of a child.
+        cmds.currentTime(1)
+        self._assertBoundingBox(shape, (-1.0, -1.0, -1.0), (6.0, 1.0, 1.0))
+        cmds.currentTime(2)
+        self._assertBoundingBox(shape, (-1.0, -1.0, -1.0), (11.0, 1.0, 1.0))
+        cmds.currentTime(1)
+        self._assertBoundingBox(shape, (-1.0, -1.0, -1.0), (6.0, 1.0, 1.0))
+
+        # Edits through another stage on the same layer notify the stage of
+        # the proxy shape.
+        editStage = Usd.Stage.Open(usdFilePath)
+
+        # Info-only change of an extent.
+        UsdGeom.Cube.Get(editStage, '/Root/A').GetExtentAttr().Set(
+            Vt.Vec3fArray([(-3.0, -3.0, -3.0), (3.0, 3.0, 3.0)]))
+        self._assertBoundingBox(shape, (-3.0, -3.0, -3.0), (6.0, 3.0, 3.0))
+
+        # Resync of an added then removed prim.
+        cubeC = UsdGeom.Cube.Define(editStage, '/Root/C')
+        cubeC.CreateExtentAttr(unitExtent)
+        cubeC.AddTranslateOp().Set(Gf.Vec3d(0.0, 20.0, 0.0))
+        self._assertBoundingBox(shape, (-3.0, -3.0, -3.0), (6.0, 21.0, 3.0))
+        editStage.RemovePrim('/Root/C')
+        self._assertBoundingBox(shape, (-3.0, -3.0, -3.0), (6.0, 3.0, 3.0))
+
+        # Hidden child, then hidden requested prim.
+        UsdGeom.Imageable(editStage.GetPrimAtPath('/Root/B')).MakeInvisible()
+        self._assertBoundingBox(shape, (-3.0, -3.0, -3.0), (3.0, 3.0, 3.0))
+        UsdGeom.Imageable(editStage.GetPrimAtPath('/Root')).MakeInvisible()
+        cmds.dgdirty(shape)
+        self.assertEqual(
+            cmds.getAttr(shape + '.boundingBoxSize')[0], (0.0, 0.0, 0.0))
+        UsdGeom.Imageable(editStage.GetPrimAtPath('/Root')).MakeVisible()
+        self._assertBoundingBox(shape, (-3.0, -3.0, -3.0), (3.0, 3.0, 3.0))
+
 
 if __name__ == '__main__':
     unittest.main(verbosity=2)
@@ -0,0 +1,153 @@
+#!/pxrpythonsubst
+#
+# Copyright 2019 Autodesk
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+from pxr import Usd
+
+from maya import cmds
+from maya import standalone
+
+import json
+import os
+import shutil
+import tempfile
+import unittest
+
+
+class testUsdMayaStageCache(unittest.TestCase):
+    '''Verify the tracking of the stages referenced by proxy shapes.
+
+    Each proxy shape referencing a stage counts as one reference, and the
+    mayaUsdStageCache command evicts the most recently released unreferenced
+    stages last.
+    '''
+
+    @classmethod
+    def setUpClass(cls):
+        standalone.initialize('usd')
+        cmds.loadPlugin('pxrUsd', quiet=True)
+
+    @classmethod
+    def tearDownClass(cls):
+        standalone.uninitialize()
+
+    def setUp(self):
+        # A new scene clears the stage caches.
+        cmds.file(new=True, force=True)
+
+        self.tempDir = os.path.realpath(tempfile.mkdtemp())
+        self.layerPaths = {}
+        for name in ['a', 'b', 'c', 'd']:
+            layerPath = os.path.join(self.tempDir, name + '.usda')
+            stage = Usd.Stage.CreateNew(layerPath)
+            stage.DefinePrim('/' + name, 'Xform')
+            stage.GetRootLayer().Save()
+            self.layerPaths[name] = layerPath
+
+    def tearDown(self):
+        cmds.file(new=True, force=True)
+        shutil.rmtree(self.tempDir, ignore_errors=True)
+
+    def createProxyShape(self, name):
+        shape = cmds.createNode('pxrUsdProxyShape')
+        self.setFile(shape, name)
+        return shape
+
+    def setFile(self, shape, name):
+        '''Point the proxy shape to the layer of the name, or to no layer if
+        None, and compute its stage.'''
+        cmds.setAttr(shape + '.filePath',
+            self.layerPaths[name] if name else '', type='string')
+        cmds.dgeval(shape + '.outStageData')
+
+    def stageInfos(self, name):
+        return json.loads(
+            cmds.mayaUsdStageCache(rootLayer=self.layerPaths[name]))
+
+    def references(self, name):
+        infos = self.stageInfos(name)
+        self.assertEqual(len(infos), 1)
+        self.assertTrue(infos[0]['tracked'])
+        return infos[0]['references']
+
+    def testReferenceCount(self):
+        '''Each proxy shape referencing a stage counts as one reference.'''
+        shape1 = self.createProxyShape('a')
+        shape2 = self.createProxyShape('a')
+        self.assertEqual(self.references('a'), 2)
+
+        # Recomputing the same stage doesn't add a reference.
+        cmds.dgdirty(shape1)
+        cmds.dgeval(shape1 + '.outStageData')
+        self.assertEqual(self.references('a'), 2)
+
+        self.setFile(shape1, 'b')
+        self.assertEqual(self.references('a'), 1)
+        self.assertEqual(self.references('b'), 1)
+
+        self.setFile(shape2, None)
+        self.assertEqual(self.references('a'), 0)
+
+        # Unreferenced stages stay cached until evicted.
+        self.assertEqual(len(self.stageInfos('a')), 1)
+
+    def testEvictionOrder(self):
+        '''Eviction keeps the most recently released stages.'''
+        shapes = {}
+        for name in ['a', 'b', 'c', 'd']:
+            shapes[name] = self.createProxyShape(name)
+
+        # Release a, then c, then b. d stays referenced.
+        for name in ['a', 'c', 'b']:
+            self.setFile(shapes[name], None)
+
+        self.assertEqual(
+            cmds.mayaUsdStageCache(evictUnreferenced=True, maxUnreferenced=1), 2)
+
+        self.assertEqual(self.stageInfos('a'), [])
+        self.assertEqual(self.stageInfos('c'), [])
+        self.assertEqual(self.references('b'), 0)
+        self.assertEqual(self.references('d'), 1)
+
+        self.assertEqual(cmds.mayaUsdStageCache(evictUnreferenced=True), 1)
+
+        self.assertEqual(self.stageInfos('b'), [])
+        self.assertEqual(self.references('d'), 1)
+
+        # A released stage reloaded by a proxy shape is tracked again.
+        self.setFile(shapes['a'], 'a')
+        self.assertEqual(self.references('a'), 1)
+
+    def testRootLayerFilter(self):
+        '''Filtering by root layer only reports the stages of that layer.'''
+        self.createProxyShape('a')
+        self.createProxyShape('b')
+
+        infos = self.stageInfos('a')
+        self.assertEqual(len(infos), 1)
+        self.assertEqual(
+            os.path.normcase(infos[0]['rootLayer']),
+            os.path.normcase(self.layerPaths['a']))
+        self.assertGreaterEqual(infos[0]['prims'], 1)
+
+        self.assertEqual(len(json.loads(cmds.mayaUsdStageCache())), 2)
+
+        # No stage uses this layer.
+        self.assertEqual(self.stageInfos('c'), [])
+
+
+if __name__ == '__main__':
+    unittest.main(verbosity=2)
@@ -0,0 +1,109 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Micro-benchmark of primvar expansion of HdVP2Mesh.
+//
+// Times the kernels of HdVP2PrimvarFill against the scalar loops they
+// replaced, for each interpolation, on meshes of growing sizes. The best time
+// of several repetitions is reported, in milliseconds.
+//
+// Usage:
+//     benchmarkPrimvarFill [numRepetitions]
+
+#include "primvarFillReference.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+
+//! Return the best time of numRepetitions calls of fill, in milliseconds.
+template <class FILL>
+double _Time(size_t numRepetitions, const FILL& fill)
+{
+    double best = 0.0;
+    for (size_t i = 0; i < numRepetitions; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        fill();
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = (i == 0) ? elapsed.count() : std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+template <class DEST_TYPE, class SRC_TYPE>
+void _Benchmark(const char* layout, size_t channelOffset,
+    size_t numVertices, size_t numRepetitions)
+{
+    using Fill = HdVP2PrimvarFill<DEST_TYPE, SRC_TYPE>;
+    using Reference = HdVP2PrimvarFillReference<DEST_TYPE, SRC_TYPE>;
+
+    const HdVP2PrimvarFillData data(numVertices);
+    const SRC_TYPE* src = data.GetPrimvar<SRC_TYPE>();
+    const int* indices = data._faceVertexIndices.data();
+    const int* counts = data._faceVertexCounts.data();
+    const size_t numFaces = data.GetNumFaces();
+    const size_t numFaceVertices = data.GetNumFaceVertices();
+
+    std::vector<DEST_TYPE> buffer(numFaceVertices);
+    DEST_TYPE* dst = buffer.data();
+
+    const auto report = [&](const char* interpolation, double scalar, double kernel) {
+        printf("%-20s %-12s %10zu %12.3f %12.3f %8.2fx\n", layout, interpolation,
+            numVertices, scalar, kernel, kernel > 0.0 ? scalar / kernel : 0.0);
+    };
+
+    report("constant",
+        _Time(numRepetitions, [&]() { Reference::FillConstant(dst, numVertices, channelOffset, src[0]); }),
+        _Time(numRepetitions, [&]() { Fill::FillConstant(dst, numVertices, channelOffset, src[0]); }));
+
+    report("vertex",
+        _Time(numRepetitions, [&]() { Reference::FillCopy(dst, numVertices, channelOffset, src); }),
+        _Time(numRepetitions, [&]() { Fill::FillCopy(dst, numVertices, channelOffset, src); }));
+
+    report("unshared",
+        _Time(numRepetitions, [&]() { Reference::FillGather(dst, numFaceVertices, channelOffset, src, indices); }),
+        _Time(numRepetitions, [&]() { Fill::FillGather(dst, numFaceVertices, channelOffset, src, indices); }));
+
+    report("uniform",
+        _Time(numRepetitions, [&]() { Reference::FillUniform(dst, numFaceVertices, channelOffset, src, counts, numFaces); }),
+        _Time(numRepetitions, [&]() { Fill::FillUniform(dst, numFaceVertices, channelOffset, src, counts, numFaces); }));
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    const size_t numRepetitions = (argc > 1) ?
+        std::max(atoi(argv[1]), 1) : 10;
+
+    printf("%-20s %-12s %10s %12s %12s %9s\n",
+        "layout", "primvar", "vertices", "scalar (ms)", "kernel (ms)", "speedup");
+
+    for (const size_t numVertices : { 10000, 100000, 1000000, 4000000 }) {
+        _Benchmark<HdVP2Float3, HdVP2Float3>("float3", 0, numVertices, numRepetitions);
+        _Benchmark<HdVP2Float4, HdVP2Float3>("float3 to float4", 0, numVertices, numRepetitions);
+        _Benchmark<HdVP2Float4, float>("float to float4.w", 3, numVertices, numRepetitions);
+    }
+
+    return 0;
+}
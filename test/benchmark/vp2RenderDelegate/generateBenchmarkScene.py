@@ -0,0 +1,159 @@
+#!/usr/bin/env python
+
+#
+# Copyright 2019 Autodesk
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+'''Generate a reproducible USD stage for benchmarking VP2 render delegate.
+
+The stage holds a grid of meshes, a fraction of which have animated
+transforms and a fraction animated points, plus a point instancer. The same
+arguments always produce the same stage.
+
+Meshes get a constant displayColor, drawn with one fallback shader per
+distinct color. Limiting the number of distinct colors with --colors
+measures contention on the shader cache during sync.
+
+Usage:
+    mayapy generateBenchmarkScene.py -o scene.usdc --meshes 1000 --faces 400
+'''
+
+import argparse
+import math
+import random
+
+from pxr import Gf, Sdf, Usd, UsdGeom, Vt
+
+
+def _gridMesh(stage, path, resolution, size):
+    '''Define a planar mesh of resolution x resolution quads.'''
+    mesh = UsdGeom.Mesh.Define(stage, path)
+
+    step = size / resolution
+    points = []
+    for j in range(resolution + 1):
+        for i in range(resolution + 1):
+            points.append(Gf.Vec3f(i * step - size * 0.5, 0.0, j * step - size * 0.5))
+
+    counts = []
+    indices = []
+    for j in range(resolution):
+        for i in range(resolution):
+            v = j * (resolution + 1) + i
+            counts.append(4)
+            indices.extend([v, v + resolution + 1, v + resolution + 2, v + 1])
+
+    mesh.CreatePointsAttr(Vt.Vec3fArray(points))
+    mesh.CreateFaceVertexCountsAttr(Vt.IntArray(counts))
+    mesh.CreateFaceVertexIndicesAttr(Vt.IntArray(indices))
+    mesh.CreateExtentAttr(UsdGeom.PointBased.ComputeExtent(mesh.GetPointsAttr().Get()))
+    mesh.CreateSubdivisionSchemeAttr(UsdGeom.Tokens.none)
+    return mesh
+
+
+def _animatePoints(mesh, frames, phase):
+    '''Author a wave on the points of a mesh for every frame.'''
+    pointsAttr = mesh.GetPointsAttr()
+    restPoints = pointsAttr.Get()
+    for frame in range(1, frames + 1):
+        points = [Gf.Vec3f(p[0], 0.1 * math.sin(p[0] + p[2] + frame * 0.2 + phase), p[2])
+                  for p in restPoints]
+        pointsAttr.Set(Vt.Vec3fArray(points), frame)
+    mesh.GetExtentAttr().Set(Vt.Vec3fArray([Gf.Vec3f(-0.5, -0.1, -0.5), Gf.Vec3f(0.5, 0.1, 0.5)]))
+
+
+def generate(args):
+    stage = Usd.Stage.CreateNew(args.output)
+    stage.SetStartTimeCode(1)
+    stage.SetEndTimeCode(args.frames)
+    UsdGeom.SetStageUpAxis(stage, UsdGeom.Tokens.y)
+
+    rng = random.Random(args.seed)
+
+    palette = [Gf.Vec3f(rng.random(), rng.random(), rng.random())
+               for _ in range(args.colors)]
+
+    world = UsdGeom.Xform.Define(stage, '/World')
+    stage.SetDefaultPrim(world.GetPrim())
+
+    # Side resolution of each mesh, matching the requested number of faces.
+    resolution = max(1, int(round(math.sqrt(args.faces))))
+    columns = max(1, int(math.ceil(math.sqrt(args.meshes))))
+
+    for index in range(args.meshes):
+        groupPath = '/World/Meshes/Group_%d' % (index // columns)
+        xform = UsdGeom.Xform.Define(stage, '%s/Xform_%d' % (groupPath, index))
+        translateOp = xform.AddTranslateOp()
+
+        position = Gf.Vec3d(1.5 * (index % columns), 0.0, 1.5 * (index // columns))
+        if rng.random() < args.animatedTransforms:
+            phase = rng.random() * 2.0 * math.pi
+            for frame in range(1, args.frames + 1):
+                translateOp.Set(position + Gf.Vec3d(0.0, math.sin(frame * 0.1 + phase), 0.0), frame)
+        else:
+            translateOp.Set(position)
+
+        mesh = _gridMesh(stage, xform.GetPath().AppendChild('Mesh'), resolution, 1.0)
+        color = palette[index % len(palette)] if palette else \
+            Gf.Vec3f(rng.random(), rng.random(), rng.random())
+        mesh.CreateDisplayColorAttr(Vt.Vec3fArray([color]))
+
+        if rng.random() < args.animatedPoints:
+            _animatePoints(mesh, args.frames, rng.random() * 2.0 * math.pi)
+
+    if args.instances > 0:
+        instancer = UsdGeom.PointInstancer.Define(stage, '/World/Instancer')
+        _gridMesh(stage, '/World/Instancer/Prototypes/Proto', resolution, 0.5)
+        instancer.CreatePrototypesRel().SetTargets([Sdf.Path('/World/Instancer/Prototypes/Proto')])
+
+        side = max(1, int(math.ceil(math.sqrt(args.instances))))
+        positions = [Gf.Vec3f(0.75 * (i % side), 3.0, 0.75 * (i // side))
+                     for i in range(args.instances)]
+        instancer.CreatePositionsAttr(Vt.Vec3fArray(positions))
+        instancer.CreateProtoIndicesAttr(Vt.IntArray([0] * args.instances))
+
+    stage.GetRootLayer().Save()
+
+
+def createParser():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-o', '--output', required=True,
+        help='Path of the generated stage')
+    parser.add_argument('--meshes', type=int, default=1000,
+        help='Number of meshes')
+    parser.add_argument('--faces', type=int, default=400,
+        help='Number of faces of each mesh')
+    parser.add_argument('--instances', type=int, default=1000,
+        help='Number of instances of the point instancer, 0 for none')
+    parser.add_argument('--colors', type=int, default=0,
+        help='Number of distinct displayColors, 0 for one per mesh')
+    parser.add_argument('--frames', type=int, default=100,
+        help='Number of animated frames')
+    parser.add_argument('--animatedTransforms', type=float, default=0.25,
+        help='Fraction of meshes with animated transform')
+    parser.add_argument('--animatedPoints', type=float, default=0.05,
+        help='Fraction of meshes with animated points')
+    parser.add_argument('--seed', type=int, default=0,
+        help='Seed of the pseudo random generator')
+    return parser
+
+
+def main():
+    generate(createParser().parse_args())
+
+
+if __name__ == '__main__':
+    main()
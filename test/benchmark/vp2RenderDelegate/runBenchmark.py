@@ -0,0 +1,257 @@
+#!/usr/bin/env python
+
+#
+# Copyright 2019 Autodesk
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+'''Benchmark VP2 render delegate on a stage in mayapy batch mode.
+
+Frames are drawn by Viewport 2.0 with ogsRender, which requires a GPU. Four
+scenarios are measured:
+    - stageLoad:    creation of the proxy shape and its first draw
+    - playback:     draw of every frame of the stage
+    - selection:    draw after selecting and deselecting groups of prims
+    - ringPlayback: playback once per vertex buffer ring size given by
+                    --ringSizes, each in its own mayapy process since the
+                    ring size is read once per process, reported as
+                    playbackRing<size>
+
+For each scenario the wall clock time and the statistics of the render
+delegate, as returned by the mayaUsdRenderStats command, are summed over
+the drawn frames. Results are written as JSON. When a baseline produced by
+a previous run is given, times exceeding the baseline by more than the
+tolerance are reported and the script exits with a non-zero status.
+
+Usage:
+    mayapy runBenchmark.py scene.usdc -o results.json [-b baseline.json]
+
+With --generate, the stage is first generated by generateBenchmarkScene.py
+if it doesn't exist, with the arguments given by --sceneArgs.
+'''
+
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+# Proxy shapes are drawn by VP2 render delegate only when this is set before
+# the plugin gets loaded.
+os.environ['VP2_RENDER_DELEGATE_PROXY'] = '1'
+
+import maya.standalone
+maya.standalone.initialize(name='python')
+
+import maya.cmds as cmds
+
+from pxr import Usd
+
+# UFE run-time ids of Maya and USD.
+MAYA_RUNTIME_ID = 1
+USD_RUNTIME_ID = 2
+
+# Keys of the statistics compared against the baseline.
+TIMED_KEYS = ['wallTimeMs', 'updateTimeMs', 'syncTimeMs', 'commitTimeMs', 'selectionTimeMs']
+
+
+def _accumulate(total, stats):
+    '''Sum statistics of one update into the total, recursively.'''
+    for key, value in stats.items():
+        if isinstance(value, dict):
+            _accumulate(total.setdefault(key, {}), value)
+        else:
+            total[key] = total.get(key, 0) + value
+
+
+class Benchmark(object):
+    def __init__(self, stagePath, width, height):
+        self._stagePath = stagePath
+        self._width = width
+        self._height = height
+        self._imagePath = os.path.join(tempfile.gettempdir(), 'vp2RenderDelegateBenchmark')
+        self._shape = None
+
+    def _draw(self, total):
+        '''Draw one frame and accumulate its statistics.'''
+        start = time.time()
+        cmds.ogsRender(camera='persp', width=self._width, height=self._height)
+        total['wallTimeMs'] = total.get('wallTimeMs', 0.0) + (time.time() - start) * 1000.0
+        total['frames'] = total.get('frames', 0) + 1
+        _accumulate(total, json.loads(cmds.mayaUsdRenderStats(self._shape)))
+
+    def setUp(self):
+        cmds.file(new=True, force=True)
+        cmds.loadPlugin('mayaUsdPlugin', quiet=True)
+        cmds.setAttr('defaultRenderGlobals.imageFilePrefix', self._imagePath, type='string')
+        cmds.setAttr('hardwareRenderingGlobals.renderMode', 4)
+        cmds.currentTime(1)
+
+    def stageLoad(self):
+        total = {}
+        start = time.time()
+        self._shape = cmds.createNode('mayaUsdProxyShape')
+        cmds.connectAttr('time1.outTime', self._shape + '.time')
+        cmds.setAttr(self._shape + '.filePath', self._stagePath, type='string')
+        cmds.viewFit('persp', all=True)
+        self._draw(total)
+        total['loadTimeMs'] = (time.time() - start) * 1000.0
+        return total
+
+    def playback(self):
+        total = {}
+        stage = Usd.Stage.Open(self._stagePath, Usd.Stage.LoadNone)
+        start = int(stage.GetStartTimeCode())
+        end = int(stage.GetEndTimeCode())
+        maxFrameTimeMs = 0.0
+        for frame in range(start, end + 1):
+            cmds.currentTime(frame)
+            wallTimeMs = total.get('wallTimeMs', 0.0)
+            self._draw(total)
+            maxFrameTimeMs = max(maxFrameTimeMs, total['wallTimeMs'] - wallTimeMs)
+        cmds.currentTime(start)
+        total['frameTimeMs'] = total['wallTimeMs'] / max(total['frames'], 1)
+        total['maxFrameTimeMs'] = maxFrameTimeMs
+        return total
+
+    def selection(self, count):
+        import ufe
+
+        total = {}
+        proxySegment = ufe.PathSegment(
+            '|world' + cmds.ls(self._shape, long=True)[0], MAYA_RUNTIME_ID, '|')
+
+        stage = Usd.Stage.Open(self._stagePath, Usd.Stage.LoadNone)
+        groups = [prim.GetPath() for prim in stage.Traverse()
+                  if prim.GetName().startswith('Group_')][:count]
+
+        selection = ufe.GlobalSelection.get()
+        for path in groups:
+            item = ufe.Hierarchy.createItem(ufe.Path([
+                proxySegment, ufe.PathSegment(str(path), USD_RUNTIME_ID, '/')]))
+            selection.clear()
+            selection.append(item)
+            self._draw(total)
+        selection.clear()
+        self._draw(total)
+        return total
+
+
+def _ringPlayback(stagePath, ringSize, width, height):
+    '''Return the playback results of a mayapy process drawing with vertex
+    buffer rings of the given size.'''
+    outputPath = os.path.join(tempfile.gettempdir(),
+        'vp2RenderDelegateBenchmarkRing%d.json' % ringSize)
+
+    env = dict(os.environ)
+    env['VP2_RENDER_DELEGATE_VERTEX_BUFFER_RING_SIZE'] = str(ringSize)
+
+    subprocess.check_call([sys.executable, os.path.abspath(__file__), stagePath,
+        '--scenarios', 'playback', '-o', outputPath,
+        '--width', str(width), '--height', str(height)], env=env)
+
+    with open(outputPath) as f:
+        results = json.load(f)
+    os.remove(outputPath)
+
+    playback = results['playback']
+    playback['ringSize'] = ringSize
+    return playback
+
+
+def _compare(results, baseline, tolerance):
+    '''Return descriptions of times exceeding the baseline.'''
+    regressions = []
+    for scenario, stats in results.items():
+        reference = baseline.get(scenario, {})
+        for key in TIMED_KEYS + ['loadTimeMs', 'frameTimeMs']:
+            if key in stats and reference.get(key, 0) > 0:
+                ratio = stats[key] / reference[key]
+                if ratio > 1.0 + tolerance:
+                    regressions.append('%s.%s: %.1f ms vs %.1f ms baseline (+%.0f%%)' % (
+                        scenario, key, stats[key], reference[key], (ratio - 1.0) * 100.0))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('stage', help='Path of the benchmarked stage')
+    parser.add_argument('-o', '--output', help='Path of the JSON results')
+    parser.add_argument('-b', '--baseline', help='Path of JSON results to compare with')
+    parser.add_argument('-t', '--tolerance', type=float, default=0.2,
+        help='Relative slowdown above which a time is a regression')
+    parser.add_argument('--selections', type=int, default=20,
+        help='Number of selection changes')
+    parser.add_argument('--generate', action='store_true',
+        help='Generate the stage if it does not exist')
+    parser.add_argument('--sceneArgs', default='',
+        help='Arguments of generateBenchmarkScene.py used by --generate')
+    parser.add_argument('--scenarios', default='stageLoad,playback,selection',
+        help='Comma-separated scenarios to run, stageLoad always runs')
+    parser.add_argument('--ringSizes', default='1,3',
+        help='Comma-separated vertex buffer ring sizes played back by ringPlayback')
+    parser.add_argument('--width', type=int, default=1920)
+    parser.add_argument('--height', type=int, default=1080)
+    args = parser.parse_args()
+
+    if args.generate and not os.path.exists(args.stage):
+        import generateBenchmarkScene
+        generateBenchmarkScene.generate(
+            generateBenchmarkScene.createParser().parse_args(
+                ['-o', args.stage] + shlex.split(args.sceneArgs)))
+
+    benchmark = Benchmark(os.path.abspath(args.stage), args.width, args.height)
+    benchmark.setUp()
+
+    scenarios = args.scenarios.split(',')
+
+    results = {}
+    results['stageLoad'] = benchmark.stageLoad()
+    if 'playback' in scenarios:
+        results['playback'] = benchmark.playback()
+    if 'selection' in scenarios:
+        results['selection'] = benchmark.selection(args.selections)
+    if 'ringPlayback' in scenarios:
+        for ringSize in [int(size) for size in args.ringSizes.split(',')]:
+            playback = _ringPlayback(
+                os.path.abspath(args.stage), ringSize, args.width, args.height)
+            results['playbackRing%d' % ringSize] = playback
+            sys.stderr.write('Ring size %d: %.2f ms per frame, %.2f ms max\n' % (
+                ringSize, playback['frameTimeMs'], playback['maxFrameTimeMs']))
+
+    output = json.dumps(results, indent=4, sort_keys=True)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(output)
+    else:
+        print(output)
+
+    status = 0
+    if args.baseline:
+        with open(args.baseline) as f:
+            regressions = _compare(results, json.load(f), args.tolerance)
+        for regression in regressions:
+            sys.stderr.write('Regression: %s\n' % regression)
+        status = 1 if regressions else 0
+
+    maya.standalone.uninitialize()
+    return status
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,112 @@
+#!/usr/bin/env python
+
+#
+# Copyright 2019 Autodesk
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+from ufeTestUtils import usdUtils, mayaUtils
+import ufe
+
+import unittest
+
+class PathToPrimTestCase(unittest.TestCase):
+    '''Verify that UFE paths resolve to the current USD prims.
+
+    UFE Feature : Hierarchy
+    Maya Feature : None
+    Action : Resolve a UFE path to a USD prim, then edit the prim.
+    Applied On Selection : No
+    Undo/Redo Test : No
+    Expect Results To Test :
+        - A removed prim is no longer resolved.
+        - A replaced prim resolves to the new prim.
+        - Descendants of a removed prim are no longer resolved.
+        - Prims outside of the edited hierarchy are still resolved.
+    Edge Cases :
+        - None.
+    '''
+
+    pluginsLoaded = False
+
+    @classmethod
+    def setUpClass(cls):
+        if not cls.pluginsLoaded:
+            cls.pluginsLoaded = mayaUtils.isMayaUsdPluginLoaded()
+
+    def setUp(self):
+        ''' Called initially to set up the Maya test environment '''
+        # Load plugins
+        self.assertTrue(self.pluginsLoaded)
+
+        # Open top_layer.ma scene in test-samples
+        mayaUtils.openTopLayerScene()
+
+        self.mayaSegment = mayaUtils.createUfePathSegment(
+            "|world|transform1|proxyShape1")
+
+        ball35Item = ufe.Hierarchy.createItem(
+            self.ufePath("/Room_set/Props/Ball_35"))
+        self.assertIsNotNone(ball35Item)
+        self.stage = usdUtils.getPrimFromSceneItem(ball35Item).GetStage()
+
+    def ufePath(self, usdPath):
+        return ufe.Path(
+            [self.mayaSegment, usdUtils.createUfePathSegment(usdPath)])
+
+    def resolvedPrim(self, usdPath):
+        item = ufe.Hierarchy.createItem(self.ufePath(usdPath))
+        return usdUtils.getPrimFromSceneItem(item) if item else None
+
+    def testRemovedPrim(self):
+        '''A removed prim is no longer resolved.'''
+        self.stage.DefinePrim("/Room_set/Props/Ball_36", "Sphere")
+
+        self.assertTrue(self.resolvedPrim("/Room_set/Props/Ball_36"))
+        self.assertTrue(self.resolvedPrim("/Room_set/Props/Ball_35"))
+
+        self.stage.RemovePrim("/Room_set/Props/Ball_36")
+
+        self.assertIsNone(self.resolvedPrim("/Room_set/Props/Ball_36"))
+
+        ball35Prim = self.resolvedPrim("/Room_set/Props/Ball_35")
+        self.assertTrue(ball35Prim)
+        self.assertEqual(ball35Prim.GetPath(), "/Room_set/Props/Ball_35")
+
+    def testReplacedPrim(self):
+        '''A replaced prim resolves to the new prim.'''
+        self.stage.DefinePrim("/Room_set/Props/Ball_36", "Sphere")
+
+        prim = self.resolvedPrim("/Room_set/Props/Ball_36")
+        self.assertEqual(prim.GetTypeName(), "Sphere")
+
+        self.stage.RemovePrim("/Room_set/Props/Ball_36")
+        self.stage.DefinePrim("/Room_set/Props/Ball_36", "Cube")
+
+        prim = self.resolvedPrim("/Room_set/Props/Ball_36")
+        self.assertTrue(prim)
+        self.assertEqual(prim.GetTypeName(), "Cube")
+
+    def testRemovedAncestor(self):
+        '''Descendants of a removed prim are no longer resolved.'''
+        self.stage.DefinePrim("/Room_set/Props/Ball_36", "Xform")
+        self.stage.DefinePrim("/Room_set/Props/Ball_36/Child", "Sphere")
+
+        self.assertTrue(self.resolvedPrim("/Room_set/Props/Ball_36/Child"))
+
+        self.stage.RemovePrim("/Room_set/Props/Ball_36")
+
+        self.assertIsNone(self.resolvedPrim("/Room_set/Props/Ball_36/Child"))
+        self.assertIsNone(self.resolvedPrim("/Room_set/Props/Ball_36"))
+        self.assertTrue(self.resolvedPrim("/Room_set/Props/Ball_35"))
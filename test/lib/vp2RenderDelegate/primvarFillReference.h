@@ -0,0 +1,149 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef HD_VP2_PRIMVAR_FILL_REFERENCE
+#define HD_VP2_PRIMVAR_FILL_REFERENCE
+
+#include "primvarFill.h"
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/*! \brief  Scalar primvar expansion HdVP2PrimvarFill is compared with.
+    \class  HdVP2PrimvarFillReference
+
+    Per-element loops HdVP2Mesh used before the vectorizable kernels, writing
+    a primvar element at a time through a pointer to the channel.
+*/
+template <class DEST_TYPE, class SRC_TYPE>
+struct HdVP2PrimvarFillReference final
+{
+    //! Return the channel of vertex v of the buffer.
+    static SRC_TYPE* Element(DEST_TYPE* vertexBuffer, size_t v, size_t channelOffset)
+    {
+        return reinterpret_cast<SRC_TYPE*>(
+            reinterpret_cast<float*>(&vertexBuffer[v]) + channelOffset);
+    }
+
+    static void FillConstant(DEST_TYPE* vertexBuffer, size_t numVertices,
+        size_t channelOffset, const SRC_TYPE& value)
+    {
+        for (size_t v = 0; v < numVertices; v++) {
+            *Element(vertexBuffer, v, channelOffset) = value;
+        }
+    }
+
+    static void FillCopy(DEST_TYPE* vertexBuffer, size_t numVertices,
+        size_t channelOffset, const SRC_TYPE* src)
+    {
+        if (channelOffset == 0 && sizeof(DEST_TYPE) == sizeof(SRC_TYPE)) {
+            memcpy(vertexBuffer, src, sizeof(DEST_TYPE) * numVertices);
+        }
+        else {
+            for (size_t v = 0; v < numVertices; v++) {
+                *Element(vertexBuffer, v, channelOffset) = src[v];
+            }
+        }
+    }
+
+    static void FillGather(DEST_TYPE* vertexBuffer, size_t numVertices,
+        size_t channelOffset, const SRC_TYPE* src, const int* indices)
+    {
+        for (size_t v = 0; v < numVertices; v++) {
+            *Element(vertexBuffer, v, channelOffset) = src[indices[v]];
+        }
+    }
+
+    static void FillUniform(DEST_TYPE* vertexBuffer, size_t numVertices,
+        size_t channelOffset, const SRC_TYPE* src,
+        const int* faceVertexCounts, size_t numFaces)
+    {
+        for (size_t f = 0, v = 0; f < numFaces; f++) {
+            const size_t faceVertexEnd = v + faceVertexCounts[f];
+            for (; v < faceVertexEnd; v++) {
+                *Element(vertexBuffer, v, channelOffset) = src[f];
+            }
+        }
+    }
+};
+
+//! Vertex buffer and primvar element types.
+using HdVP2Float2 = std::array<float, 2>;
+using HdVP2Float3 = std::array<float, 3>;
+using HdVP2Float4 = std::array<float, 4>;
+
+/*! \brief  Random mesh data to expand primvars of.
+    \class  HdVP2PrimvarFillData
+
+    Faces have 3 to 6 vertices, face vertex indices and face indices of welded
+    vertices are random, and primvar values are random floats.
+*/
+struct HdVP2PrimvarFillData final
+{
+    std::vector<int>    _faceVertexCounts;  //!< Number of vertices of each face
+    std::vector<int>    _faceVertexIndices; //!< Random point index of each face vertex
+    std::vector<int>    _faces;             //!< Random face index of each vertex
+    std::vector<float>  _values;            //!< Random primvar floats
+
+    //! Generate faces with at least numVertices face vertices in total.
+    HdVP2PrimvarFillData(size_t numVertices, unsigned int seed = 1)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_int_distribution<int> faceVertexCount(3, 6);
+
+        size_t numFaceVertices = 0;
+        while (numFaceVertices < numVertices) {
+            _faceVertexCounts.push_back(faceVertexCount(generator));
+            numFaceVertices += _faceVertexCounts.back();
+        }
+
+        const size_t numFaces = _faceVertexCounts.size();
+        std::uniform_int_distribution<int> point(0, static_cast<int>(numVertices) - 1);
+        std::uniform_int_distribution<int> face(0, static_cast<int>(numFaces) - 1);
+
+        _faceVertexIndices.resize(numFaceVertices);
+        _faces.resize(numFaceVertices);
+        for (size_t v = 0; v < numFaceVertices; v++) {
+            _faceVertexIndices[v] = point(generator);
+            _faces[v] = face(generator);
+        }
+
+        // Enough floats for one primvar element of 4 floats per face vertex.
+        std::uniform_real_distribution<float> value(-1000.0f, 1000.0f);
+        _values.resize(numFaceVertices * 4);
+        for (float& f : _values) {
+            f = value(generator);
+        }
+    }
+
+    size_t GetNumFaces() const { return _faceVertexCounts.size(); }
+    size_t GetNumFaceVertices() const { return _faceVertexIndices.size(); }
+
+    //! Return the random values as primvar elements.
+    template <class SRC_TYPE>
+    const SRC_TYPE* GetPrimvar() const
+    {
+        return reinterpret_cast<const SRC_TYPE*>(_values.data());
+    }
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HD_VP2_PRIMVAR_FILL_REFERENCE
@@ -0,0 +1,168 @@
+//
+// Copyright 2019 Autodesk
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "primvarFillReference.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace {
+
+//! Vertex buffer element, primvar element and channel offset of a test.
+template <class DEST_TYPE, class SRC_TYPE, size_t CHANNEL_OFFSET>
+struct Layout
+{
+    using Dest = DEST_TYPE;
+    using Src = SRC_TYPE;
+    static constexpr size_t kChannelOffset = CHANNEL_OFFSET;
+};
+
+// Layouts filled by HdVP2Mesh: points, normals and primvars of the same size
+// as the buffer, colors without alpha and alpha alone in a 4-float buffer.
+using Layouts = ::testing::Types<
+    Layout<HdVP2Float3, HdVP2Float3, 0>,
+    Layout<HdVP2Float2, HdVP2Float2, 0>,
+    Layout<HdVP2Float4, HdVP2Float3, 0>,
+    Layout<HdVP2Float4, float, 3>
+>;
+
+// Number of vertices below the parallel threshold, and above it with a
+// partial last chunk.
+const size_t kNumVerticesSmall = 1000;
+const size_t kNumVerticesLarge = 4 * kHdVP2ParallelFillThreshold + 123;
+
+template <class LAYOUT>
+class PrimvarFillTest : public ::testing::Test
+{
+public:
+    using Dest = typename LAYOUT::Dest;
+    using Src = typename LAYOUT::Src;
+    using Fill = HdVP2PrimvarFill<Dest, Src>;
+    using Reference = HdVP2PrimvarFillReference<Dest, Src>;
+
+    static constexpr size_t kChannelOffset = LAYOUT::kChannelOffset;
+
+    //! Fill a buffer of numVertices with the kernels and with the reference
+    //! loops, and expect identical bytes, including untouched channels.
+    template <class FILL, class REFERENCE>
+    void ExpectIdentical(size_t numVertices, const FILL& fill, const REFERENCE& reference)
+    {
+        std::vector<Dest> buffer(numVertices);
+        std::vector<Dest> expected(numVertices);
+        memset(buffer.data(), 0x5A, sizeof(Dest) * numVertices);
+        memset(expected.data(), 0x5A, sizeof(Dest) * numVertices);
+
+        fill(buffer.data());
+        reference(expected.data());
+
+        for (size_t v = 0; v < numVertices; v++) {
+            if (memcmp(&buffer[v], &expected[v], sizeof(Dest)) != 0) {
+                ADD_FAILURE() << "Vertex " << v << " of " << numVertices << " differs";
+                return;
+            }
+        }
+    }
+
+    void TestConstant(size_t numVertices)
+    {
+        const HdVP2PrimvarFillData data(numVertices);
+        const Src& value = data.GetPrimvar<Src>()[0];
+
+        ExpectIdentical(numVertices,
+            [&](Dest* buffer) { Fill::FillConstant(buffer, numVertices, kChannelOffset, value); },
+            [&](Dest* buffer) { Reference::FillConstant(buffer, numVertices, kChannelOffset, value); });
+    }
+
+    // Vertex, varying and face-varying primvars of shared vertices.
+    void TestCopy(size_t numVertices)
+    {
+        const HdVP2PrimvarFillData data(numVertices);
+        const Src* src = data.GetPrimvar<Src>();
+
+        ExpectIdentical(numVertices,
+            [&](Dest* buffer) { Fill::FillCopy(buffer, numVertices, kChannelOffset, src); },
+            [&](Dest* buffer) { Reference::FillCopy(buffer, numVertices, kChannelOffset, src); });
+    }
+
+    // Vertex and varying primvars of unshared vertices, gathered by face
+    // vertex index, as well as primvars of welded vertices.
+    void TestGather(size_t numVertices)
+    {
+        const HdVP2PrimvarFillData data(numVertices);
+        const Src* src = data.GetPrimvar<Src>();
+        const size_t numFaceVertices = data.GetNumFaceVertices();
+
+        for (const std::vector<int>* indices : { &data._faceVertexIndices, &data._faces }) {
+            ExpectIdentical(numFaceVertices,
+                [&](Dest* buffer) {
+                    Fill::FillGather(buffer, numFaceVertices, kChannelOffset, src, indices->data());
+                },
+                [&](Dest* buffer) {
+                    Reference::FillGather(buffer, numFaceVertices, kChannelOffset, src, indices->data());
+                });
+        }
+    }
+
+    // Uniform primvars of unshared vertices.
+    void TestUniform(size_t numVertices)
+    {
+        const HdVP2PrimvarFillData data(numVertices);
+        const Src* src = data.GetPrimvar<Src>();
+        const int* counts = data._faceVertexCounts.data();
+        const size_t numFaces = data.GetNumFaces();
+        const size_t numFaceVertices = data.GetNumFaceVertices();
+
+        ExpectIdentical(numFaceVertices,
+            [&](Dest* buffer) {
+                Fill::FillUniform(buffer, numFaceVertices, kChannelOffset, src, counts, numFaces);
+            },
+            [&](Dest* buffer) {
+                Reference::FillUniform(buffer, numFaceVertices, kChannelOffset, src, counts, numFaces);
+            });
+    }
+};
+
+TYPED_TEST_SUITE(PrimvarFillTest, Layouts);
+
+TYPED_TEST(PrimvarFillTest, Constant)
+{
+    this->TestConstant(kNumVerticesSmall);
+    this->TestConstant(kNumVerticesLarge);
+}
+
+TYPED_TEST(PrimvarFillTest, Copy)
+{
+    this->TestCopy(kNumVerticesSmall);
+    this->TestCopy(kNumVerticesLarge);
+}
+
+TYPED_TEST(PrimvarFillTest, Gather)
+{
+    this->TestGather(kNumVerticesSmall);
+    this->TestGather(kNumVerticesLarge);
+}
+
+TYPED_TEST(PrimvarFillTest, Uniform)
+{
+    this->TestUniform(kNumVerticesSmall);
+    this->TestUniform(kNumVerticesLarge);
+}
+
+} // anonymous namespace